@@ -0,0 +1,52 @@
+#pragma once
+
+#include "test-utils.hxx"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Uncompressed archive of 1 MiB files, either drawn from a small
+ * vocabulary (text compressing ~4:1) or uniformly random (incompressible).
+ */
+inline std::string make_synthetic_tar(std::size_t megabytes,
+                                      bool random_bytes) {
+  static const char *const words[] = {"tar ",    "filter ", "boost ",
+                                      "stream ", "entry ",  "header ",
+                                      "block ",  "\n"};
+  std::mt19937 random(1);
+  std::vector<TestEntry> entries;
+  for (std::size_t i = 0; i < megabytes; ++i) {
+    std::string data;
+    data.reserve(1 << 20);
+    while (data.size() < (1 << 20)) {
+      if (random_bytes)
+        data.push_back(static_cast<char>(random()));
+      else
+        data += words[random() % 8];
+    }
+    entries.push_back({"file-" + std::to_string(i), std::move(data)});
+  }
+  return make_tar(entries);
+}
+
+/**
+ * @brief Best wall time over repetitions, in seconds.
+ */
+inline double best_of(int repetitions, const std::function<std::size_t()> &run,
+                      std::size_t &bytes) {
+  double best = 1e30;
+  for (int i = 0; i < repetitions; ++i) {
+    auto const start = std::chrono::steady_clock::now();
+    bytes = run();
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+  return best;
+}
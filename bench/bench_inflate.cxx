@@ -0,0 +1,134 @@
+/**
+ * @file bench_inflate.cxx
+ * @brief Throughput of every inflate engine behind TarFilter, against
+ * Boost's gzip_decompressor and the fused visit_tar_gz().
+ *
+ * Usage: bench_inflate [megabytes] [repetitions] [archive.tar.gz...]
+ *
+ * Synthetic archives of the given size (text-like and incompressible) are
+ * always measured, together with tests/assets and any archives passed on the
+ * command line.
+ */
+
+#include "bench-utils.hxx"
+
+#include <boost-iostreams-tar-filter/gzip-decompressor.hxx>
+#include <boost-iostreams-tar-filter/tar-filter.hxx>
+#include <boost-iostreams-tar-filter/tar-reader.hxx>
+
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/device/null.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+namespace io = boost::iostreams;
+namespace tf = boost_iostreams_tar_filter;
+
+namespace {
+struct Input {
+  std::string name;
+  std::string compressed;
+};
+
+std::string gzip(const std::string &data) {
+  std::string out;
+  io::filtering_ostream os;
+  os.push(io::gzip_compressor());
+  os.push(io::back_inserter(out));
+  os << data;
+  os.reset();
+  return out;
+}
+
+Input make_synthetic(const std::string &name, std::size_t megabytes,
+                     bool random_bytes) {
+  return {name, gzip(make_synthetic_tar(megabytes, random_bytes))};
+}
+
+Input load(const fs::path &path) {
+  std::ifstream file(path, std::ios::binary);
+  std::ostringstream contents;
+  contents << file.rdbuf();
+  return {path.filename().string(), contents.str()};
+}
+
+/**
+ * @brief Payload bytes produced by a TarFilter pipeline with the given
+ * decompressor pushed in front of the source.
+ */
+template <typename Decompressor>
+std::size_t run_pipeline(const std::string &compressed,
+                         Decompressor decompressor) {
+  io::filtering_istream in;
+  in.push(tf::TarFilter<>());
+  in.push(decompressor);
+  in.push(io::array_source(compressed.data(), compressed.size()));
+  return static_cast<std::size_t>(io::copy(in, io::null_sink()));
+}
+
+class CountingVisitor : public tf::EntryVisitor {
+public:
+  std::size_t bytes = 0;
+
+  bool on_entry_begin(const tf::Entry &) override { return true; }
+  void on_entry_data(const char *begin, const char *end) override {
+    bytes += static_cast<std::size_t>(end - begin);
+  }
+  void on_entry_end(const tf::Entry &) override {}
+};
+} // unnamed namespace
+
+int main(int argc, char **argv) {
+  std::size_t const megabytes = argc > 1 ? std::stoul(argv[1]) : 64;
+  int const repetitions = argc > 2 ? std::stoi(argv[2]) : 3;
+
+  std::vector<Input> inputs;
+  inputs.push_back(make_synthetic("synthetic-text", megabytes, false));
+  inputs.push_back(make_synthetic("synthetic-random", megabytes, true));
+  for (const auto &asset : fs::directory_iterator(BENCH_ASSETS_DIR))
+    inputs.push_back(load(asset.path()));
+  for (int i = 3; i < argc; ++i)
+    inputs.push_back(load(argv[i]));
+
+  std::vector<std::pair<std::string, std::function<std::size_t(const std::string &)>>>
+      candidates;
+  candidates.emplace_back("boost-gzip", [](const std::string &compressed) {
+    return run_pipeline(compressed, io::gzip_decompressor());
+  });
+  for (auto engine : tf::available_inflate_engines())
+    candidates.emplace_back(tf::to_string(engine),
+                            [engine](const std::string &compressed) {
+                              return run_pipeline(
+                                  compressed, tf::GzipDecompressor<>(engine));
+                            });
+  candidates.emplace_back("fused", [](const std::string &compressed) {
+    std::istringstream in(compressed);
+    CountingVisitor visitor;
+    tf::visit_tar_gz(in, visitor);
+    return visitor.bytes;
+  });
+
+  std::printf("%-32s %-12s %12s %10s\n", "input", "engine", "payload",
+              "MiB/s");
+  for (const auto &input : inputs) {
+    for (const auto &[name, run] : candidates) {
+      std::size_t bytes = 0;
+      auto const seconds = best_of(
+          repetitions, [&] { return run(input.compressed); }, bytes);
+      std::printf("%-32s %-12s %12zu %10.1f\n", input.name.c_str(),
+                  name.c_str(), bytes, bytes / seconds / (1 << 20));
+    }
+  }
+  return 0;
+}
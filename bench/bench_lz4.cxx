@@ -0,0 +1,137 @@
+/**
+ * @file bench_lz4.cxx
+ * @brief Throughput of Lz4FrameDecompressor behind TarFilter, against
+ * Boost's gzip and zstd decompressors on the same archives.
+ *
+ * Usage: bench_lz4 [megabytes] [repetitions]
+ *
+ * LZ4 is measured with independent blocks (sequentially and on all cores)
+ * and with linked blocks, the `lz4` command line default.
+ */
+
+#include "bench-utils.hxx"
+
+#include <boost-iostreams-tar-filter/lz4-frame-decompressor.hxx>
+#include <boost-iostreams-tar-filter/tar-filter.hxx>
+
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/device/null.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/zstd.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <lz4frame.h>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace io = boost::iostreams;
+namespace tf = boost_iostreams_tar_filter;
+
+namespace {
+template <typename Compressor>
+std::string compress(const std::string &data, Compressor compressor) {
+  std::string out;
+  io::filtering_ostream os;
+  os.push(compressor);
+  os.push(io::back_inserter(out));
+  os << data;
+  os.reset();
+  return out;
+}
+
+std::string lz4(const std::string &data, bool independent) {
+  LZ4F_preferences_t preferences{};
+  preferences.frameInfo.blockSizeID = LZ4F_max4MB;
+  preferences.frameInfo.blockMode =
+      independent ? LZ4F_blockIndependent : LZ4F_blockLinked;
+  preferences.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+
+  std::string out(LZ4F_compressFrameBound(data.size(), &preferences), '\0');
+  auto const size = LZ4F_compressFrame(out.data(), out.size(), data.data(),
+                                       data.size(), &preferences);
+  if (LZ4F_isError(size))
+    throw std::runtime_error("LZ4F_compressFrame");
+  out.resize(size);
+  return out;
+}
+
+/**
+ * @brief Payload bytes produced by a TarFilter pipeline with the given
+ * decompressor pushed in front of the source.
+ */
+template <typename Decompressor>
+std::size_t run_pipeline(const std::string &compressed,
+                         Decompressor decompressor) {
+  io::filtering_istream in;
+  in.push(tf::TarFilter<>());
+  in.push(decompressor);
+  in.push(io::array_source(compressed.data(), compressed.size()));
+  return static_cast<std::size_t>(io::copy(in, io::null_sink()));
+}
+
+struct Candidate {
+  std::string name;
+  std::string compressed;
+  std::function<std::size_t(const std::string &)> run;
+};
+} // unnamed namespace
+
+int main(int argc, char **argv) {
+  std::size_t const megabytes = argc > 1 ? std::stoul(argv[1]) : 64;
+  int const repetitions = argc > 2 ? std::stoi(argv[2]) : 3;
+  std::size_t const cores =
+      std::max<std::size_t>(1, std::thread::hardware_concurrency());
+
+  std::printf("%-18s %-16s %12s %12s %10s\n", "input", "codec", "compressed",
+              "payload", "MiB/s");
+  for (bool random_bytes : {false, true}) {
+    auto const archive = make_synthetic_tar(megabytes, random_bytes);
+    auto const independent = lz4(archive, true);
+
+    std::vector<Candidate> candidates;
+    candidates.push_back({"gzip", compress(archive, io::gzip_compressor()),
+                          [](const std::string &compressed) {
+                            return run_pipeline(compressed,
+                                                io::gzip_decompressor());
+                          }});
+    candidates.push_back({"zstd", compress(archive, io::zstd_compressor()),
+                          [](const std::string &compressed) {
+                            return run_pipeline(compressed,
+                                                io::zstd_decompressor());
+                          }});
+    candidates.push_back({"lz4-linked", lz4(archive, false),
+                          [](const std::string &compressed) {
+                            return run_pipeline(
+                                compressed, tf::Lz4FrameDecompressor<>(1));
+                          }});
+    candidates.push_back({"lz4-1-thread", independent,
+                          [](const std::string &compressed) {
+                            return run_pipeline(
+                                compressed, tf::Lz4FrameDecompressor<>(1));
+                          }});
+    candidates.push_back(
+        {"lz4-" + std::to_string(cores) + "-cores", independent,
+         [cores](const std::string &compressed) {
+           return run_pipeline(compressed, tf::Lz4FrameDecompressor<>(cores));
+         }});
+
+    for (const auto &candidate : candidates) {
+      std::size_t bytes = 0;
+      auto const seconds = best_of(
+          repetitions, [&] { return candidate.run(candidate.compressed); },
+          bytes);
+      std::printf("%-18s %-16s %12zu %12zu %10.1f\n",
+                  random_bytes ? "synthetic-random" : "synthetic-text",
+                  candidate.name.c_str(), candidate.compressed.size(), bytes,
+                  bytes / seconds / (1 << 20));
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,128 @@
+/**
+ * @file bench_pipe.cxx
+ * @brief Throughput of visit_tar() over a pipe fed by another thread,
+ * through PipeSource against a default file_descriptor_source and against
+ * the same archive read from memory.
+ *
+ * Usage: bench_pipe [megabytes] [repetitions] [write size]
+ *
+ * The writer uses small writes (4 KiB by default) like a network client
+ * piping into the tool.
+ */
+
+#include "bench-utils.hxx"
+
+#include <boost-iostreams-tar-filter/pipe-source.hxx>
+#include <boost-iostreams-tar-filter/tar-reader.hxx>
+
+#include <boost/iostreams/device/file_descriptor.hpp>
+#include <boost/iostreams/stream.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+namespace io = boost::iostreams;
+namespace tf = boost_iostreams_tar_filter;
+
+namespace {
+/**
+ * @brief Visitor touching every payload byte, so the parser cannot skip.
+ */
+class SumVisitor : public tf::EntryVisitor {
+public:
+  bool on_entry_begin(const tf::Entry &) override { return true; }
+  void on_entry_data(const char *begin, const char *end) override {
+    for (; begin < end; ++begin)
+      sum += static_cast<unsigned char>(*begin);
+  }
+  void on_entry_end(const tf::Entry &) override {}
+
+  std::size_t sum = 0;
+};
+
+/**
+ * @brief Run visit_tar() over the read end of a pipe written by another
+ * thread in write_size chunks.
+ */
+std::size_t
+run_pipe(const std::string &archive, std::size_t write_size,
+         const std::function<void(int, tf::EntryVisitor &)> &read) {
+  int fds[2];
+  if (::pipe(fds) != 0)
+    std::abort();
+  std::jthread writer([&] {
+    for (std::size_t offset = 0; offset < archive.size();) {
+      auto const count =
+          ::write(fds[1], archive.data() + offset,
+                  std::min(write_size, archive.size() - offset));
+      if (count <= 0)
+        break;
+      offset += static_cast<std::size_t>(count);
+    }
+    ::close(fds[1]);
+  });
+  SumVisitor visitor;
+  read(fds[0], visitor);
+  writer.join();
+  ::close(fds[0]);
+  return archive.size();
+}
+
+void report(const char *name, std::size_t bytes, double seconds) {
+  std::printf("%-28s %8.1f MiB/s\n", name,
+              static_cast<double>(bytes) / seconds / (1 << 20));
+}
+} // unnamed namespace
+
+int main(int argc, char **argv) {
+  auto const megabytes =
+      argc > 1 ? static_cast<std::size_t>(std::atoi(argv[1])) : 64;
+  auto const repetitions = argc > 2 ? std::atoi(argv[2]) : 3;
+  auto const write_size =
+      argc > 3 ? static_cast<std::size_t>(std::atoi(argv[3])) : 4096;
+  auto const archive = make_synthetic_tar(megabytes, false);
+
+  std::size_t bytes = 0;
+  auto seconds = best_of(
+      repetitions,
+      [&] {
+        std::istringstream in(archive);
+        SumVisitor visitor;
+        tf::visit_tar(in, visitor);
+        return archive.size();
+      },
+      bytes);
+  report("memory", bytes, seconds);
+
+  seconds = best_of(
+      repetitions,
+      [&] {
+        return run_pipe(archive, write_size,
+                        [](int fd, tf::EntryVisitor &visitor) {
+                          io::stream<io::file_descriptor_source> in(
+                              fd, io::never_close_handle);
+                          tf::visit_tar(in, visitor);
+                        });
+      },
+      bytes);
+  report("pipe, file_descriptor_source", bytes, seconds);
+
+  seconds = best_of(
+      repetitions,
+      [&] {
+        return run_pipe(archive, write_size,
+                        [](int fd, tf::EntryVisitor &visitor) {
+                          tf::PipeSource source(fd);
+                          io::stream<tf::PipeSource> in(source);
+                          tf::visit_tar(in, visitor, 1 << 20);
+                        });
+      },
+      bytes);
+  report("pipe, PipeSource", bytes, seconds);
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <boost-iostreams-tar-filter/gzip-index.hxx>
+
+#include <cstddef>
+#include <istream>
+#include <vector>
+#include <zlib.h>
+
+namespace boost_iostreams_tar_filter::detail {
+/**
+ * @brief Throw std::ios_base::failure describing a zlib error.
+ */
+[[noreturn]] void throw_zlib_error(const z_stream &stream, int ret);
+
+/**
+ * @class GzipInflater
+ * @brief Inflates a gzip stream into caller-owned buffers, either from the
+ * current stream position or from a GzipCheckpoint.
+ *
+ * Raw deflate is resumed from a block boundary with inflatePrime() and
+ * inflateSetDictionary(). When a member ends, its trailer is skipped and the
+ * next member is inflated with header parsing, so concatenated gzip members
+ * read as one stream.
+ *
+ * With verification off, zlib neither computes nor compares the CRC-32 of
+ * members (inflateValidate()).
+ */
+class GzipInflater {
+public:
+  /**
+   * @param in Stream positioned at the start of a gzip member; need not be
+   * seekable.
+   * @param verify Whether to check member CRC-32s.
+   */
+  explicit GzipInflater(std::istream &in, bool verify = true);
+
+  /**
+   * @param in Seekable compressed stream; repositioned by the constructor.
+   * @param checkpoint Where to start.
+   * @param verify Whether to check member CRC-32s.
+   */
+  GzipInflater(std::istream &in, const GzipCheckpoint &checkpoint,
+               bool verify = true);
+  ~GzipInflater();
+
+  GzipInflater(const GzipInflater &) = delete;
+  GzipInflater &operator=(const GzipInflater &) = delete;
+
+  /**
+   * @brief Inflate up to size bytes.
+   *
+   * @return Bytes produced; 0 at the end of the compressed stream.
+   * @throws std::ios_base::failure on corrupt input.
+   */
+  std::size_t read(char *out, std::size_t size);
+
+  /**
+   * @brief Inflate and drop count bytes.
+   *
+   * Output goes to a fixed 32 KiB scratch window that stays cache-resident,
+   * whatever the size of the discarded range.
+   *
+   * @return Bytes dropped; less than count when the stream ended first.
+   */
+  std::uint64_t discard(std::uint64_t count);
+
+private:
+  bool fill();
+
+  /**
+   * @brief Start the next member with gzip header parsing.
+   */
+  void next_member();
+
+  std::istream &in_;
+  z_stream stream_{};
+  std::vector<unsigned char> input_;
+  std::vector<char> scratch_;
+  bool verify_;
+  bool raw_ = false;
+  bool finished_ = false;
+};
+} // namespace boost_iostreams_tar_filter::detail
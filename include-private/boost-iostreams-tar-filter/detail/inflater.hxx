@@ -0,0 +1,38 @@
+#pragma once
+
+#include <boost-iostreams-tar-filter/inflate-engine.hxx>
+
+#include <memory>
+
+namespace boost_iostreams_tar_filter::detail {
+/**
+ * @class Inflater
+ * @brief Streaming gzip decoder behind BaseGzipDecompressorImpl; one
+ * implementation per InflateEngine.
+ */
+class Inflater {
+public:
+  virtual ~Inflater() = default;
+
+  /**
+   * @brief Same contract as BaseGzipDecompressorImpl::filter().
+   */
+  virtual bool inflate(const char *&src_begin, const char *src_end,
+                       char *&dest_begin, const char *dest_end,
+                       bool flush) = 0;
+
+  /**
+   * @brief Forget all state and expect a new gzip stream.
+   */
+  virtual void reset() = 0;
+};
+
+/**
+ * @throws std::invalid_argument when engine is not compiled in.
+ */
+std::unique_ptr<Inflater> make_inflater(InflateEngine engine);
+
+std::unique_ptr<Inflater> make_zlib_ng_inflater();
+std::unique_ptr<Inflater> make_libdeflate_inflater();
+std::unique_ptr<Inflater> make_isal_inflater();
+} // namespace boost_iostreams_tar_filter::detail
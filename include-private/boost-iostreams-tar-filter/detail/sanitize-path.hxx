@@ -0,0 +1,16 @@
+#pragma once
+
+#include <string>
+
+namespace boost_iostreams_tar_filter::detail {
+/**
+ * @brief Normalize an entry name into a path relative to an extraction root.
+ *
+ * Strips leading `/` and `./`, empty and `.` components and trailing `/`.
+ *
+ * @param name Entry name as stored in the archive.
+ * @return std::string The relative path ("" for the root itself).
+ * @throws std::system_error when a component is `..`.
+ */
+std::string sanitize_path(const std::string &name);
+} // namespace boost_iostreams_tar_filter::detail
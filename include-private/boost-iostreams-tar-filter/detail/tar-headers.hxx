@@ -0,0 +1,66 @@
+#pragma once
+
+#include <boost-iostreams-tar-filter/detail/base-tar-filter-impl.hxx>
+#include <boost-iostreams-tar-filter/entry.hxx>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace boost_iostreams_tar_filter::detail {
+/**
+ * @brief Walk the headers of an uncompressed TAR file by offset, reading
+ * nothing but the 512-byte headers; shared by splice_tar_entries() and
+ * read_entry_into().
+ *
+ * @param fd Descriptor of the archive, read with pread().
+ * @param name Archive name for error messages.
+ * @param on_entry Called with each entry and the file offset of its
+ * payload; returns false to stop the walk.
+ * @return true when the end-of-archive marker was reached.
+ * @return false when on_entry() stopped the walk or the file ended first.
+ * @throws std::system_error on read errors.
+ */
+bool walk_tar_headers(
+    int fd, const std::string &name,
+    const std::function<bool(const Entry &, std::uint64_t)> &on_entry);
+
+/**
+ * @brief TAR state machine fed one 512-byte block at a time by readers that
+ * skip payloads themselves; pax and GNU extension records are applied to the
+ * entries they precede.
+ */
+class TarHeaderParser : private EntryVisitor {
+public:
+  /**
+   * @brief Feed the next block of the archive.
+   *
+   * @return false for the end-of-archive marker.
+   * @throws std::ios_base::failure on a malformed extension record.
+   */
+  bool feed(const char *block);
+
+  /**
+   * @brief Entry whose header the last block held; nullptr after a block of
+   * an extension record.
+   */
+  const Entry *entry() const { return started_ ? &entry_ : nullptr; }
+
+  /**
+   * @brief Account for the payload and padding after the last header.
+   *
+   * @return The number of bytes the caller must skip before feeding the
+   * next block.
+   */
+  std::uint64_t skip_payload();
+
+private:
+  bool on_entry_begin(const Entry &entry) override;
+  void on_entry_data(const char *, const char *) override {}
+  void on_entry_end(const Entry &) override {}
+
+  BaseTarFilterImpl impl_;
+  Entry entry_;
+  bool started_ = false;
+};
+} // namespace boost_iostreams_tar_filter::detail
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <boost-iostreams-tar-filter/entry.hxx>
+
+#include <algorithm>
+#include <cstddef>
+#include <ios>
+#include <istream>
+#include <vector>
+
+namespace boost_iostreams_tar_filter::detail {
+/**
+ * @brief Whether the stream buffer supports relative seeks.
+ *
+ * Probed on the stream buffer rather than with tellg(), because Boost
+ * filtering streams throw from seekoff() and tellg() would turn that into
+ * badbit on the caller's stream.
+ */
+bool is_seekable(std::istream &in);
+
+/**
+ * @brief Read a stream buffer by buffer and feed each one to a parser's
+ * visit(); shared by visit_tar(), visit_cpio() and visit_archive().
+ *
+ * EntryVisitor::on_buffer_end() is called after each buffer is consumed so
+ * batching visitors can flush borrowed slices before the buffer is refilled.
+ * On seekable streams, discarded ranges of at least one buffer (declined
+ * payloads and their padding) are seeked over instead of read.
+ *
+ * @tparam Parser BaseTarFilterImpl or BaseCpioFilterImpl.
+ * @param buffer Read buffer; its first prefetched bytes were already read
+ * from the stream and are parsed first.
+ * @return true when the parser reached the end of the archive, as told by
+ * its complete().
+ */
+template <typename Parser>
+bool visit_stream(std::istream &in, Parser &impl, EntryVisitor &visitor,
+                  std::vector<char> &buffer, std::size_t prefetched = 0) {
+  if (prefetched > 0) {
+    const char *begin = buffer.data();
+    impl.visit(begin, begin + prefetched, visitor);
+    visitor.on_buffer_end();
+  }
+
+  auto const seekable = is_seekable(in);
+  // Seeking past the end succeeds on files, so skips are clamped to the
+  // stream size; the rest of a range cut short is then read (and found
+  // missing) like any other input.
+  std::streamoff end = -1;
+  if (seekable) {
+    auto *const buf = in.rdbuf();
+    auto const position =
+        buf->pubseekoff(0, std::ios_base::cur, std::ios_base::in);
+    end = buf->pubseekoff(0, std::ios_base::end, std::ios_base::in);
+    buf->pubseekpos(position, std::ios_base::in);
+  }
+  while (impl.state != Parser::State::Done) {
+    if (auto pending = impl.pending_discard();
+        seekable && pending >= buffer.size()) {
+      auto *const buf = in.rdbuf();
+      auto const position =
+          buf->pubseekoff(0, std::ios_base::cur, std::ios_base::in);
+      if (position != std::streampos(-1) && end >= 0)
+        pending = std::min<std::size_t>(
+            pending, static_cast<std::size_t>(
+                         std::max<std::streamoff>(0, end - position)));
+      if (pending >= buffer.size() &&
+          buf->pubseekoff(static_cast<std::streamoff>(pending),
+                          std::ios_base::cur,
+                          std::ios_base::in) != std::streampos(-1)) {
+        impl.discard(pending, visitor);
+        visitor.on_buffer_end();
+        continue;
+      }
+    }
+
+    in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    auto const count = static_cast<std::size_t>(in.gcount());
+    if (count == 0)
+      break;
+
+    const char *begin = buffer.data();
+    impl.visit(begin, begin + count, visitor);
+    visitor.on_buffer_end();
+  }
+  return impl.complete();
+}
+} // namespace boost_iostreams_tar_filter::detail
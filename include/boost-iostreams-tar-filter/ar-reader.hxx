@@ -0,0 +1,142 @@
+/**
+ * @file ar-reader.hxx
+ * @brief Streaming reader for `ar` archives, such as Debian packages, whose
+ * members are compressed TAR archives.
+ */
+
+#pragma once
+
+#include <boost-iostreams-tar-filter/entry.hxx>
+#include <boost/iostreams/categories.hpp>
+#include <boost/iostreams/constants.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace boost_iostreams_tar_filter {
+/**
+ * @brief Header of one `ar` member.
+ */
+struct ArMember {
+  std::string name;       /**< @brief Member name, GNU/BSD long names
+                             resolved and trailing '/' removed. */
+  std::uint64_t size = 0; /**< @brief Data size in bytes. */
+  std::int64_t mtime = 0; /**< @brief Modification time (seconds since
+                             epoch). */
+  std::uint32_t uid = 0;  /**< @brief Owner user ID. */
+  std::uint32_t gid = 0;  /**< @brief Owner group ID. */
+  std::uint32_t mode = 0; /**< @brief Permission bits. */
+};
+
+/**
+ * @brief Source device over the data of the current member of an ArReader.
+ *
+ * Reads end at the member boundary, so the device can be pushed behind a
+ * decompressor and TarFilter without copying the member out first.
+ */
+class ArMemberSource {
+public:
+  /// Character type used by the stream.
+  using char_type = char;
+  /// Input device.
+  using category = boost::iostreams::source_tag;
+
+  /**
+   * @return Bytes read, or -1 at the end of the member.
+   * @throws std::ios_base::failure when the archive ends inside the member.
+   */
+  std::streamsize read(char *s, std::streamsize n);
+
+private:
+  friend class ArReader;
+
+  struct State {
+    std::istream *in = nullptr;
+    std::uint64_t remaining = 0;
+  };
+
+  explicit ArMemberSource(std::shared_ptr<State> state);
+
+  std::shared_ptr<State> state_;
+};
+
+/**
+ * @brief Walks the members of an `ar` archive in one sequential pass.
+ *
+ * Unread data of a member is skipped when moving to the next one, by seeking
+ * when the stream supports it.
+ *
+ * @code{.cpp}
+ * std::ifstream deb("pkg.deb", std::ios::binary);
+ * ArReader ar(deb);
+ * ArMember member;
+ * while (ar.next(member)) {
+ *   if (member.name.rfind("data.tar", 0) != 0)
+ *     continue;
+ *   io::filtering_istream in;
+ *   push_decompressor(in, compression_from_name(member.name));
+ *   in.push(ar.source());
+ *   visit_tar(in, visitor);
+ * }
+ * @endcode
+ */
+class ArReader {
+public:
+  /**
+   * @param in Stream positioned at the "!<arch>" signature; it must outlive
+   * the reader and its member sources.
+   * @throws std::ios_base::failure when the signature is missing.
+   */
+  explicit ArReader(std::istream &in);
+
+  /**
+   * @brief Skip the rest of the current member and read the next header.
+   *
+   * GNU symbol and long-name tables ("/", "//") are consumed internally and
+   * not reported.
+   *
+   * @return false at the end of the archive.
+   * @throws std::ios_base::failure on a malformed header.
+   */
+  bool next(ArMember &member);
+
+  /**
+   * @brief Device reading the remaining data of the current member.
+   */
+  ArMemberSource source() const;
+
+private:
+  void skip_rest();
+
+  std::istream &in_;
+  std::shared_ptr<ArMemberSource::State> state_;
+  bool padded_ = false;
+  std::string long_names_;
+};
+
+/**
+ * @brief Parse the TAR member of a Debian package (or any `ar` archive
+ * holding compressed TAR members) without extracting it first.
+ *
+ * The first member whose name starts with member_prefix is decompressed
+ * according to its suffix and parsed with visit_tar(); gzip members use
+ * visit_tar_gz().
+ *
+ * @param in Stream positioned at the "!<arch>" signature.
+ * @param visitor Receiver of entries and payload slices.
+ * @param member_prefix Name prefix of the member, "data.tar" or
+ * "control.tar".
+ * @param buffer_size Size of the read buffer.
+ * @return true when the end-of-archive marker was reached.
+ * @return false when the member ended before the marker.
+ * @throws std::ios_base::failure when no member matches.
+ */
+bool visit_deb(std::istream &in, EntryVisitor &visitor,
+               std::string_view member_prefix = "data.tar",
+               std::size_t buffer_size =
+                   boost::iostreams::default_device_buffer_size);
+} // namespace boost_iostreams_tar_filter
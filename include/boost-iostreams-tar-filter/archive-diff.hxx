@@ -0,0 +1,68 @@
+/**
+ * @file archive-diff.hxx
+ * @brief Entry-level comparison of two archives without extracting them.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace boost_iostreams_tar_filter {
+/** @brief One difference between two archives. */
+struct DiffEntry {
+  enum class Kind {
+    Added,    /**< @brief Only in the second archive. */
+    Removed,  /**< @brief Only in the first archive. */
+    Modified, /**< @brief Type, size, link target or contents differ. */
+  };
+  Kind kind;
+  std::string name;
+};
+
+/** @brief Options for diff_archives(). */
+struct DiffOptions {
+  /**
+   * @brief Both archives list entries in ascending name order; compare them
+   * with a streaming merge-join that keeps nothing but the current entries.
+   * An out-of-order entry raises std::ios_base::failure.
+   */
+  bool sorted = false;
+
+  /** @brief Summaries each reader thread may queue ahead of the comparison. */
+  std::size_t queue_depth = 1024;
+
+  /**
+   * @brief Summaries the unsorted join keeps in memory (about 100 bytes
+   * plus the name and link target each). Beyond that, all entries of both
+   * archives are spilled to anonymous temporary files, partitioned by name,
+   * and joined one partition at a time.
+   */
+  std::size_t max_pending = 1 << 20;
+};
+
+/**
+ * @brief Compare two TAR streams entry by entry.
+ *
+ * Each archive is parsed on its own thread and every payload is hashed
+ * (SHA-256) in-stream; only per-entry summaries (name, type, size, link
+ * target, digest) reach the comparison, never payload bytes. Unsorted
+ * archives are matched with a hash join over one map per archive, capped by
+ * DiffOptions::max_pending.
+ *
+ * A name stored more than once is compared by its last copy, the one
+ * extraction leaves behind; sorted archives cannot repeat a name.
+ *
+ * Both streams may sit behind their own decompressors.
+ *
+ * @return Differences sorted by entry name.
+ * @throws std::invalid_argument when max_pending is 0.
+ * @throws std::system_error when a spill file cannot be written.
+ * @throws std::length_error when one spill partition still holds more than
+ * max_pending names after repeated re-partitioning.
+ */
+std::vector<DiffEntry> diff_archives(std::istream &before, std::istream &after,
+                                     DiffOptions options = {});
+} // namespace boost_iostreams_tar_filter
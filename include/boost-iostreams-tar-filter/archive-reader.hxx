@@ -0,0 +1,60 @@
+/**
+ * @file archive-reader.hxx
+ * @brief Format-neutral entry parsing: TAR and cpio archives reported
+ * through the same EntryVisitor.
+ */
+
+#pragma once
+
+#include <boost-iostreams-tar-filter/entry.hxx>
+#include <boost/iostreams/constants.hpp>
+
+#include <cstddef>
+#include <istream>
+#include <string_view>
+
+namespace boost_iostreams_tar_filter {
+/**
+ * @brief Archive formats understood by visit_archive().
+ */
+enum class ArchiveFormat {
+  Tar,  /**< @brief ustar, GNU or v7 TAR. */
+  Cpio, /**< @brief cpio "newc", "crc" or "odc" (initramfs, RPM payloads). */
+};
+
+/**
+ * @brief Format identified by the first six bytes of an uncompressed
+ * archive; anything that is not a cpio magic is taken to be TAR.
+ */
+ArchiveFormat archive_format_from_magic(std::string_view head);
+
+/**
+ * @brief Parse a cpio archive from a stream and report every entry to a
+ * visitor, like visit_tar().
+ *
+ * Symbolic link targets are reported in Entry::link_name, and hard links
+ * that share their data (newc) as Entry::HardLink entries pointing to the
+ * link that carries it, so sinks written for TAR apply unchanged.
+ *
+ * @param in Stream positioned at the first cpio header.
+ * @param visitor Receiver of entries and payload slices.
+ * @param buffer_size Size of the read buffer.
+ * @return true when the TRAILER!!! entry was reached.
+ * @return false when the stream ended before it.
+ * @throws std::ios_base::failure on a malformed header.
+ */
+bool visit_cpio(std::istream &in, EntryVisitor &visitor,
+                std::size_t buffer_size =
+                    boost::iostreams::default_device_buffer_size);
+
+/**
+ * @brief Detect the archive format from the first bytes of the stream and
+ * run visit_tar() or visit_cpio().
+ *
+ * Works on non-seekable streams: the bytes read for detection are parsed
+ * from the read buffer.
+ */
+bool visit_archive(std::istream &in, EntryVisitor &visitor,
+                   std::size_t buffer_size =
+                       boost::iostreams::default_device_buffer_size);
+} // namespace boost_iostreams_tar_filter
@@ -0,0 +1,121 @@
+/**
+ * @file archive-store.hxx
+ * @brief In-memory path -> contents store loaded from archives, with a byte
+ * budget, LRU eviction and lock-free lookups.
+ */
+
+#pragma once
+
+#include <boost-iostreams-tar-filter/entry.hxx>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace boost_iostreams_tar_filter {
+/**
+ * @brief Serves the regular files of one or more archives from memory.
+ *
+ * load() copies file contents into large arena blocks (one allocation per
+ * block rather than per file) and publishes an immutable index snapshot.
+ * find() never takes a lock: it reads the current snapshot pointer, looks the
+ * path up and stamps the file's last-access tick. Writers (load()) are
+ * serialized, evict least-recently-used files until the byte budget is met
+ * and, before returning, wait for the lookups that may still see the old
+ * snapshot and free it, so evicted files never outlive the load() that
+ * evicted them (unless a File handle still refers to them).
+ *
+ * Returned File handles keep their bytes alive after eviction; an arena
+ * block is released once every file stored in it is gone.
+ */
+class ArchiveStore {
+public:
+  /** @brief Handle to the contents of a stored file. */
+  struct File {
+    std::shared_ptr<const char> data; /**< @brief Start of the contents. */
+    std::size_t size = 0;             /**< @brief Size in bytes. */
+
+    explicit operator bool() const { return data != nullptr; }
+    std::string_view view() const { return {data.get(), size}; }
+  };
+
+  /**
+   * @param byte_budget Maximum number of content bytes kept in the store.
+   * @param arena_block_size Size of the arena blocks files are packed into.
+   */
+  explicit ArchiveStore(std::size_t byte_budget,
+                        std::size_t arena_block_size = 1 << 20);
+  ~ArchiveStore();
+
+  ArchiveStore(const ArchiveStore &) = delete;
+  ArchiveStore &operator=(const ArchiveStore &) = delete;
+
+  /**
+   * @brief Load every regular file of a TAR stream, replacing files with the
+   * same path, then evict least-recently-used files beyond the budget.
+   *
+   * Files larger than the whole budget are not stored. Files of the archive
+   * that would be evicted at the end are dropped while it is read, so the
+   * peak is about twice the budget (the stored files, still visible to
+   * find(), plus the incoming ones) and two arena blocks, however large the
+   * archive.
+   *
+   * @return true when the end-of-archive marker was reached.
+   */
+  bool load(std::istream &in);
+
+  /**
+   * @brief Look a path up without locking.
+   *
+   * @return The file, or an empty handle when the path is not stored.
+   */
+  File find(std::string_view path) const;
+
+  /** @brief Number of content bytes currently stored. */
+  std::size_t size_bytes() const;
+  /** @brief Number of files currently stored. */
+  std::size_t count() const;
+
+private:
+  struct Node {
+    File file;
+    mutable std::atomic<std::uint64_t> last_access{0};
+  };
+
+  struct Hash {
+    using is_transparent = void;
+    std::size_t operator()(std::string_view s) const {
+      return std::hash<std::string_view>{}(s);
+    }
+  };
+
+  struct Index {
+    std::unordered_map<std::string, std::shared_ptr<Node>, Hash,
+                       std::equal_to<>>
+        nodes;
+    std::size_t bytes = 0;
+  };
+
+  /** @brief Register a reader; returns the epoch to pass to leave(). */
+  unsigned enter() const;
+  void leave(unsigned epoch) const;
+
+  void publish(Index *index);
+
+  std::size_t byte_budget_;
+  std::size_t arena_block_size_;
+  std::atomic<Index *> index_;
+  std::atomic<unsigned> epoch_{0};
+  mutable std::atomic<std::size_t> readers_[2]{};
+  mutable std::atomic<std::uint64_t> tick_{0};
+  std::mutex writer_mutex_;
+};
+} // namespace boost_iostreams_tar_filter
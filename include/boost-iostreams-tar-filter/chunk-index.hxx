@@ -0,0 +1,99 @@
+/**
+ * @file chunk-index.hxx
+ * @brief Content-defined chunking of entry payloads into a Merkle manifest
+ * for cross-archive deduplication.
+ */
+
+#pragma once
+
+#include <boost-iostreams-tar-filter/entry.hxx>
+#include <boost-iostreams-tar-filter/sha256.hxx>
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace boost_iostreams_tar_filter {
+/** @brief A content-defined chunk of an entry's payload. */
+struct ContentChunk {
+  std::size_t offset = 0; /**< @brief Offset within the entry payload. */
+  std::size_t size = 0;   /**< @brief Chunk length in bytes. */
+  Digest digest{};        /**< @brief SHA-256 of the chunk. */
+};
+
+/** @brief Chunk list and Merkle root of one regular file. */
+struct ChunkedEntry {
+  std::string name;
+  std::size_t size = 0;
+  std::vector<ContentChunk> chunks;
+  Digest root{}; /**< @brief Merkle root over the chunk digests. */
+};
+
+/** @brief Per-archive Merkle manifest. */
+struct ChunkManifest {
+  std::vector<ChunkedEntry> entries;
+  Digest root{}; /**< @brief Merkle root over the entries. */
+
+  /**
+   * @brief Distinct chunk digests the holder of `have` still needs to fetch,
+   * in first-use order.
+   */
+  std::vector<Digest>
+  missing_chunks(const std::unordered_set<Digest, DigestHash> &have) const;
+
+  /**
+   * @brief Write a line-oriented text form: `archive <root>`, then per entry
+   * `entry <root> <size> <name>` followed by `chunk <digest> <offset> <size>`
+   * lines.
+   */
+  void write(std::ostream &out) const;
+};
+
+/** @brief Chunk size bounds for ChunkIndexBuilder. */
+struct ChunkingOptions {
+  std::size_t min_size = 2 * 1024;  /**< @brief No cut before this size. */
+  std::size_t avg_size = 8 * 1024;  /**< @brief Target size (power of two). */
+  std::size_t max_size = 64 * 1024; /**< @brief Forced cut at this size. */
+};
+
+/**
+ * @brief EntryVisitor that splits regular file payloads with a gear rolling
+ * hash (FastCDC-style normalized chunking) and builds a Merkle manifest.
+ *
+ * Chunk boundaries depend only on nearby content, so an insertion early in a
+ * file changes the chunks around it while later chunks keep their digests;
+ * storage and transfer layers can then fetch only the chunks they miss.
+ * Chunks are hashed incrementally as the payload streams by.
+ *
+ * The rolling hash only depends on the last 64 bytes, so the first
+ * min_size - 64 bytes of every chunk are skipped without hashing.
+ */
+class ChunkIndexBuilder : public EntryVisitor {
+public:
+  explicit ChunkIndexBuilder(ChunkingOptions options = {});
+
+  bool on_entry_begin(const Entry &entry) override;
+  void on_entry_data(const char *begin, const char *end) override;
+  void on_entry_end(const Entry &entry) override;
+
+  /**
+   * @brief Compute the archive root and hand out the manifest.
+   */
+  ChunkManifest finish();
+
+private:
+  void cut();
+
+  ChunkingOptions options_;
+  std::uint64_t mask_small_;
+  std::uint64_t mask_large_;
+  std::uint64_t hash_ = 0;
+  std::size_t chunk_size_ = 0;
+  std::size_t offset_ = 0;
+  Sha256 sha_;
+  ChunkManifest manifest_;
+};
+} // namespace boost_iostreams_tar_filter
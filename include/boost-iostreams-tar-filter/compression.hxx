@@ -0,0 +1,57 @@
+/**
+ * @file compression.hxx
+ * @brief Choosing the decompressor in front of TarFilter from a file name or
+ * the leading bytes of the data.
+ */
+
+#pragma once
+
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <string_view>
+
+namespace boost_iostreams_tar_filter {
+/**
+ * @brief Compression formats of TAR archives and archive members.
+ */
+enum class Compression {
+  None,  /**< @brief Plain TAR. */
+  Gzip,  /**< @brief .gz, decoded by GzipDecompressor. */
+  Bzip2, /**< @brief .bz2, decoded by ParallelBzip2Decompressor. */
+  Xz,    /**< @brief .xz, decoded by Boost's lzma_decompressor. */
+  Zstd,  /**< @brief .zst, decoded by Boost's zstd_decompressor. */
+  Lz4,   /**< @brief .lz4, decoded by Lz4FrameDecompressor. */
+};
+
+/**
+ * @brief Compression implied by a file name suffix (".tar.gz", ".tgz",
+ * "data.tar.xz", ...); Compression::None for anything else.
+ *
+ * Legacy .lzma files are not .xz streams and lzma_decompressor cannot read
+ * them, so that suffix maps to Compression::None.
+ */
+Compression compression_from_name(std::string_view name);
+
+/**
+ * @brief Compression identified by the magic number at the start of the
+ * data; Compression::None when no known magic matches.
+ *
+ * @param head At least the first six bytes of the data when available.
+ */
+Compression compression_from_magic(std::string_view head);
+
+/**
+ * @brief Push the decompressor for a format onto a chain; nothing is pushed
+ * for Compression::None.
+ *
+ * @throws std::invalid_argument for Compression::Lz4 in builds without
+ * BOOST_IOSTREAMS_TAR_FILTER_WITH_LZ4.
+ */
+void push_decompressor(boost::iostreams::filtering_istream &in,
+                       Compression compression);
+
+/**
+ * @brief Lower-case format name ("none", "gzip", ...).
+ */
+const char *to_string(Compression compression);
+} // namespace boost_iostreams_tar_filter
@@ -0,0 +1,55 @@
+/**
+ * @file cpio-filter.hxx
+ * @brief cpio counterpart of TarFilter.
+ */
+
+#pragma once
+
+#include <boost-iostreams-tar-filter/detail/cpio-filter-impl.hxx>
+#include <boost/iostreams/filter/symmetric.hpp>
+
+namespace boost_iostreams_tar_filter {
+/**
+ * @brief Boost.Iostreams-compatible symmetric filter that extracts regular
+ * file contents from a cpio ("newc", "crc" or "odc") archive stream.
+ *
+ * Like TarFilter, it outputs the concatenated file data and drops headers,
+ * names, link targets and padding.
+ *
+ * @tparam Alloc Allocator type for internal buffers (default:
+ * std::allocator<char>)
+ *
+ * @code{.cpp}
+ * io::filtering_istream in;
+ * in.push(CpioFilter<>());
+ * in.push(io::gzip_decompressor());
+ * in.push(io::file_source("initramfs.cpio.gz", std::ios::binary));
+ * @endcode
+ */
+template <typename Alloc = std::allocator<char>>
+struct CpioFilter
+    : boost::iostreams::symmetric_filter<detail::CpioFilterImpl<Alloc>, Alloc> {
+private:
+  using impl_type = detail::CpioFilterImpl<Alloc>;
+  using base_type = boost::iostreams::symmetric_filter<impl_type, Alloc>;
+
+public:
+  /// Character type used by the stream.
+  using char_type = typename base_type::char_type;
+  /// Filter category for Boost.Iostreams.
+  using category = typename base_type::category;
+
+  /**
+   * @brief Constructs the cpio filter with optional buffer size.
+   *
+   * @param buffer_size Buffer size used internally (defaults to
+   * Boost.Iostreams' default size).
+   */
+  explicit CpioFilter(std::streamsize buffer_size =
+                          boost::iostreams::default_device_buffer_size)
+      : base_type(buffer_size) {}
+};
+
+/// @brief Makes CpioFilter pipable in Boost.Iostreams pipelines.
+BOOST_IOSTREAMS_PIPABLE(CpioFilter<>, 0);
+} // namespace boost_iostreams_tar_filter
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <boost-iostreams-tar-filter/entry.hxx>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace boost_iostreams_tar_filter::detail {
+/**
+ * @class BaseCpioFilterImpl
+ * @brief Core cpio parsing logic that operates on char buffers, the
+ * counterpart of BaseTarFilterImpl for SVR4 "newc" (070701), "crc" (070702)
+ * and POSIX "odc" (070707) archives.
+ *
+ * Entries are reported as the same Entry/EntryVisitor calls as TAR entries:
+ * file types are mapped to the TAR typeflags, symbolic link targets (stored
+ * as payload in cpio) become Entry::link_name, and newc hard links (only the
+ * last link carries the data) are reported as one regular file followed by
+ * Entry::HardLink entries pointing to it.
+ *
+ * Concatenated archives (as in initramfs images) are read as one: after a
+ * trailer, zero padding is skipped and parsing continues when another cpio
+ * header follows. Anything else after a trailer ends the parse.
+ */
+class BaseCpioFilterImpl {
+public:
+  /** @enum State Parsing states for the internal state machine. */
+  enum class State {
+    ReadHeader,
+    ReadName,
+    ReadLinkTarget,
+    ReadFileData,
+    SkipPadding,
+    SkipTrailerPadding,
+    Done
+  };
+
+  /** @enum Format Header format of the archive. */
+  enum class Format { Newc, Crc, Odc };
+
+  std::vector<char> header_buffer; /**< @brief Buffer accumulating the header,
+                                      name and link target of an entry. */
+  std::size_t header_bytes_read =
+      0; /**< @brief Number of bytes currently buffered. */
+  std::size_t header_bytes_needed =
+      0; /**< @brief Bytes to buffer before the current stage completes. */
+  std::size_t file_size_ =
+      0; /**< @brief Size of the current file entry in bytes. */
+  std::size_t file_bytes_read =
+      0; /**< @brief Number of bytes of the current file already read. */
+  std::size_t padding_bytes =
+      0; /**< @brief Number of padding bytes after the file. */
+  std::size_t padding_bytes_skipped =
+      0; /**< @brief Number of padding bytes already skipped. */
+  State state = State::ReadHeader; /**< @brief Current state of the parser. */
+  Format format = Format::Newc;    /**< @brief Format of the last header. */
+  Entry current_entry; /**< @brief Metadata of the entry currently being
+                          processed. */
+  bool skip_file_data =
+      false; /**< @brief Whether the visitor declined the current payload. */
+
+  /**
+   * @brief Process input cpio data and copy regular file contents to the
+   * destination buffer, like BaseTarFilterImpl::filter().
+   *
+   * @param src_begin Reference to beginning of source buffer; advanced by
+   * consumed bytes.
+   * @param src_end One-past-end pointer of source buffer.
+   * @param dest_begin Reference to beginning of destination buffer; advanced by
+   * written bytes.
+   * @param dest_end One-past-end pointer of destination buffer.
+   * @param flush Whether the source ends after src_end.
+   * @return true when more input/output activity may be possible.
+   * @return false once data that is not another archive followed a trailer,
+   * or the flushed input is used up.
+   * @throws std::ios_base::failure on a malformed header.
+   */
+  bool filter(const char *&src_begin, const char *const src_end,
+              char *&dest_begin, const char *const dest_end, bool flush);
+
+  /**
+   * @brief Process input cpio data and report entries to a visitor, handing
+   * over borrowed slices of the source buffer, like
+   * BaseTarFilterImpl::visit().
+   *
+   * @return true when more input is expected.
+   * @return false once data that is not another archive followed a trailer.
+   * @throws std::ios_base::failure on a malformed header.
+   */
+  bool visit(const char *&src_begin, const char *const src_end,
+             EntryVisitor &visitor);
+
+  /**
+   * @brief Number of upcoming input bytes the parser will consume without
+   * reporting them, see BaseTarFilterImpl::pending_discard().
+   */
+  std::size_t pending_discard() const;
+
+  /**
+   * @brief Consume count bytes of input without looking at them, see
+   * BaseTarFilterImpl::discard().
+   */
+  void discard(std::size_t count, EntryVisitor &visitor);
+
+  /**
+   * @brief Whether the input may end here: after a trailer, or once the
+   * parse ended.
+   */
+  bool complete() const {
+    return state == State::Done || state == State::SkipTrailerPadding;
+  }
+
+  /**
+   * @brief Reset the parser to initial state for reuse.
+   */
+  void close();
+
+private:
+  /** @brief Device and inode identifying the files of a hard link set. */
+  using InodeKey = std::tuple<std::uint64_t, std::uint64_t, std::uint64_t>;
+
+  /**
+   * @brief Buffer source bytes until header_bytes_needed are available.
+   */
+  bool read_header(const char *&src_begin, const char *const src_end);
+
+  /**
+   * @brief Advance through the ReadHeader, ReadName and ReadLinkTarget
+   * stages.
+   *
+   * @return true once the entry's metadata is complete.
+   */
+  bool read_metadata(const char *&src_begin, const char *const src_end);
+
+  /**
+   * @brief Decode the fixed-size header and size the name to read.
+   */
+  void parse_header();
+
+  /**
+   * @brief Decode the name and set up link/payload/padding counters.
+   */
+  void begin_entry();
+
+  /**
+   * @brief Skip the zero padding after a trailer.
+   *
+   * @return true once a non-zero byte, the start of the next header, is
+   * next in the source.
+   */
+  bool skip_trailer_padding(const char *&src_begin,
+                            const char *const src_end);
+
+  /**
+   * @brief Report the hard links deferred until the data-carrying link of
+   * the current entry was seen.
+   */
+  void report_links(EntryVisitor &visitor);
+
+  /**
+   * @brief Report hard link sets whose data-carrying link never appeared.
+   */
+  void report_remaining_links(EntryVisitor &visitor);
+
+  std::size_t fixed_header_size_ = 0;
+  std::size_t name_size_ = 0;
+  std::size_t name_padding_ = 0;
+  std::uint32_t nlink_ = 0;
+  InodeKey inode_{};
+  bool is_trailer_ = false;
+  bool after_trailer_ = false; /**< @brief The next header may be garbage
+                                  after the last archive. */
+  std::map<InodeKey, std::vector<Entry>> deferred_links_;
+  std::map<InodeKey, std::string> linked_names_;
+};
+} // namespace boost_iostreams_tar_filter::detail
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <boost-iostreams-tar-filter/entry.hxx>
+
 #include <cstddef>
+#include <cstdint>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -12,11 +16,25 @@ namespace boost_iostreams_tar_filter::detail {
  * This class implements a small state machine to parse TAR archives streamed
  * in 512-byte blocks. It is intentionally independent of any iostreams
  * interfaces so it can be tested and reused by templated adapter layers.
+ *
+ * pax extended headers ('x', 'g') and GNU long-name/long-link records ('L',
+ * 'K') are consumed by the parser itself: their path, linkpath, size, mtime,
+ * uid and gid are applied to the following entry ('g' to every following
+ * entry), and the records are never reported as entries.
  */
 class BaseTarFilterImpl {
 public:
   /** @enum State Parsing states for the internal state machine. */
-  enum class State { ReadHeader, ReadFileData, SkipPadding, Done };
+  enum class State {
+    ReadHeader,
+    ReadFileData,
+    ReadExtension,
+    SkipPadding,
+    Done
+  };
+
+  /** @brief Largest pax or GNU extension record the parser buffers. */
+  static constexpr std::size_t max_extension_size = std::size_t(1) << 20;
 
   // Public data members are intentionally simple to make the implementation
   // easy to introspect and to allow callers to allocate buffers externally.
@@ -36,6 +54,10 @@ public:
   State state = State::ReadHeader; /**< @brief Current state of the parser. */
   std::string current_file_name;   /**< @brief Name of the file currently being
                                       processed. */
+  Entry current_entry; /**< @brief Metadata of the entry currently being
+                          processed. */
+  bool skip_file_data =
+      false; /**< @brief Whether the visitor declined the current payload. */
 
   /**
    * @brief Construct a BaseTarFilterImpl and initialize internal state.
@@ -65,9 +87,135 @@ public:
   bool filter(const char *&src_begin, const char *const src_end,
               char *&dest_begin, const char *const dest_end, bool flush);
 
+  /**
+   * @brief Process input TAR data and report entries to a visitor.
+   *
+   * Runs the same state machine as filter(), but instead of copying payload
+   * bytes into a destination buffer it hands borrowed slices of the source
+   * buffer to the visitor. Every entry is reported, including directories and
+   * links; only regular files carry payload. Extension records are applied,
+   * not reported.
+   *
+   * @param src_begin Reference to beginning of source buffer; advanced by
+   * consumed bytes.
+   * @param src_end One-past-end pointer of source buffer.
+   * @param visitor Receiver of entry metadata and payload slices.
+   * @return true when more input is expected.
+   * @return false when the end-of-archive marker was reached.
+   * @throws std::ios_base::failure on a malformed or oversized extension
+   * record.
+   */
+  bool visit(const char *&src_begin, const char *const src_end,
+             EntryVisitor &visitor);
+
+  /**
+   * @brief Number of upcoming input bytes the parser will consume without
+   * reporting them: padding, and the payload of an entry the visitor
+   * declined.
+   *
+   * Readers can use it to skip those bytes cheaply (seeking, or inflating
+   * into a scratch window) and account for them with discard().
+   */
+  std::size_t pending_discard() const;
+
+  /**
+   * @brief Consume count bytes of input without looking at them.
+   *
+   * Equivalent to visit() over count bytes when count <= pending_discard(),
+   * including the EntryVisitor::on_entry_end() call of a declined entry
+   * whose payload ends within them.
+   */
+  void discard(std::size_t count, EntryVisitor &visitor);
+
+  /**
+   * @brief Input offset of the first block of current_entry: its first
+   * extension record, or its header when it has none.
+   */
+  std::uint64_t entry_offset() const { return entry_offset_; }
+
+  /**
+   * @brief Tell the parser that the input continues in the next volume of a
+   * GNU multi-volume archive.
+   *
+   * Call it after the current volume's bytes were consumed. A 'V' volume
+   * label at the start of the next volume is skipped. When the volume ended
+   * inside a regular file's payload, the next volume must start with the 'M'
+   * continuation header of that file; the payload then continues as part of
+   * the same entry, without another EntryVisitor::on_entry_begin() call.
+   *
+   * @throws std::ios_base::failure when the volume ended inside a header or
+   * padding.
+   */
+  void begin_volume();
+
+  /**
+   * @brief Whether the end-of-archive marker was reached.
+   */
+  bool complete() const { return state == State::Done; }
+
   /**
    * @brief Reset the parser to initial state for reuse.
    */
   void close();
+
+private:
+  /**
+   * @brief Buffer header bytes from the source.
+   *
+   * @return true once a complete 512-byte header is available.
+   */
+  bool read_header(const char *&src_begin, const char *const src_end);
+
+  /**
+   * @brief Decode the buffered header into current_entry and set up the
+   * payload/padding counters for it.
+   *
+   * @return false when the header starts an extension record, which is not
+   * reported.
+   */
+  bool begin_entry();
+
+  /**
+   * @brief Buffer extension record bytes from the source and apply the
+   * record once complete.
+   */
+  void read_extension(const char *&src_begin, const char *const src_end);
+
+  /** @brief Fields overridden by pax or GNU extension records. */
+  struct Overrides {
+    std::optional<std::string> path;
+    std::optional<std::string> link_path;
+    std::optional<std::size_t> size;
+    std::optional<std::int64_t> mtime;
+    std::optional<std::uint32_t> uid;
+    std::optional<std::uint32_t> gid;
+  };
+
+  /** @brief Parse the buffered extension record into the overrides. */
+  void apply_extension();
+
+  /**
+   * @brief Consume the header buffered at the start of a continuation
+   * volume if it is a volume label or the expected 'M' header.
+   *
+   * @return true when the header was consumed and must not be reported.
+   * @throws std::ios_base::failure when a continuation header is missing or
+   * does not match the interrupted entry.
+   */
+  bool continue_volume();
+
+  bool volume_start_ = false; /**< @brief At the start of a continuation
+                                 volume. */
+  bool continuation_pending_ =
+      false; /**< @brief The previous volume ended inside a payload. */
+  std::uint64_t input_offset_ = 0; /**< @brief Input bytes consumed. */
+  std::uint64_t entry_offset_ = 0; /**< @brief See entry_offset(). */
+  std::optional<std::uint64_t>
+      extension_offset_; /**< @brief Offset of the first pending extension
+                            record. */
+  char extension_type_ = 0;    /**< @brief Typeflag of the record being read. */
+  std::string extension_data_; /**< @brief Contents of that record. */
+  Overrides pending_; /**< @brief Overrides for the next entry. */
+  Overrides global_;  /**< @brief Overrides from 'g' records. */
 };
 } // namespace boost_iostreams_tar_filter::detail
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+namespace boost_iostreams_tar_filter::detail {
+/**
+ * @class BoundedQueue
+ * @brief Blocking single-producer/single-consumer queue with a fixed
+ * capacity.
+ *
+ * push() blocks while the queue is full, which is how pipeline stages pass
+ * backpressure from a slow consumer back to the reading thread. close() wakes
+ * both sides; pop() then drains the remaining items and returns
+ * std::nullopt.
+ *
+ * @tparam T Item type.
+ */
+template <typename T> class BoundedQueue {
+public:
+  /**
+   * @param capacity Maximum number of queued items (at least 1).
+   */
+  explicit BoundedQueue(std::size_t capacity)
+      : capacity_(capacity ? capacity : 1) {}
+
+  /**
+   * @brief Enqueue an item, waiting for space.
+   *
+   * @return false when the queue was closed and the item was dropped.
+   */
+  bool push(T item) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_full_.wait(lock,
+                   [this] { return closed_ || items_.size() < capacity_; });
+    if (closed_)
+      return false;
+    items_.push_back(std::move(item));
+    not_empty_.notify_one();
+    return true;
+  }
+
+  /**
+   * @brief Dequeue an item, waiting until one is available.
+   *
+   * @return The item, or std::nullopt once the queue is closed and empty.
+   */
+  std::optional<T> pop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_empty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+    if (items_.empty())
+      return std::nullopt;
+    std::optional<T> item(std::move(items_.front()));
+    items_.pop_front();
+    not_full_.notify_one();
+    return item;
+  }
+
+  /**
+   * @brief Stop accepting items and wake every waiter.
+   */
+  void close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    not_empty_.notify_all();
+    not_full_.notify_all();
+  }
+
+private:
+  std::size_t capacity_;
+  std::mutex mutex_;
+  std::condition_variable not_full_;
+  std::condition_variable not_empty_;
+  std::deque<T> items_;
+  bool closed_ = false;
+};
+} // namespace boost_iostreams_tar_filter::detail
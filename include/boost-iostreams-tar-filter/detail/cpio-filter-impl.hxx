@@ -0,0 +1,40 @@
+#pragma once
+
+#include "base-cpio-filter-impl.hxx"
+#include <memory>
+
+namespace boost_iostreams_tar_filter::detail {
+namespace {
+/**
+ * @brief cpio streaming filter adapter templated on allocator/char type, see
+ * TarFilterImpl.
+ *
+ * @tparam Alloc Allocator type whose value_type defines the char_type (defaults
+ * to std::allocator<char>).
+ */
+template <typename Alloc = std::allocator<char>>
+class CpioFilterImpl : public BaseCpioFilterImpl {
+public:
+  using char_type = typename Alloc::value_type;
+
+  bool filter(const char_type *&src_begin, const char_type *const src_end,
+              char_type *&dest_begin, const char_type *const dest_end,
+              bool flush) {
+    auto src_b = reinterpret_cast<const char *>(src_begin);
+    auto src_e = reinterpret_cast<const char *>(src_end);
+    auto dest_b = reinterpret_cast<char *>(dest_begin);
+    auto dest_e = reinterpret_cast<const char *>(dest_end);
+
+    bool result =
+        BaseCpioFilterImpl::filter(src_b, src_e, dest_b, dest_e, flush);
+
+    src_begin = reinterpret_cast<const char_type *>(src_b);
+    dest_begin = reinterpret_cast<char_type *>(dest_b);
+
+    return result;
+  }
+
+  void close() { BaseCpioFilterImpl::close(); }
+};
+} // namespace
+} // namespace boost_iostreams_tar_filter::detail
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <boost-iostreams-tar-filter/inflate-engine.hxx>
+
+#include <memory>
+
+namespace boost_iostreams_tar_filter::detail {
+class Inflater;
+
+/**
+ * @class BaseGzipDecompressorImpl
+ * @brief Symmetric filter implementation inflating gzip data with the
+ * selected InflateEngine.
+ *
+ * Concatenated gzip members are decompressed as one stream.
+ */
+class BaseGzipDecompressorImpl {
+public:
+  /**
+   * @throws std::invalid_argument when engine is not compiled in.
+   */
+  explicit BaseGzipDecompressorImpl(InflateEngine engine);
+  ~BaseGzipDecompressorImpl();
+
+  /**
+   * @brief Inflate from the source buffer into the destination buffer.
+   *
+   * @param src_begin Reference to beginning of source buffer; advanced by
+   * consumed bytes.
+   * @param src_end One-past-end pointer of source buffer.
+   * @param dest_begin Reference to beginning of destination buffer; advanced by
+   * written bytes.
+   * @param dest_end One-past-end pointer of destination buffer.
+   * @param flush true once the source is exhausted.
+   * @return true while more output may follow.
+   * @return false once the last member was fully decompressed.
+   * @throws std::ios_base::failure on corrupt or truncated input.
+   */
+  bool filter(const char *&src_begin, const char *const src_end,
+              char *&dest_begin, const char *const dest_end, bool flush);
+
+  /**
+   * @brief Reset the engine so the filter can be reused.
+   */
+  void close();
+
+private:
+  std::unique_ptr<Inflater> inflater_;
+};
+
+namespace {
+/**
+ * @brief Gzip decompressor adapter templated on allocator/char type, see
+ * TarFilterImpl.
+ *
+ * @tparam Alloc Allocator type whose value_type defines the char_type (defaults
+ * to std::allocator<char>).
+ */
+template <typename Alloc = std::allocator<char>>
+class GzipDecompressorImpl : public BaseGzipDecompressorImpl {
+public:
+  using char_type = typename Alloc::value_type;
+
+  explicit GzipDecompressorImpl(InflateEngine engine)
+      : BaseGzipDecompressorImpl(engine) {}
+
+  bool filter(const char_type *&src_begin, const char_type *const src_end,
+              char_type *&dest_begin, const char_type *const dest_end,
+              bool flush) {
+    auto src_b = reinterpret_cast<const char *>(src_begin);
+    auto src_e = reinterpret_cast<const char *>(src_end);
+    auto dest_b = reinterpret_cast<char *>(dest_begin);
+    auto dest_e = reinterpret_cast<const char *>(dest_end);
+
+    bool result =
+        BaseGzipDecompressorImpl::filter(src_b, src_e, dest_b, dest_e, flush);
+
+    src_begin = reinterpret_cast<const char_type *>(src_b);
+    dest_begin = reinterpret_cast<char_type *>(dest_b);
+
+    return result;
+  }
+
+  void close() { BaseGzipDecompressorImpl::close(); }
+};
+} // namespace
+} // namespace boost_iostreams_tar_filter::detail
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+namespace boost_iostreams_tar_filter::detail {
+class Lz4FrameDecoder;
+
+/**
+ * @class BaseLz4FrameDecompressorImpl
+ * @brief Symmetric filter implementation decoding LZ4 frames.
+ *
+ * Blocks of frames written in independent-block mode are decoded on a
+ * worker pool and emitted in input order. Linked-block frames depend on the
+ * previous 64 KiB of output and are decoded on the calling thread.
+ * Concatenated and skippable frames are supported.
+ */
+class BaseLz4FrameDecompressorImpl {
+public:
+  /**
+   * @param threads Worker threads; 0 selects the hardware concurrency.
+   * @param max_in_flight Maximum number of blocks queued or decoded ahead of
+   * the output; 0 selects twice the thread count.
+   */
+  BaseLz4FrameDecompressorImpl(std::size_t threads, std::size_t max_in_flight);
+  ~BaseLz4FrameDecompressorImpl();
+
+  /**
+   * @brief Consume all of the source buffer and emit decoded blocks in order.
+   *
+   * @param src_begin Reference to beginning of source buffer; advanced by
+   * consumed bytes.
+   * @param src_end One-past-end pointer of source buffer.
+   * @param dest_begin Reference to beginning of destination buffer; advanced by
+   * written bytes.
+   * @param dest_end One-past-end pointer of destination buffer.
+   * @param flush true once the source is exhausted.
+   * @return true while more output may follow.
+   * @return false once the last block was emitted.
+   * @throws std::ios_base::failure on corrupt or truncated input.
+   */
+  bool filter(const char *&src_begin, const char *const src_end,
+              char *&dest_begin, const char *const dest_end, bool flush);
+
+  /**
+   * @brief Drop all state so the filter can be reused.
+   */
+  void close();
+
+private:
+  std::unique_ptr<Lz4FrameDecoder> decoder_;
+};
+
+namespace {
+/**
+ * @brief LZ4 frame adapter templated on allocator/char type, see
+ * TarFilterImpl.
+ *
+ * @tparam Alloc Allocator type whose value_type defines the char_type (defaults
+ * to std::allocator<char>).
+ */
+template <typename Alloc = std::allocator<char>>
+class Lz4FrameDecompressorImpl : public BaseLz4FrameDecompressorImpl {
+public:
+  using char_type = typename Alloc::value_type;
+
+  Lz4FrameDecompressorImpl(std::size_t threads, std::size_t max_in_flight)
+      : BaseLz4FrameDecompressorImpl(threads, max_in_flight) {}
+
+  bool filter(const char_type *&src_begin, const char_type *const src_end,
+              char_type *&dest_begin, const char_type *const dest_end,
+              bool flush) {
+    auto src_b = reinterpret_cast<const char *>(src_begin);
+    auto src_e = reinterpret_cast<const char *>(src_end);
+    auto dest_b = reinterpret_cast<char *>(dest_begin);
+    auto dest_e = reinterpret_cast<const char *>(dest_end);
+
+    bool result = BaseLz4FrameDecompressorImpl::filter(src_b, src_e, dest_b,
+                                                       dest_e, flush);
+
+    src_begin = reinterpret_cast<const char_type *>(src_b);
+    dest_begin = reinterpret_cast<char_type *>(dest_b);
+
+    return result;
+  }
+
+  void close() { BaseLz4FrameDecompressorImpl::close(); }
+};
+} // namespace
+} // namespace boost_iostreams_tar_filter::detail
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace boost_iostreams_tar_filter::detail {
+/**
+ * @class WorkerPool
+ * @brief Fixed-size pool of threads executing submitted jobs in FIFO order.
+ *
+ * Parallel stages use the pool to move CPU-heavy work (decompression,
+ * parsing, hashing) off the thread that reads the archive. Results are
+ * returned through std::future so callers can restore archive order.
+ */
+class WorkerPool {
+public:
+  /**
+   * @brief Start the worker threads.
+   *
+   * @param threads Number of worker threads; 0 selects
+   * std::thread::hardware_concurrency().
+   */
+  explicit WorkerPool(std::size_t threads = 0);
+
+  /**
+   * @brief Finish all queued jobs and join the worker threads.
+   */
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+
+  /**
+   * @brief Queue a callable for execution on a worker thread.
+   *
+   * Exceptions thrown by the callable are rethrown from std::future::get().
+   *
+   * @param job Callable taking no arguments.
+   * @return std::future holding the callable's result.
+   */
+  template <typename F>
+  auto submit(F &&job) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+    using result_type = std::invoke_result_t<std::decay_t<F>>;
+    auto task =
+        std::make_shared<std::packaged_task<result_type()>>(std::forward<F>(job));
+    auto future = task->get_future();
+    push([task] { (*task)(); });
+    return future;
+  }
+
+  /** @brief Number of worker threads. */
+  std::size_t size() const { return threads_.size(); }
+
+private:
+  void push(std::function<void()> job);
+  void run();
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<std::function<void()>> jobs_;
+  std::vector<std::thread> threads_;
+  bool stopping_ = false;
+};
+} // namespace boost_iostreams_tar_filter::detail
@@ -0,0 +1,71 @@
+/**
+ * @file entry-reader.hxx
+ * @brief Decodes one named entry straight into a caller-provided buffer.
+ */
+
+#pragma once
+
+#include <boost-iostreams-tar-filter/entry.hxx>
+#include <boost-iostreams-tar-filter/gzip-index.hxx>
+
+#include <cstddef>
+#include <filesystem>
+#include <istream>
+#include <optional>
+#include <span>
+#include <string>
+
+namespace boost_iostreams_tar_filter {
+/**
+ * @brief Read the payload of the file named name from an uncompressed TAR
+ * file into out.
+ *
+ * Like extraction, the last entry of the path decides: when the path is
+ * stored more than once, every header is read and the last copy is
+ * returned, and when that copy is not a regular file there is no match.
+ * Only headers are read on the way to the entry. The payload is read with
+ * pread() straight into out, so it is copied once, from the page cache into
+ * the caller's buffer, which may be pinned or backed by huge pages.
+ *
+ * @code{.cpp}
+ * std::vector<std::byte> blob(size_from_manifest);
+ * read_entry_into("models.tar", "model.bin", blob);
+ * @endcode
+ *
+ * @param out Destination; its first entry.size bytes are written.
+ * @return The entry, or std::nullopt when the archive has no such file.
+ * @throws std::invalid_argument when out is smaller than the payload.
+ * @throws std::system_error when the archive cannot be opened or read.
+ * @throws std::ios_base::failure when the archive ends inside the payload.
+ */
+std::optional<Entry> read_entry_into(const std::filesystem::path &archive,
+                                     const std::string &name,
+                                     std::span<std::byte> out);
+
+/**
+ * @brief Same as above for an uncompressed TAR stream.
+ *
+ * Other payloads are seeked over on seekable streams and ignored otherwise;
+ * the payload of every copy of the path that fits is read with
+ * std::istream::read() into out, which finally holds the last one. A
+ * boost::iostreams::stream over a mapped_file_source reads from the mapping
+ * with a single copy.
+ *
+ * @param in Stream positioned at the first TAR header.
+ */
+std::optional<Entry> read_entry_into(std::istream &in, const std::string &name,
+                                     std::span<std::byte> out);
+
+/**
+ * @brief Same as above for a .tar.gz with a GzipIndex: the index names the
+ * last copy of the path, inflation restarts from the checkpoint before it,
+ * and zlib writes the payload directly into out.
+ *
+ * @param compressed Seekable stream over the compressed archive.
+ * @throws std::ios_base::failure on corrupt data or a stale index.
+ */
+std::optional<Entry> read_entry_into(const GzipIndex &index,
+                                     std::istream &compressed,
+                                     const std::string &name,
+                                     std::span<std::byte> out);
+} // namespace boost_iostreams_tar_filter
@@ -0,0 +1,98 @@
+/**
+ * @file entry.hxx
+ * @brief Archive entry metadata and the visitor interface used to stream
+ * entries out of an archive.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace boost_iostreams_tar_filter {
+/**
+ * @brief Metadata describing a single archive entry.
+ *
+ * An Entry is filled from the archive header before any payload bytes of the
+ * entry are delivered. Numeric fields are already decoded from their on-disk
+ * representation (octal ASCII or base-256).
+ */
+struct Entry {
+  /** @brief Entry type flags, matching the TAR typeflag byte. */
+  enum Type : char {
+    RegularFile = '0',
+    HardLink = '1',
+    SymbolicLink = '2',
+    CharacterDevice = '3',
+    BlockDevice = '4',
+    Directory = '5',
+    Fifo = '6',
+  };
+
+  std::string name;        /**< @brief Path of the entry inside the archive. */
+  std::string link_name;   /**< @brief Link target for hard/symbolic links. */
+  std::size_t size = 0;    /**< @brief Payload size in bytes. */
+  std::uint32_t mode = 0;  /**< @brief Permission bits. */
+  std::uint32_t uid = 0;   /**< @brief Owner user ID. */
+  std::uint32_t gid = 0;   /**< @brief Owner group ID. */
+  std::int64_t mtime = 0;  /**< @brief Modification time (seconds since epoch). */
+  char type = RegularFile; /**< @brief Raw typeflag of the entry. */
+
+  /** @brief true when the entry carries regular file contents. */
+  bool is_regular_file() const { return type == RegularFile || type == '\0'; }
+  /** @brief true when the entry is a directory. */
+  bool is_directory() const { return type == Directory; }
+  /** @brief true when the entry is a symbolic link. */
+  bool is_symlink() const { return type == SymbolicLink; }
+  /** @brief true when the entry is a hard link to an earlier entry. */
+  bool is_hard_link() const { return type == HardLink; }
+};
+
+/**
+ * @brief Receives entries and their payload while an archive is parsed.
+ *
+ * For every entry the parser calls on_entry_begin() once, then
+ * on_entry_data() zero or more times with consecutive slices of the payload,
+ * then on_entry_end() once. Payload slices are borrowed from the parser's
+ * input buffer: they are only valid for the duration of the call and must be
+ * copied if they need to outlive it.
+ */
+class EntryVisitor {
+public:
+  virtual ~EntryVisitor() = default;
+
+  /**
+   * @brief Called when the header of a new entry has been parsed.
+   *
+   * @param entry Metadata of the entry.
+   * @return true to receive the payload through on_entry_data().
+   * @return false to skip the payload; on_entry_end() is still called.
+   */
+  virtual bool on_entry_begin(const Entry &entry) = 0;
+
+  /**
+   * @brief Called with the next slice of the current entry's payload.
+   *
+   * @param begin Start of the borrowed slice.
+   * @param end One-past-end of the borrowed slice.
+   */
+  virtual void on_entry_data(const char *begin, const char *end) = 0;
+
+  /**
+   * @brief Called after the last payload byte of the entry was delivered (or
+   * skipped).
+   *
+   * @param entry Metadata of the entry that just finished.
+   */
+  virtual void on_entry_end(const Entry &entry) = 0;
+
+  /**
+   * @brief Called by drivers such as visit_tar() after each input buffer has
+   * been consumed, right before the buffer is reused.
+   *
+   * Visitors that batch borrowed slices must flush them here.
+   */
+  virtual void on_buffer_end() {}
+};
+} // namespace boost_iostreams_tar_filter
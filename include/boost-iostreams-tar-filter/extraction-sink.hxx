@@ -0,0 +1,306 @@
+/**
+ * @file extraction-sink.hxx
+ * @brief Batched destinations for extracted entries: the filesystem, an
+ * in-memory map, or a user callback.
+ */
+
+#pragma once
+
+#include <boost-iostreams-tar-filter/entry.hxx>
+#include <boost-iostreams-tar-filter/sha256.hxx>
+#include <boost/iostreams/constants.hpp>
+
+#include <cstddef>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <istream>
+#include <map>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace boost_iostreams_tar_filter {
+/**
+ * @brief One contiguous piece of an entry inside an extraction batch.
+ *
+ * Each entry contributes at most one item per batch. An entry whose payload
+ * spans several input buffers shows up in several consecutive batches: the
+ * first item has begins_entry set, the last one ends_entry. Entries without
+ * payload produce a single item with both flags set and empty data.
+ */
+struct ExtractionItem {
+  const Entry *entry = nullptr; /**< @brief Entry metadata. */
+  std::size_t offset = 0; /**< @brief Offset of data within the payload. */
+  std::span<const char> data; /**< @brief Borrowed payload bytes. */
+  bool begins_entry = false;  /**< @brief First item of the entry. */
+  bool ends_entry = false;    /**< @brief Last item of the entry. */
+};
+
+/**
+ * @brief Destination for extracted entries, fed in batches.
+ *
+ * A batch covers everything parsed out of one input buffer, so the virtual
+ * call is paid per buffer rather than per entry or per slice. Items and the
+ * entries they point to are only valid during consume().
+ */
+class ExtractionSink {
+public:
+  virtual ~ExtractionSink() = default;
+
+  /**
+   * @brief Process a batch of items, in archive order.
+   */
+  virtual void consume(std::span<const ExtractionItem> batch) = 0;
+
+  /**
+   * @brief Called once after the last batch.
+   */
+  virtual void finish() {}
+};
+
+/**
+ * @brief EntryVisitor that groups entries and borrowed payload slices into
+ * batches and hands them to an ExtractionSink at every buffer boundary.
+ */
+class ExtractionVisitor : public EntryVisitor {
+public:
+  explicit ExtractionVisitor(ExtractionSink &sink) : sink_(sink) {}
+
+  bool on_entry_begin(const Entry &entry) override;
+  void on_entry_data(const char *begin, const char *end) override;
+  void on_entry_end(const Entry &entry) override;
+  void on_buffer_end() override;
+
+private:
+  ExtractionItem &current_item();
+
+  ExtractionSink &sink_;
+  std::deque<Entry> entries_;
+  std::vector<ExtractionItem> items_;
+  std::size_t offset_ = 0;
+  bool in_entry_ = false;
+  bool item_open_ = false;
+};
+
+/**
+ * @brief Parse a TAR stream and feed it to a sink.
+ *
+ * @param in Stream positioned at the first TAR header.
+ * @param sink Destination of the entries.
+ * @param buffer_size Size of the read buffer, which is also the batch size.
+ * @return true when the end-of-archive marker was reached.
+ */
+bool extract_tar(std::istream &in, ExtractionSink &sink,
+                 std::size_t buffer_size =
+                     boost::iostreams::default_device_buffer_size);
+
+/**
+ * @brief Sink that keeps every entry in memory.
+ */
+class MemorySink : public ExtractionSink {
+public:
+  void consume(std::span<const ExtractionItem> batch) override;
+
+  /** @brief Contents of regular files, by entry name; the last entry of a
+   * path wins. */
+  const std::map<std::string, std::string> &files() const { return files_; }
+  /** @brief Metadata of every entry, in archive order. */
+  const std::vector<Entry> &entries() const { return entries_; }
+
+private:
+  std::map<std::string, std::string> files_;
+  std::vector<Entry> entries_;
+};
+
+/**
+ * @brief Sink forwarding each batch to a callable.
+ */
+class CallbackSink : public ExtractionSink {
+public:
+  using Callback = std::function<void(std::span<const ExtractionItem>)>;
+
+  explicit CallbackSink(Callback callback) : callback_(std::move(callback)) {}
+
+  void consume(std::span<const ExtractionItem> batch) override {
+    callback_(batch);
+  }
+
+private:
+  Callback callback_;
+};
+
+/**
+ * @brief How FilesystemSink materializes a duplicate of an earlier file.
+ */
+enum class DedupLink {
+  HardLink, /**< @brief link(): the copies share one inode. */
+  Reflink,  /**< @brief FICLONE: separate inodes sharing extents. */
+};
+
+/**
+ * @brief Behaviour switches for FilesystemSink.
+ */
+struct FilesystemSinkOptions {
+  /**
+   * @brief Leave regular files alone when the target already exists with the
+   * size and modification time recorded in the header.
+   *
+   * Targets are checked with fstatat() once per batch, through the
+   * directory-fd cache, before anything in the batch is written.
+   */
+  bool skip_unchanged = false;
+
+  /**
+   * @brief Hash regular file payloads in-stream and link files whose
+   * contents were already extracted to the first copy instead of writing
+   * them again.
+   *
+   * Files up to dedup_buffer_limit bytes are held in memory until their
+   * digest is known, so duplicates are never written. Larger files are
+   * streamed to disk as usual and only serve as link targets for later
+   * duplicates. When linking fails (e.g. across filesystems, or FICLONE on a
+   * filesystem without reflinks) the file is written normally. A later
+   * entry overwriting a path replaces it with a new inode, so files linked
+   * to the old contents keep them.
+   */
+  bool deduplicate = false;
+
+  /** @brief Link flavour used by deduplicate. */
+  DedupLink dedup_link = DedupLink::HardLink;
+
+  /** @brief Largest file buffered for deduplication. */
+  std::size_t dedup_buffer_limit = 1 << 20;
+
+  /**
+   * @brief Keep the SHA-256 of every extracted regular file, computed while
+   * it streams through the sink, for verify_extraction().
+   */
+  bool record_digests = false;
+};
+
+/**
+ * @brief Sink that writes entries below a root directory.
+ *
+ * Regular files, directories, symbolic links and hard links are created
+ * relative to cached directory file descriptors (openat() and friends), so
+ * path resolution is paid once per directory rather than once per file.
+ * Leading `/` and `./` are stripped from entry names and names containing a
+ * `..` component are rejected. Symbolic links are created as they are, but
+ * never followed while extracting: directories are opened with O_NOFOLLOW
+ * one component at a time, so an entry below a symlink fails with ELOOP,
+ * and an existing target is unlinked before a regular file is created in
+ * its place. Regular files get the modification time recorded in their
+ * header.
+ *
+ * OS errors are reported as std::system_error.
+ */
+class FilesystemSink : public ExtractionSink {
+public:
+  /**
+   * @param root Directory to extract into; created if missing.
+   * @param options Behaviour switches.
+   */
+  explicit FilesystemSink(const std::filesystem::path &root,
+                          FilesystemSinkOptions options = {});
+  ~FilesystemSink() override;
+
+  FilesystemSink(const FilesystemSink &) = delete;
+  FilesystemSink &operator=(const FilesystemSink &) = delete;
+
+  void consume(std::span<const ExtractionItem> batch) override;
+  void finish() override;
+
+  /** @brief Number of regular files left untouched by skip_unchanged. */
+  std::size_t skipped() const { return skipped_; }
+
+  /** @brief Number of regular files linked to an earlier copy. */
+  std::size_t linked() const { return linked_; }
+
+  /**
+   * @brief Digests recorded with record_digests, keyed by the path relative
+   * to the root.
+   */
+  const std::unordered_map<std::string, Digest> &digests() const {
+    return digests_;
+  }
+
+private:
+  /**
+   * @brief Split a sanitized entry name into parent directory and base name.
+   */
+  static std::pair<std::string, std::string> split_path(const std::string &name);
+
+  /**
+   * @brief Return an fd for a directory below the root, creating the
+   * directory chain if needed. The fd stays owned by the cache.
+   */
+  int directory_fd(const std::string &dir);
+
+  /**
+   * @brief Create the entry's file (or directory/link) and, for regular
+   * files, open it for writing into file_fd_.
+   */
+  void begin_entry(const Entry &entry);
+
+  /**
+   * @brief Append payload bytes to the current file.
+   */
+  void write_data(std::span<const char> data);
+
+  /**
+   * @brief Close the current file.
+   */
+  void end_entry(const Entry &entry);
+
+  /**
+   * @brief Replace the target of a regular file entry with a new file and
+   * open it for writing into file_fd_.
+   */
+  void open_file(const Entry &entry);
+
+  /**
+   * @brief Close file_fd_ after stamping it with the entry's mtime.
+   */
+  void close_file(const Entry &entry);
+
+  /**
+   * @brief Materialize entry as a link to the previously extracted path.
+   *
+   * @return false when linking failed and the caller must write the file.
+   */
+  bool link_duplicate(const std::string &first_path, const Entry &entry);
+
+  /**
+   * @brief Stop using path as the first copy of its contents.
+   */
+  void forget_first_copy(const std::string &path);
+
+  /**
+   * @brief Check whether the target of a regular file entry already matches
+   * the header's size and modification time.
+   */
+  bool is_unchanged(const Entry &entry);
+
+  /** @brief Close every cached directory fd. */
+  void close_directories();
+
+  FilesystemSinkOptions options_;
+  int root_fd_ = -1;
+  int file_fd_ = -1;
+  bool skipping_ = false;
+  bool regular_ = false;
+  bool hashing_ = false;
+  bool buffering_ = false;
+  std::size_t skipped_ = 0;
+  std::size_t linked_ = 0;
+  std::vector<char> unchanged_;
+  std::string pending_;
+  Sha256 hasher_;
+  std::unordered_map<Digest, std::string, DigestHash> first_copies_;
+  std::unordered_map<std::string, Digest> first_copy_digests_;
+  std::unordered_map<std::string, Digest> digests_;
+  std::unordered_map<std::string, int> directories_;
+};
+} // namespace boost_iostreams_tar_filter
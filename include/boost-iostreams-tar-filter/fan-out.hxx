@@ -0,0 +1,82 @@
+/**
+ * @file fan-out.hxx
+ * @brief Delivers one (decompressed) archive stream to several consumers
+ * running on their own threads.
+ */
+
+#pragma once
+
+#include <boost-iostreams-tar-filter/entry.hxx>
+#include <boost/iostreams/constants.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <vector>
+
+namespace boost_iostreams_tar_filter {
+/**
+ * @brief Tee stage that reads a stream once and shares every buffer with
+ * multiple consumer threads.
+ *
+ * Buffers are reference counted and shared, never copied per consumer. Each
+ * consumer owns a bounded queue; the reading thread blocks while any queue
+ * is full, so the slowest consumer sets the pace.
+ *
+ * Typically the stream is a filtering_istream ending in gzip_decompressor,
+ * so the archive is read and inflated once no matter how many consumers
+ * process it:
+ *
+ * @code{.cpp}
+ * io::filtering_istream in;
+ * in.push(io::gzip_decompressor());
+ * in.push(io::file_source("a.tar.gz", std::ios::binary));
+ *
+ * FanOut fan_out;
+ * fan_out.add_consumer([&](const char *b, const char *e) { hash(b, e); });
+ * fan_out.add_consumer(indexer);   // EntryVisitor
+ * fan_out.add_consumer(extractor); // EntryVisitor
+ * fan_out.run(in);
+ * @endcode
+ */
+class FanOut {
+public:
+  /** @brief Consumer receiving the raw bytes of the stream, in order. */
+  using RawConsumer = std::function<void(const char *begin, const char *end)>;
+
+  /**
+   * @param buffer_size Size of each shared read buffer.
+   * @param queue_depth Number of buffers each consumer may lag behind.
+   */
+  explicit FanOut(std::size_t buffer_size =
+                      boost::iostreams::default_device_buffer_size,
+                  std::size_t queue_depth = 8);
+
+  /**
+   * @brief Register a consumer of raw bytes.
+   */
+  void add_consumer(RawConsumer consumer);
+
+  /**
+   * @brief Register a consumer that parses the stream as TAR with its own
+   * BaseTarFilterImpl and reports entries to the visitor.
+   *
+   * The visitor is called from the consumer's thread.
+   */
+  void add_consumer(EntryVisitor &visitor);
+
+  /**
+   * @brief Read the stream to the end, feed every consumer and wait for them
+   * to finish.
+   *
+   * A consumer that throws stops receiving data without stalling the others;
+   * the first such exception is rethrown once all consumers are done.
+   */
+  void run(std::istream &in);
+
+private:
+  std::size_t buffer_size_;
+  std::size_t queue_depth_;
+  std::vector<RawConsumer> consumers_;
+};
+} // namespace boost_iostreams_tar_filter
@@ -0,0 +1,63 @@
+/**
+ * @file gzip-decompressor.hxx
+ * @brief Gzip decompressor filter backed by a selectable inflate engine.
+ */
+
+#pragma once
+
+#include <boost-iostreams-tar-filter/detail/gzip-decompressor-impl.hxx>
+#include <boost-iostreams-tar-filter/inflate-engine.hxx>
+#include <boost/iostreams/filter/symmetric.hpp>
+
+namespace boost_iostreams_tar_filter {
+/**
+ * @brief Boost.Iostreams-compatible replacement for gzip_decompressor running
+ * on zlib, zlib-ng, libdeflate or ISA-L.
+ *
+ * @tparam Alloc Allocator type for internal buffers (default:
+ * std::allocator<char>)
+ *
+ * @code{.cpp}
+ * io::filtering_istream in;
+ * in.push(TarFilter<>());
+ * in.push(GzipDecompressor<>());
+ * in.push(io::file_source("a.tar.gz", std::ios::binary));
+ * @endcode
+ *
+ * @note With InflateEngine::Libdeflate the whole compressed stream is
+ * buffered and decompressed at once, since libdeflate has no streaming API;
+ * streams over libdeflate_max_input bytes throw std::ios_base::failure. The
+ * engine is never the default and is meant for small, trusted inputs.
+ */
+template <typename Alloc = std::allocator<char>>
+struct GzipDecompressor
+    : boost::iostreams::symmetric_filter<detail::GzipDecompressorImpl<Alloc>,
+                                         Alloc> {
+private:
+  using impl_type = detail::GzipDecompressorImpl<Alloc>;
+  using base_type = boost::iostreams::symmetric_filter<impl_type, Alloc>;
+
+public:
+  /// Character type used by the stream.
+  using char_type = typename base_type::char_type;
+  /// Filter category for Boost.Iostreams.
+  using category = typename base_type::category;
+
+  /**
+   * @brief Constructs the decompressor.
+   *
+   * @param engine Inflate implementation to use.
+   * @param buffer_size Buffer size used internally (defaults to
+   * Boost.Iostreams' default size).
+   * @throws std::invalid_argument when engine is not compiled in.
+   */
+  explicit GzipDecompressor(
+      InflateEngine engine = default_inflate_engine(),
+      std::streamsize buffer_size =
+          boost::iostreams::default_device_buffer_size)
+      : base_type(buffer_size, engine) {}
+};
+
+/// @brief Makes GzipDecompressor pipable in Boost.Iostreams pipelines.
+BOOST_IOSTREAMS_PIPABLE(GzipDecompressor<>, 0);
+} // namespace boost_iostreams_tar_filter
@@ -0,0 +1,125 @@
+/**
+ * @file gzip-index.hxx
+ * @brief Checkpoint index for random access into .tar.gz archives, and
+ * parallel extraction built on it.
+ */
+
+#pragma once
+
+#include <boost-iostreams-tar-filter/entry.hxx>
+#include <boost-iostreams-tar-filter/extraction-sink.hxx>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace boost_iostreams_tar_filter {
+/**
+ * @brief A position in a gzip stream from which inflation can restart.
+ *
+ * Checkpoints sit on deflate block boundaries. Restarting needs the bit
+ * offset inside the compressed byte and the last 32 KiB of output as the
+ * dictionary. A checkpoint with an empty window marks the start of a gzip
+ * member, where inflation restarts with header parsing.
+ */
+struct GzipCheckpoint {
+  std::uint64_t compressed_offset = 0; /**< @brief First whole input byte. */
+  std::uint64_t uncompressed_offset = 0; /**< @brief Output position. */
+  std::uint8_t bits = 0; /**< @brief Bits of the previous byte to replay. */
+  std::vector<unsigned char> window; /**< @brief Inflate dictionary. */
+};
+
+/** @brief Location of one TAR entry in the uncompressed stream. */
+struct IndexedEntry {
+  std::string name;
+  std::uint64_t header_offset = 0; /**< @brief Offset of the 512-byte header,
+                                      or of the pax/GNU records before it. */
+  std::uint64_t size = 0;          /**< @brief Payload size. */
+  char type = Entry::RegularFile;  /**< @brief TAR typeflag. */
+};
+
+/**
+ * @brief Checkpoints plus entry locations of a .tar.gz archive.
+ *
+ * Building the index costs one sequential pass; afterwards any region of the
+ * archive can be inflated independently, starting from the nearest
+ * checkpoint before it.
+ */
+struct GzipIndex {
+  std::vector<GzipCheckpoint> checkpoints;
+  std::vector<IndexedEntry> entries;
+  std::uint64_t uncompressed_size = 0;
+
+  /**
+   * @brief Build the index in one pass over a .tar.gz stream.
+   *
+   * @param in Compressed stream, positioned at its start.
+   * @param spacing Minimum uncompressed distance between checkpoints.
+   * @throws std::ios_base::failure on corrupt input.
+   */
+  static GzipIndex build(std::istream &in, std::uint64_t spacing = 1 << 20);
+
+  /**
+   * @brief Load an index written by write().
+   *
+   * @throws std::ios_base::failure on a malformed index.
+   */
+  static GzipIndex read(std::istream &in);
+
+  /** @brief Serialize the index (binary, host byte order). */
+  void write(std::ostream &out) const;
+
+  /**
+   * @brief Last checkpoint at or before an uncompressed offset.
+   */
+  const GzipCheckpoint &checkpoint_for(std::uint64_t offset) const;
+};
+
+/**
+ * @brief Opens a fresh, seekable stream over the compressed archive; called
+ * once per worker.
+ */
+using StreamOpener = std::function<std::unique_ptr<std::istream>()>;
+
+/**
+ * @brief Parse a .tar.gz in parallel, one inflate + parser pipeline per
+ * range of entries.
+ *
+ * The entries are partitioned into contiguous ranges of similar uncompressed
+ * size. Each range is inflated from the checkpoint preceding it on its own
+ * thread and reported to its own visitor, created by make_visitor(range).
+ * Within a range entries arrive in archive order; ranges run concurrently.
+ *
+ * @param index Index of the archive.
+ * @param open Opens the compressed archive.
+ * @param make_visitor Creates the visitor of a range (called on the calling
+ * thread before any work starts).
+ * @param threads Worker threads (and ranges); 0 selects the hardware
+ * concurrency.
+ * @return Number of ranges used.
+ */
+std::size_t visit_tar_gz_parallel(
+    const GzipIndex &index, const StreamOpener &open,
+    const std::function<std::unique_ptr<EntryVisitor>(std::size_t)>
+        &make_visitor,
+    std::size_t threads = 0);
+
+/**
+ * @brief Extract a .tar.gz below root with visit_tar_gz_parallel(), one
+ * FilesystemSink per range.
+ *
+ * Hard links are created after all ranges finished, so their targets exist
+ * regardless of which range extracted them. A path stored more than once is
+ * extracted from its last entry only, whichever ranges hold the copies.
+ */
+void extract_tar_gz_parallel(const GzipIndex &index, const StreamOpener &open,
+                             const std::filesystem::path &root,
+                             FilesystemSinkOptions options = {},
+                             std::size_t threads = 0);
+} // namespace boost_iostreams_tar_filter
@@ -0,0 +1,49 @@
+/**
+ * @file inflate-engine.hxx
+ * @brief Inflate implementations GzipDecompressor can run on.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace boost_iostreams_tar_filter {
+/**
+ * @brief Library performing DEFLATE decompression for GzipDecompressor.
+ *
+ * Engines other than Zlib are compiled in only when enabled at build time
+ * (BOOST_IOSTREAMS_TAR_FILTER_WITH_* CMake options); the default is chosen
+ * with BOOST_IOSTREAMS_TAR_FILTER_INFLATE_ENGINE. Libdeflate is never the
+ * default and must be passed explicitly.
+ */
+enum class InflateEngine {
+  Zlib,       /**< @brief zlib, or zlib-ng built in zlib-compat mode. */
+  ZlibNg,     /**< @brief zlib-ng through its native zng_ API. */
+  Libdeflate, /**< @brief libdeflate; buffers the whole compressed stream,
+                 at most libdeflate_max_input bytes, and its output. */
+  Isal,       /**< @brief Intel ISA-L igzip. */
+};
+
+/**
+ * @brief Largest compressed stream InflateEngine::Libdeflate accepts; it
+ * throws std::ios_base::failure once more input arrives.
+ */
+constexpr std::size_t libdeflate_max_input = 64 << 20;
+
+/**
+ * @brief Engine selected with BOOST_IOSTREAMS_TAR_FILTER_INFLATE_ENGINE;
+ * never InflateEngine::Libdeflate.
+ */
+InflateEngine default_inflate_engine();
+
+/**
+ * @brief Engines compiled into this build, Zlib first.
+ */
+std::vector<InflateEngine> available_inflate_engines();
+
+/**
+ * @brief Lower-case engine name as used by the CMake option.
+ */
+const char *to_string(InflateEngine engine);
+} // namespace boost_iostreams_tar_filter
@@ -0,0 +1,69 @@
+/**
+ * @file lz4-frame-decompressor.hxx
+ * @brief LZ4 frame decompressor filter decoding independent blocks on a
+ * worker pool.
+ */
+
+#pragma once
+
+#include <boost-iostreams-tar-filter/detail/lz4-frame-decompressor-impl.hxx>
+#include <boost/iostreams/filter/symmetric.hpp>
+
+namespace boost_iostreams_tar_filter {
+/**
+ * @brief Boost.Iostreams filter decompressing the LZ4 frame format
+ * (`lz4` command line, LZ4F_compressFrame()).
+ *
+ * Frames written with independent blocks (`lz4 -BI`, or
+ * LZ4F_blockIndependent) are decoded in parallel; linked-block frames, the
+ * `lz4` default, decode sequentially. Block and content checksums are
+ * verified when present.
+ *
+ * @tparam Alloc Allocator type for internal buffers (default:
+ * std::allocator<char>)
+ *
+ * @code{.cpp}
+ * io::filtering_istream in;
+ * in.push(TarFilter<>());
+ * in.push(Lz4FrameDecompressor<>());
+ * in.push(io::file_source("a.tar.lz4", std::ios::binary));
+ * @endcode
+ *
+ * @note Only available when built with BOOST_IOSTREAMS_TAR_FILTER_WITH_LZ4,
+ * which defines BOOST_IOSTREAMS_TAR_FILTER_HAVE_LZ4. Legacy frames and
+ * frames requiring an external dictionary are rejected with
+ * std::ios_base::failure.
+ */
+template <typename Alloc = std::allocator<char>>
+struct Lz4FrameDecompressor
+    : boost::iostreams::symmetric_filter<
+          detail::Lz4FrameDecompressorImpl<Alloc>, Alloc> {
+private:
+  using impl_type = detail::Lz4FrameDecompressorImpl<Alloc>;
+  using base_type = boost::iostreams::symmetric_filter<impl_type, Alloc>;
+
+public:
+  /// Character type used by the stream.
+  using char_type = typename base_type::char_type;
+  /// Filter category for Boost.Iostreams.
+  using category = typename base_type::category;
+
+  /**
+   * @brief Constructs the decompressor.
+   *
+   * @param threads Worker threads; 0 selects the hardware concurrency.
+   * @param max_in_flight Maximum number of blocks decoded ahead of the
+   * output; 0 selects twice the thread count.
+   * @param buffer_size Buffer size used internally (defaults to
+   * Boost.Iostreams' default size).
+   */
+  explicit Lz4FrameDecompressor(
+      std::size_t threads = 0, std::size_t max_in_flight = 0,
+      std::streamsize buffer_size =
+          boost::iostreams::default_device_buffer_size)
+      : base_type(buffer_size, threads, max_in_flight) {}
+};
+
+/// @brief Makes Lz4FrameDecompressor pipable in Boost.Iostreams pipelines.
+BOOST_IOSTREAMS_PIPABLE(Lz4FrameDecompressor<>, 0);
+} // namespace boost_iostreams_tar_filter
@@ -0,0 +1,101 @@
+/**
+ * @file multi-part-source.hxx
+ * @brief Seekable Boost.Iostreams source presenting the parts of a split
+ * archive as one stream.
+ */
+
+#pragma once
+
+#include <boost/iostreams/categories.hpp>
+#include <boost/iostreams/positioning.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <ios>
+#include <memory>
+#include <vector>
+
+namespace boost_iostreams_tar_filter {
+namespace detail {
+class MultiPartFile;
+}
+
+/**
+ * @brief Find the parts written by `split` for a prefix, in order.
+ *
+ * Parts are the files in the prefix's directory whose name is the prefix's
+ * file name followed by a non-empty alphanumeric suffix (`.tar.gz.aa`,
+ * `.tar.gz.ab`, ... or the numeric suffixes of `split -d`). `split` pads
+ * suffixes to a common width, so name order is part order.
+ *
+ * @param prefix Path up to the suffix, such as "backup.tar.gz.".
+ * @throws std::invalid_argument when no part exists.
+ */
+std::vector<std::filesystem::path>
+find_split_parts(const std::filesystem::path &prefix);
+
+/**
+ * @brief Source device reading an ordered list of part files as one
+ * contiguous stream, without concatenating them first.
+ *
+ * Part sizes are taken when the device is constructed and map stream
+ * positions to (part, offset) pairs. Reads go straight from the part files
+ * into the caller's buffer with pread() and continue into the next part
+ * within a single call. Only the part being read is kept open.
+ *
+ * The device is seekable, so visit_tar() over an io::stream of it seeks over
+ * declined payloads, and GzipIndex::build()/visit_tar_gz_parallel() work on
+ * split .tar.gz files:
+ *
+ * @code{.cpp}
+ * auto const parts = find_split_parts("backup.tar.gz.");
+ * io::filtering_istream in;
+ * in.push(GzipDecompressor<>());
+ * in.push(MultiPartSource(parts));
+ *
+ * visit_tar_gz_parallel(index, [&] {
+ *   return std::make_unique<io::stream<MultiPartSource>>(parts);
+ * }, make_visitor);
+ * @endcode
+ *
+ * Copies of the device share the same position.
+ */
+class MultiPartSource {
+public:
+  /// Character type used by the stream.
+  using char_type = char;
+  /// Seekable input device.
+  struct category : boost::iostreams::input_seekable,
+                    boost::iostreams::device_tag {};
+
+  /**
+   * @param parts Part files, in stream order.
+   * @throws std::system_error when a part's size cannot be read.
+   */
+  explicit MultiPartSource(std::vector<std::filesystem::path> parts);
+
+  /**
+   * @return Bytes read, or -1 at the end of the last part.
+   * @throws std::system_error when a part cannot be opened or read.
+   * @throws std::ios_base::failure when a part shrank since construction.
+   */
+  std::streamsize read(char *s, std::streamsize n);
+
+  /**
+   * @brief Move to a position in the joined stream; positions past the end
+   * are clamped to the end.
+   */
+  std::streampos seek(boost::iostreams::stream_offset off,
+                      std::ios_base::seekdir way);
+
+  /** @brief Offset of each part in the joined stream, plus its total size. */
+  const std::vector<std::uint64_t> &part_offsets() const;
+
+  /** @brief Size of the joined stream. */
+  std::uint64_t size() const;
+
+private:
+  std::shared_ptr<detail::MultiPartFile> file_;
+};
+} // namespace boost_iostreams_tar_filter
@@ -0,0 +1,86 @@
+/**
+ * @file parallel-member-decompressor.hxx
+ * @brief Entry stage that inflates individually compressed archive members
+ * on a worker pool while preserving archive order.
+ */
+
+#pragma once
+
+#include <boost-iostreams-tar-filter/detail/worker-pool.hxx>
+#include <boost-iostreams-tar-filter/entry.hxx>
+
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <string>
+
+namespace boost_iostreams_tar_filter {
+/**
+ * @brief EntryVisitor that decompresses compressed members (`*.gz`, `*.bz2`,
+ * `*.xz`, `*.zst`) in parallel and forwards the results, in archive order, to
+ * a downstream visitor.
+ *
+ * Each compressed member is buffered and handed to a worker pool. Finished
+ * entries wait in a reorder buffer until every entry before them has been
+ * forwarded, so the downstream visitor observes the same order as the
+ * archive. Forwarded entries carry the name without the compression suffix
+ * and the decompressed size, and their payload arrives in a single
+ * on_entry_data() call followed by on_buffer_end(), so batching visitors
+ * such as ExtractionVisitor flush it before it is released.
+ *
+ * Entries that are not compressed pass straight through (without buffering)
+ * whenever the reorder buffer is empty; otherwise they are queued behind the
+ * pending members to keep the order intact.
+ *
+ * @code{.cpp}
+ * ParallelMemberDecompressor stage(downstream);
+ * visit_tar(in, stage);
+ * stage.finish();
+ * @endcode
+ */
+class ParallelMemberDecompressor : public EntryVisitor {
+public:
+  /**
+   * @brief Construct the stage.
+   *
+   * @param downstream Visitor receiving the ordered, decompressed entries.
+   * @param threads Worker threads; 0 selects the hardware concurrency.
+   * @param max_in_flight Maximum number of buffered entries before the
+   * reading thread blocks on the oldest one; 0 selects twice the thread count.
+   */
+  explicit ParallelMemberDecompressor(EntryVisitor &downstream,
+                                      std::size_t threads = 0,
+                                      std::size_t max_in_flight = 0);
+
+  bool on_entry_begin(const Entry &entry) override;
+  void on_entry_data(const char *begin, const char *end) override;
+  void on_entry_end(const Entry &entry) override;
+  void on_buffer_end() override;
+
+  /**
+   * @brief Wait for all pending members and forward them downstream.
+   *
+   * Must be called once the archive has been fully visited. Rethrows the
+   * first decompression error, if any.
+   */
+  void finish();
+
+private:
+  /** @brief A fully materialized entry waiting in the reorder buffer. */
+  struct Decoded {
+    Entry entry;
+    std::string data;
+  };
+
+  void emit(Decoded decoded);
+  void emit_front();
+
+  EntryVisitor &downstream_;
+  detail::WorkerPool pool_;
+  std::size_t max_in_flight_;
+  std::deque<std::future<Decoded>> pending_;
+  Entry entry_;
+  std::string buffer_;
+  bool pass_through_ = false;
+};
+} // namespace boost_iostreams_tar_filter
@@ -0,0 +1,124 @@
+/**
+ * @file parallel-xz-source.hxx
+ * @brief Seekable Boost.Iostreams source decoding indexed .xz files block by
+ * block on a worker pool.
+ */
+
+#pragma once
+
+#include <boost/iostreams/categories.hpp>
+#include <boost/iostreams/positioning.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <ios>
+#include <istream>
+#include <memory>
+#include <vector>
+
+namespace boost_iostreams_tar_filter {
+/**
+ * @brief One block of an .xz file, as listed in its index.
+ */
+struct XzBlock {
+  std::uint64_t compressed_offset = 0; /**< @brief File offset of the block
+                                          header. */
+  std::uint64_t compressed_size = 0;   /**< @brief Block size in the file,
+                                          including header and padding. */
+  std::uint64_t unpadded_size = 0;     /**< @brief Block size without
+                                          padding, as stored in the index. */
+  std::uint64_t uncompressed_offset = 0; /**< @brief Offset of the block's
+                                            data in the decoded stream. */
+  std::uint64_t uncompressed_size = 0;   /**< @brief Decoded size. */
+  std::uint32_t check = 0; /**< @brief lzma_check of the enclosing stream. */
+};
+
+namespace detail {
+class XzBlockReader;
+}
+
+/**
+ * @brief Source device reading an .xz file through its index.
+ *
+ * The index at the end of each stream lists every block with its offsets and
+ * sizes, so blocks (as written by `xz -T`) are decoded independently on a
+ * worker pool, up to max_in_flight blocks ahead of the reader. Seeking jumps
+ * to the block containing the target; only that block is decoded to reach
+ * it. Concatenated streams and stream padding are supported.
+ *
+ * The device is seekable, so visit_tar() over an io::stream of it seeks over
+ * declined payloads and skips decoding the blocks they span.
+ *
+ * @code{.cpp}
+ * io::filtering_istream in;
+ * in.push(TarFilter<>());
+ * in.push(ParallelXzSource("a.tar.xz"));
+ *
+ * io::stream<ParallelXzSource> indexed("a.tar.xz");
+ * indexed.seekg(offset);
+ * @endcode
+ *
+ * Blocks larger than max_block_size, compressed or decoded, are not
+ * decoded as one job: like the block of a single-block file (plain `xz`
+ * without -T), they are decoded on the reading thread in 64 KiB pieces, so
+ * the sizes listed in the index never size an allocation beyond that limit.
+ * Memory then stays below about 2 * max_in_flight * max_block_size.
+ * Copies of the device share the same reader.
+ */
+class ParallelXzSource {
+public:
+  /// Character type used by the stream.
+  using char_type = char;
+  /// Seekable input device.
+  struct category : boost::iostreams::input_seekable,
+                    boost::iostreams::device_tag {};
+
+  /** @brief Default limit for blocks decoded as one job. */
+  static constexpr std::uint64_t default_max_block_size = 64 << 20;
+
+  /**
+   * @param path .xz file to read.
+   * @param threads Worker threads; 0 selects the hardware concurrency.
+   * @param max_in_flight Maximum number of blocks decoded ahead of the
+   * reader; 0 selects twice the thread count.
+   * @param max_block_size Largest block decoded as one job on the pool.
+   * @throws std::system_error when the file cannot be opened.
+   * @throws std::ios_base::failure when the index cannot be read.
+   */
+  explicit ParallelXzSource(
+      const std::filesystem::path &path, std::size_t threads = 0,
+      std::size_t max_in_flight = 0,
+      std::uint64_t max_block_size = default_max_block_size);
+
+  /**
+   * @param in Seekable stream holding the .xz file.
+   */
+  explicit ParallelXzSource(
+      std::unique_ptr<std::istream> in, std::size_t threads = 0,
+      std::size_t max_in_flight = 0,
+      std::uint64_t max_block_size = default_max_block_size);
+
+  /**
+   * @return Bytes read, or -1 at the end of the decoded stream.
+   * @throws std::ios_base::failure on corrupt blocks.
+   */
+  std::streamsize read(char *s, std::streamsize n);
+
+  /**
+   * @brief Move to a position in the decoded stream; positions past the end
+   * are clamped to the end.
+   */
+  std::streampos seek(boost::iostreams::stream_offset off,
+                      std::ios_base::seekdir way);
+
+  /** @brief Blocks of all streams, in file order. */
+  const std::vector<XzBlock> &blocks() const;
+
+  /** @brief Size of the decoded stream. */
+  std::uint64_t size() const;
+
+private:
+  std::shared_ptr<detail::XzBlockReader> reader_;
+};
+} // namespace boost_iostreams_tar_filter
@@ -0,0 +1,77 @@
+/**
+ * @file pipe-source.hxx
+ * @brief Boost.Iostreams source reading a pipe (or stdin) in large batches.
+ */
+
+#pragma once
+
+#include <boost/iostreams/categories.hpp>
+
+#include <cstddef>
+#include <ios>
+#include <unistd.h>
+
+namespace boost_iostreams_tar_filter {
+/**
+ * @brief Source device for archives fed through a pipe, such as
+ * `curl ... | tool`.
+ *
+ * A default pipe holds 64 KiB and a std::istream reads it a few KiB at a
+ * time, so the reader wakes up for every small write of the producer. This
+ * device raises the pipe's capacity with F_SETPIPE_SZ (up to the system's
+ * /proc/sys/fs/pipe-max-size when the request is larger), reports it as its
+ * optimal buffer size so Boost.Iostreams sizes its stream buffer to match,
+ * and fills each read completely unless the writer closed the pipe. The
+ * parser above then sees few large buffers instead of many small ones.
+ *
+ * Regular files and other descriptors are read the same way, without
+ * touching the pipe size.
+ *
+ * @code{.cpp}
+ * io::filtering_istream in;
+ * in.push(GzipDecompressor<>());
+ * in.push(PipeSource());
+ * visit_tar(in, visitor);
+ * @endcode
+ *
+ * The descriptor is not closed by the device.
+ */
+class PipeSource {
+public:
+  /// Character type used by the stream.
+  using char_type = char;
+  /// Input device with a preferred buffer size.
+  struct category : boost::iostreams::source_tag,
+                    boost::iostreams::optimally_buffered_tag {};
+
+  /// Requested pipe capacity when none is given.
+  static constexpr std::size_t default_pipe_size = 1 << 20;
+
+  /**
+   * @param fd Descriptor to read, standard input by default.
+   * @param pipe_size Requested pipe capacity; 0 leaves the pipe unchanged.
+   * @throws std::system_error when fd cannot be inspected.
+   */
+  explicit PipeSource(int fd = STDIN_FILENO,
+                      std::size_t pipe_size = default_pipe_size);
+
+  /**
+   * @brief Read until n bytes arrived or the writer closed the pipe.
+   *
+   * @return Bytes read, or -1 at the end of the input.
+   * @throws std::system_error on read errors.
+   */
+  std::streamsize read(char *s, std::streamsize n);
+
+  /** @brief Capacity of the pipe, or the read size for other descriptors. */
+  std::streamsize optimal_buffer_size() const;
+
+  /** @brief Whether the descriptor is a pipe or FIFO. */
+  bool is_pipe() const { return is_pipe_; }
+
+private:
+  int fd_;
+  bool is_pipe_ = false;
+  std::size_t buffer_size_ = 0;
+};
+} // namespace boost_iostreams_tar_filter
@@ -0,0 +1,106 @@
+/**
+ * @file record-splitter.hxx
+ * @brief Entry stage that splits payloads into delimiter-terminated records
+ * and parses batches of records on a worker pool.
+ */
+
+#pragma once
+
+#include <boost-iostreams-tar-filter/detail/worker-pool.hxx>
+#include <boost-iostreams-tar-filter/entry.hxx>
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace boost_iostreams_tar_filter {
+/**
+ * @brief A batch of records taken from a single entry.
+ *
+ * Records are stored back to back in data, each followed by its delimiter
+ * (except possibly the last record of an entry). Batches never span entries,
+ * so records from different files cannot merge.
+ */
+struct RecordBatch {
+  std::string entry_name; /**< @brief Entry the records belong to. */
+  std::size_t sequence = 0; /**< @brief Index of this batch in its entry. */
+  std::size_t first_record =
+      0;            /**< @brief Index of the first record in its entry. */
+  std::string data; /**< @brief Raw record bytes, delimiters included. */
+  std::vector<std::size_t>
+      ends; /**< @brief Offset one past each record, delimiter excluded. */
+
+  /** @brief Number of records in the batch. */
+  std::size_t size() const { return ends.size(); }
+
+  /** @brief View of the i-th record without its delimiter. */
+  std::string_view operator[](std::size_t i) const {
+    auto const begin = i == 0 ? 0 : ends[i - 1] + 1;
+    return std::string_view(data).substr(begin, ends[i] - begin);
+  }
+};
+
+/**
+ * @brief EntryVisitor that cuts regular file payloads into records and hands
+ * batches of records to a parser running on a worker pool.
+ *
+ * Delimiters are located with memchr(), which the C library vectorizes.
+ * Records straddling two input buffers are carried over into the next batch.
+ * A final record without a trailing delimiter is emitted when its entry
+ * ends.
+ *
+ * Batches are parsed concurrently and may complete in any order;
+ * RecordBatch::entry_name and RecordBatch::sequence identify their origin.
+ *
+ * @code{.cpp}
+ * RecordSplitter splitter([](const RecordBatch &batch) {
+ *   for (std::size_t i = 0; i < batch.size(); ++i)
+ *     parse_json(batch[i]);
+ * });
+ * visit_tar(in, splitter);
+ * splitter.finish();
+ * @endcode
+ */
+class RecordSplitter : public EntryVisitor {
+public:
+  /** @brief Callable invoked on a worker thread for every batch. */
+  using Parser = std::function<void(const RecordBatch &)>;
+
+  /**
+   * @brief Construct the splitter.
+   *
+   * @param parser Callable invoked concurrently for each batch.
+   * @param threads Worker threads; 0 selects the hardware concurrency.
+   * @param batch_records Number of records per batch.
+   * @param delimiter Record delimiter.
+   */
+  explicit RecordSplitter(Parser parser, std::size_t threads = 0,
+                          std::size_t batch_records = 4096,
+                          char delimiter = '\n');
+
+  bool on_entry_begin(const Entry &entry) override;
+  void on_entry_data(const char *begin, const char *end) override;
+  void on_entry_end(const Entry &entry) override;
+
+  /**
+   * @brief Wait until every dispatched batch has been parsed.
+   *
+   * Rethrows the first exception thrown by the parser, if any.
+   */
+  void finish();
+
+private:
+  void dispatch();
+
+  Parser parser_;
+  detail::WorkerPool pool_;
+  std::size_t batch_records_;
+  char delimiter_;
+  std::deque<std::future<void>> pending_;
+  RecordBatch batch_;
+};
+} // namespace boost_iostreams_tar_filter
@@ -0,0 +1,71 @@
+/**
+ * @file sha256.hxx
+ * @brief Incremental SHA-256 used to digest entry payloads in-stream.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace boost_iostreams_tar_filter {
+/** @brief A SHA-256 digest. */
+using Digest = std::array<std::uint8_t, 32>;
+
+/**
+ * @brief Incremental SHA-256 (FIPS 180-4).
+ *
+ * Feed payload slices with update() as they arrive and call finish() once;
+ * the object is reset afterwards and can be reused.
+ */
+class Sha256 {
+public:
+  Sha256() { reset(); }
+
+  /** @brief Discard any input and start a new digest. */
+  void reset();
+
+  /** @brief Absorb size bytes. */
+  void update(const void *data, std::size_t size);
+
+  /** @brief Finalize, return the digest and reset. */
+  Digest finish();
+
+  /** @brief Digest of a single buffer. */
+  static Digest digest(const void *data, std::size_t size);
+
+private:
+  void compress(const std::uint8_t *block);
+
+  std::array<std::uint32_t, 8> state_;
+  std::array<std::uint8_t, 64> block_;
+  std::size_t block_size_ = 0;
+  std::uint64_t length_ = 0;
+};
+
+/**
+ * @brief Lowercase hexadecimal representation of a digest.
+ */
+std::string to_hex(const Digest &digest);
+
+/**
+ * @brief Parse a 64-character hexadecimal digest.
+ *
+ * @return false when the text is not a valid digest.
+ */
+bool from_hex(const std::string &text, Digest &digest);
+
+/**
+ * @brief Hasher for unordered containers keyed by Digest.
+ */
+struct DigestHash {
+  std::size_t operator()(const Digest &digest) const {
+    std::size_t value = 0;
+    for (std::size_t i = 0; i < sizeof(value); ++i)
+      value = (value << 8) | digest[i];
+    return value;
+  }
+};
+} // namespace boost_iostreams_tar_filter
@@ -0,0 +1,53 @@
+/**
+ * @file tar-follower.hxx
+ * @brief Follows a TAR archive that is still being written, like `tail -f`.
+ */
+
+#pragma once
+
+#include <boost-iostreams-tar-filter/entry.hxx>
+#include <boost/iostreams/constants.hpp>
+
+#include <cstddef>
+#include <filesystem>
+#include <stop_token>
+
+namespace boost_iostreams_tar_filter {
+/**
+ * @brief Parse an uncompressed TAR archive that another process keeps
+ * appending to, reporting entries as their bytes arrive.
+ *
+ * The file is read to its current end and parsed with the same state machine
+ * as visit_tar(); a missing end-of-archive marker means more is to come.
+ * At the end of the file the reader sleeps on an inotify watch of the file,
+ * not a polling timer, and resumes from the same offset when the writer
+ * appends, so nothing is read twice. EntryVisitor::on_buffer_end() is called
+ * after each read, including the partial one before waiting, so batching
+ * visitors see new entries without delay.
+ *
+ * Declined payloads are skipped by offset, up to the current file size.
+ *
+ * @code{.cpp}
+ * std::jthread follower([&](std::stop_token stop) {
+ *   follow_tar("events.tar", visitor, stop);
+ * });
+ * // ...
+ * follower.request_stop();
+ * @endcode
+ *
+ * @param path Archive to follow.
+ * @param visitor Receiver of entries and payload slices.
+ * @param stop Requesting a stop wakes the reader and makes it return.
+ * @param buffer_size Size of the read buffer.
+ * @return true when the end-of-archive marker was reached.
+ * @return false when a stop was requested, or the file was deleted or
+ * renamed and its remaining bytes were parsed.
+ * @throws std::system_error when the file cannot be opened, read or watched.
+ * @throws std::ios_base::failure when the file shrinks below the bytes
+ * already parsed.
+ */
+bool follow_tar(const std::filesystem::path &path, EntryVisitor &visitor,
+                std::stop_token stop = {},
+                std::size_t buffer_size =
+                    boost::iostreams::default_device_buffer_size);
+} // namespace boost_iostreams_tar_filter
@@ -0,0 +1,113 @@
+/**
+ * @file tar-reader.hxx
+ * @brief Drives the TAR state machine over an input stream and reports
+ * entries to an EntryVisitor.
+ */
+
+#pragma once
+
+#include <boost-iostreams-tar-filter/entry.hxx>
+#include <boost/iostreams/constants.hpp>
+
+#include <cstddef>
+#include <filesystem>
+#include <functional>
+#include <istream>
+#include <memory>
+#include <vector>
+
+namespace boost_iostreams_tar_filter {
+/**
+ * @brief Parse a TAR archive from a stream and report every entry to a
+ * visitor.
+ *
+ * The stream can be any std::istream, including a
+ * boost::iostreams::filtering_istream with a decompressor pushed in front of
+ * the source. Unlike TarFilter, entry boundaries and metadata are preserved,
+ * and payload is handed over as borrowed slices of the read buffer. Payloads
+ * the visitor declines are seeked over when the stream supports it.
+ *
+ * @code{.cpp}
+ * io::filtering_istream in;
+ * in.push(io::gzip_decompressor());
+ * in.push(io::file_source("a.tar.gz", std::ios::binary));
+ * visit_tar(in, visitor);
+ * @endcode
+ *
+ * @param in Stream positioned at the first TAR header.
+ * @param visitor Receiver of entries and payload slices.
+ * @param buffer_size Size of the read buffer.
+ * @return true when the end-of-archive marker was reached.
+ * @return false when the stream ended before the marker.
+ */
+bool visit_tar(std::istream &in, EntryVisitor &visitor,
+               std::size_t buffer_size =
+                   boost::iostreams::default_device_buffer_size);
+
+/**
+ * @brief Parse a gzip-compressed TAR archive, inflating straight into the
+ * parser's buffer.
+ *
+ * Equivalent to visit_tar() over a filtering_istream with a
+ * gzip_decompressor, but zlib writes each inflated span into the buffer that
+ * BaseTarFilterImpl::visit() reads from, skipping the copies through the
+ * decompressor and the stream buffers. Concatenated gzip members are read as
+ * one stream. Payloads the visitor declines are inflated into a small
+ * scratch window and skipped without being parsed.
+ *
+ * @param in Stream positioned at the first gzip member.
+ * @param visitor Receiver of entries and payload slices.
+ * @param buffer_size Size of the inflate output buffer.
+ * @param verify_crc Whether to compute and check member CRC-32s; turning it
+ * off speeds up listing.
+ * @return true when the end-of-archive marker was reached.
+ * @return false when the stream ended before the marker.
+ * @throws std::ios_base::failure on corrupt gzip data.
+ */
+bool visit_tar_gz(std::istream &in, EntryVisitor &visitor,
+                  std::size_t buffer_size =
+                      boost::iostreams::default_device_buffer_size,
+                  bool verify_crc = true);
+
+/**
+ * @brief Opens volume number n (counting from 0) of a multi-volume archive,
+ * or returns nullptr when there is no such volume.
+ */
+using VolumeOpener =
+    std::function<std::unique_ptr<std::istream>(std::size_t)>;
+
+/**
+ * @brief Parse a GNU multi-volume TAR archive (`tar -M`) in one pass over
+ * its volumes.
+ *
+ * Volumes are read in order with visit_tar()'s loop. Files split across
+ * volumes are reported as one entry: their payload continues from the 'M'
+ * continuation header of the next volume, without on_entry_begin() being
+ * called again. Volume labels of continuation volumes are skipped.
+ *
+ * @code{.cpp}
+ * visit_tar_volumes({"backup.tar", "backup-2.tar", "backup-3.tar"}, visitor);
+ * @endcode
+ *
+ * @param open_volume Opens each volume, positioned at its first header.
+ * @param visitor Receiver of entries and payload slices.
+ * @param buffer_size Size of the read buffer.
+ * @return true when the end-of-archive marker was reached.
+ * @return false when the volumes ran out before the marker.
+ * @throws std::ios_base::failure when a volume does not continue the entry
+ * the previous one ended in.
+ */
+bool visit_tar_volumes(const VolumeOpener &open_volume, EntryVisitor &visitor,
+                       std::size_t buffer_size =
+                           boost::iostreams::default_device_buffer_size);
+
+/**
+ * @brief visit_tar_volumes() over volume files, in order.
+ *
+ * @throws std::system_error when a volume cannot be opened.
+ */
+bool visit_tar_volumes(const std::vector<std::filesystem::path> &volumes,
+                       EntryVisitor &visitor,
+                       std::size_t buffer_size =
+                           boost::iostreams::default_device_buffer_size);
+} // namespace boost_iostreams_tar_filter
@@ -0,0 +1,62 @@
+/**
+ * @file tar-splice.hxx
+ * @brief Moves payloads of an uncompressed TAR file to another descriptor
+ * inside the kernel, without copying them through user space.
+ */
+
+#pragma once
+
+#include <boost-iostreams-tar-filter/entry.hxx>
+
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+
+namespace boost_iostreams_tar_filter {
+/**
+ * @brief Send the payloads of selected entries of an uncompressed TAR file
+ * to out_fd with splice(2).
+ *
+ * Only headers are read: each one is parsed by the TAR state machine, and the
+ * payload range following it is either spliced from the archive's page
+ * cache into out_fd (a pipe to a consumer process) or skipped by offset.
+ * Payload bytes never enter this process. When out_fd is not a pipe,
+ * sendfile(2) is used instead, which is equally copy-free.
+ *
+ * select() is called for every entry before its payload is sent and may
+ * write its own framing (a name or length prefix) to out_fd. Only regular
+ * files have payload to send.
+ *
+ * @code{.cpp}
+ * splice_tar_entries("models.tar", consumer_pipe,
+ *                    [](const Entry &e) { return e.name.ends_with(".bin"); });
+ * @endcode
+ *
+ * @param archive Uncompressed TAR file.
+ * @param out_fd Destination descriptor, written from its current position.
+ * @param select Whether to send an entry's payload.
+ * @return true when the end-of-archive marker was reached.
+ * @return false when the file ended before the marker.
+ * @throws std::system_error when the archive cannot be opened or a transfer
+ * fails (EPIPE when the consumer went away).
+ * @throws std::ios_base::failure when the archive is shorter than an entry's
+ * payload.
+ */
+bool splice_tar_entries(const std::filesystem::path &archive, int out_fd,
+                        const std::function<bool(const Entry &)> &select);
+
+/**
+ * @brief Send the payload of the entry named name to out_fd, see
+ * splice_tar_entries().
+ *
+ * Like extraction, the last entry of the path decides: every header is read
+ * first, and only the last copy's payload is sent (nothing when it is not a
+ * regular file).
+ *
+ * @return The last entry named name, or std::nullopt when the archive has no
+ * such entry.
+ */
+std::optional<Entry> splice_tar_entry(const std::filesystem::path &archive,
+                                      const std::string &name, int out_fd);
+} // namespace boost_iostreams_tar_filter
@@ -0,0 +1,87 @@
+/**
+ * @file verifier.hxx
+ * @brief Post-extraction verification of files against a manifest of sizes
+ * and SHA-256 digests.
+ */
+
+#pragma once
+
+#include <boost-iostreams-tar-filter/sha256.hxx>
+
+#include <cstddef>
+#include <filesystem>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace boost_iostreams_tar_filter {
+/** @brief Expected state of one extracted regular file. */
+struct ManifestEntry {
+  std::string path; /**< @brief Path relative to the extraction root. */
+  std::size_t size = 0; /**< @brief Expected size in bytes. */
+  Digest digest{};      /**< @brief Expected SHA-256 of the contents. */
+};
+
+/** @brief A list of expected files. */
+using Manifest = std::vector<ManifestEntry>;
+
+/**
+ * @brief Read a manifest with one `<sha256-hex> <size> <path>` line per
+ * file, as written by write_manifest().
+ *
+ * @throws std::ios_base::failure on malformed lines.
+ */
+Manifest read_manifest(std::istream &in);
+
+/**
+ * @brief Write a manifest in the format accepted by read_manifest().
+ */
+void write_manifest(std::ostream &out, const Manifest &manifest);
+
+/**
+ * @brief Build the manifest of every regular file in a TAR stream from the
+ * header sizes and digests computed while the payload streams by.
+ *
+ * A path stored more than once is listed once, with its last copy, as
+ * extraction leaves it.
+ */
+Manifest manifest_from_tar(std::istream &in);
+
+/** @brief One file that failed verification. */
+struct Mismatch {
+  enum class Kind { Missing, Size, Digest };
+  std::string path;
+  Kind kind;
+};
+
+/** @brief Outcome of verify_extraction(). */
+struct VerificationReport {
+  std::vector<Mismatch> mismatches; /**< @brief Failures in manifest order. */
+  std::size_t verified = 0;         /**< @brief Files checked. */
+  std::size_t rehashed = 0; /**< @brief Files that had to be read back. */
+
+  /** @brief Process exit status: 0 when everything matched, 1 otherwise. */
+  int exit_status() const { return mismatches.empty() ? 0 : 1; }
+};
+
+/**
+ * @brief Check extracted files against a manifest.
+ *
+ * Every file is stat'ed for its size. When digests holds a digest computed
+ * in-stream during extraction (see FilesystemSinkOptions::record_digests)
+ * it is compared directly; otherwise the file is read back and hashed.
+ * Files are processed in parallel on a worker pool.
+ *
+ * @param root Extraction root.
+ * @param manifest Expected files.
+ * @param digests In-stream digests by relative path, or nullptr.
+ * @param threads Worker threads; 0 selects the hardware concurrency.
+ */
+VerificationReport
+verify_extraction(const std::filesystem::path &root, const Manifest &manifest,
+                  const std::unordered_map<std::string, Digest> *digests =
+                      nullptr,
+                  std::size_t threads = 0);
+} // namespace boost_iostreams_tar_filter
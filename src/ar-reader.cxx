@@ -0,0 +1,177 @@
+#include <boost-iostreams-tar-filter/ar-reader.hxx>
+#include <boost-iostreams-tar-filter/compression.hxx>
+#include <boost-iostreams-tar-filter/tar-reader.hxx>
+
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/stream.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <ios>
+
+namespace boost_iostreams_tar_filter {
+namespace {
+constexpr char signature[] = "!<arch>\n";
+constexpr std::size_t header_size = 60;
+
+/**
+ * @brief Parse a space-padded decimal or octal header field.
+ */
+std::uint64_t parse_field_impl(const char *field, std::size_t size, int base) {
+  auto begin = field;
+  auto end = field + size;
+  while (end > begin && end[-1] == ' ')
+    --end;
+  std::uint64_t value = 0;
+  if (begin == end)
+    return value;
+  auto const [ptr, ec] = std::from_chars(begin, end, value, base);
+  if (ec != std::errc() || ptr != end)
+    throw std::ios_base::failure("malformed ar header field");
+  return value;
+}
+
+std::string trim_name_impl(const char *field, std::size_t size) {
+  std::string name(field, size);
+  name.erase(name.find_last_not_of(' ') + 1);
+  return name;
+}
+
+void skip_impl(std::istream &in, std::uint64_t count) {
+  if (count == 0)
+    return;
+  try {
+    if (in.rdbuf() &&
+        in.rdbuf()->pubseekoff(static_cast<std::streamoff>(count),
+                               std::ios_base::cur,
+                               std::ios_base::in) != std::streampos(-1))
+      return;
+  } catch (const std::exception &) {
+  }
+  while (count > 0) {
+    auto const chunk = std::min<std::uint64_t>(count, 1 << 20);
+    if (!in.ignore(static_cast<std::streamsize>(chunk)))
+      throw std::ios_base::failure("truncated ar archive");
+    count -= chunk;
+  }
+}
+
+void read_exact_impl(std::istream &in, char *data, std::size_t size) {
+  if (!in.read(data, static_cast<std::streamsize>(size)))
+    throw std::ios_base::failure("truncated ar archive");
+}
+} // unnamed namespace
+
+ArMemberSource::ArMemberSource(std::shared_ptr<State> state)
+    : state_(std::move(state)) {}
+
+std::streamsize ArMemberSource::read(char *s, std::streamsize n) {
+  if (state_->remaining == 0)
+    return -1;
+  auto const count = static_cast<std::streamsize>(
+      std::min<std::uint64_t>(state_->remaining, static_cast<std::uint64_t>(n)));
+  state_->in->read(s, count);
+  auto const got = state_->in->gcount();
+  state_->remaining -= static_cast<std::uint64_t>(got);
+  if (got == 0)
+    throw std::ios_base::failure("truncated ar member");
+  return got;
+}
+
+ArReader::ArReader(std::istream &in)
+    : in_(in), state_(std::make_shared<ArMemberSource::State>()) {
+  state_->in = &in_;
+  char magic[sizeof(signature) - 1];
+  if (!in_.read(magic, sizeof(magic)) ||
+      std::memcmp(magic, signature, sizeof(magic)) != 0)
+    throw std::ios_base::failure("not an ar archive");
+}
+
+void ArReader::skip_rest() {
+  skip_impl(in_, state_->remaining + (padded_ ? 1 : 0));
+  state_->remaining = 0;
+  padded_ = false;
+}
+
+bool ArReader::next(ArMember &member) {
+  for (;;) {
+    skip_rest();
+
+    char header[header_size];
+    in_.read(header, sizeof(header));
+    if (in_.gcount() == 0)
+      return false;
+    if (in_.gcount() != static_cast<std::streamsize>(sizeof(header)) ||
+        header[58] != '`' || header[59] != '\n')
+      throw std::ios_base::failure("malformed ar header");
+
+    member.name = trim_name_impl(header, 16);
+    member.mtime = static_cast<std::int64_t>(parse_field_impl(header + 16, 12, 10));
+    member.uid = static_cast<std::uint32_t>(parse_field_impl(header + 28, 6, 10));
+    member.gid = static_cast<std::uint32_t>(parse_field_impl(header + 34, 6, 10));
+    member.mode = static_cast<std::uint32_t>(parse_field_impl(header + 40, 8, 8));
+    member.size = parse_field_impl(header + 48, 10, 10);
+    state_->remaining = member.size;
+    padded_ = member.size % 2 != 0;
+
+    if (member.name == "/" || member.name == "/SYM64/")
+      continue; // GNU symbol table
+    if (member.name == "//") {
+      // GNU long-name table: "name/\n" records referenced as "/offset".
+      long_names_.resize(static_cast<std::size_t>(member.size));
+      read_exact_impl(in_, long_names_.data(), long_names_.size());
+      state_->remaining = 0;
+      continue;
+    }
+
+    if (member.name.rfind("#1/", 0) == 0) {
+      // BSD long name stored at the start of the data.
+      auto const length = static_cast<std::size_t>(
+          parse_field_impl(member.name.data() + 3, member.name.size() - 3, 10));
+      if (length > member.size)
+        throw std::ios_base::failure("malformed ar long name");
+      member.name.resize(length);
+      read_exact_impl(in_, member.name.data(), length);
+      member.name.erase(member.name.find_last_not_of('\0') + 1);
+      member.size -= length;
+      state_->remaining = member.size;
+    } else if (member.name.size() > 1 && member.name[0] == '/') {
+      auto const offset = static_cast<std::size_t>(
+          parse_field_impl(member.name.data() + 1, member.name.size() - 1, 10));
+      auto const end = long_names_.find("/\n", offset);
+      if (offset >= long_names_.size() || end == std::string::npos)
+        throw std::ios_base::failure("malformed ar long name");
+      member.name = long_names_.substr(offset, end - offset);
+    } else if (member.name.size() > 1 && member.name.back() == '/') {
+      member.name.pop_back();
+    }
+    return true;
+  }
+}
+
+ArMemberSource ArReader::source() const { return ArMemberSource(state_); }
+
+bool visit_deb(std::istream &in, EntryVisitor &visitor,
+               std::string_view member_prefix, std::size_t buffer_size) {
+  ArReader ar(in);
+  ArMember member;
+  while (ar.next(member)) {
+    if (member.name.compare(0, member_prefix.size(), member_prefix) != 0)
+      continue;
+
+    auto const compression = compression_from_name(member.name);
+    if (compression == Compression::Gzip) {
+      boost::iostreams::stream<ArMemberSource> member_in(ar.source(),
+                                                         buffer_size);
+      return visit_tar_gz(member_in, visitor, buffer_size);
+    }
+    boost::iostreams::filtering_istream member_in;
+    push_decompressor(member_in, compression);
+    member_in.push(ar.source(), buffer_size);
+    return visit_tar(member_in, visitor, buffer_size);
+  }
+  throw std::ios_base::failure("no ar member named " +
+                               std::string(member_prefix) + "*");
+}
+} // namespace boost_iostreams_tar_filter
@@ -0,0 +1,377 @@
+#include <boost-iostreams-tar-filter/archive-diff.hxx>
+#include <boost-iostreams-tar-filter/detail/bounded-queue.hxx>
+#include <boost-iostreams-tar-filter/sha256.hxx>
+#include <boost-iostreams-tar-filter/tar-reader.hxx>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <ios>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+
+namespace boost_iostreams_tar_filter {
+namespace {
+/** @brief Everything the comparison needs to know about an entry. */
+struct Summary {
+  std::string name;
+  std::string link_name;
+  std::size_t size = 0;
+  char type = Entry::RegularFile;
+  Digest digest{};
+};
+
+using SummaryQueue = detail::BoundedQueue<Summary>;
+
+/** @brief Thrown inside a reader thread once the comparison gave up. */
+struct Cancelled {};
+
+/**
+ * @brief Visitor hashing payloads and queueing one Summary per entry.
+ */
+class SummaryVisitor : public EntryVisitor {
+public:
+  explicit SummaryVisitor(SummaryQueue &queue) : queue_(queue) {}
+
+  bool on_entry_begin(const Entry &) override { return true; }
+  void on_entry_data(const char *begin, const char *end) override {
+    sha_.update(begin, static_cast<std::size_t>(end - begin));
+  }
+  void on_entry_end(const Entry &entry) override {
+    Summary summary{entry.name, entry.link_name, entry.size,
+                    entry.is_regular_file() ? char(Entry::RegularFile)
+                                            : entry.type,
+                    sha_.finish()};
+    if (!queue_.push(std::move(summary)))
+      throw Cancelled{};
+  }
+
+private:
+  SummaryQueue &queue_;
+  Sha256 sha_;
+};
+
+/**
+ * @brief Parse one archive on a thread, publishing summaries to a queue.
+ */
+class Reader {
+public:
+  Reader(std::istream &in, std::size_t queue_depth) : queue_(queue_depth) {
+    thread_ = std::thread([this, &in] {
+      try {
+        SummaryVisitor visitor(queue_);
+        visit_tar(in, visitor);
+      } catch (const Cancelled &) {
+      } catch (...) {
+        error_ = std::current_exception();
+      }
+      queue_.close();
+    });
+  }
+
+  ~Reader() {
+    queue_.close();
+    if (thread_.joinable())
+      thread_.join();
+  }
+
+  std::optional<Summary> next() { return queue_.pop(); }
+
+  void rethrow() {
+    queue_.close();
+    if (thread_.joinable())
+      thread_.join();
+    if (error_)
+      std::rethrow_exception(error_);
+  }
+
+private:
+  SummaryQueue queue_;
+  std::exception_ptr error_;
+  std::thread thread_;
+};
+
+bool differs_impl(const Summary &a, const Summary &b) {
+  return a.type != b.type || a.size != b.size || a.link_name != b.link_name ||
+         a.digest != b.digest;
+}
+
+/**
+ * @brief Pop the next summary and check the ascending-name precondition.
+ */
+std::optional<Summary> next_sorted_impl(Reader &reader, std::string &last) {
+  auto summary = reader.next();
+  if (summary) {
+    if (!last.empty() && summary->name <= last)
+      throw std::ios_base::failure("archive is not sorted at " +
+                                   summary->name);
+    last = summary->name;
+  }
+  return summary;
+}
+
+void merge_join_impl(Reader &before, Reader &after,
+                     std::vector<DiffEntry> &diff) {
+  std::string last_before, last_after;
+  auto a = next_sorted_impl(before, last_before);
+  auto b = next_sorted_impl(after, last_after);
+  while (a || b) {
+    if (b && (!a || b->name < a->name)) {
+      diff.push_back({DiffEntry::Kind::Added, std::move(b->name)});
+      b = next_sorted_impl(after, last_after);
+    } else if (a && (!b || a->name < b->name)) {
+      diff.push_back({DiffEntry::Kind::Removed, std::move(a->name)});
+      a = next_sorted_impl(before, last_before);
+    } else {
+      if (differs_impl(*a, *b))
+        diff.push_back({DiffEntry::Kind::Modified, a->name});
+      a = next_sorted_impl(before, last_before);
+      b = next_sorted_impl(after, last_after);
+    }
+  }
+}
+
+/** @brief Last summary of each name in one archive. */
+using SummaryMap = std::unordered_map<std::string, Summary>;
+
+void keep_last_impl(SummaryMap &map, Summary summary) {
+  auto name = summary.name;
+  map.insert_or_assign(std::move(name), std::move(summary));
+}
+
+/**
+ * @brief Compare the last copies of every name; before is consumed.
+ */
+void join_maps_impl(SummaryMap &before, const SummaryMap &after,
+                    std::vector<DiffEntry> &diff) {
+  for (const auto &[name, summary] : after) {
+    if (auto it = before.find(name); it != before.end()) {
+      if (differs_impl(summary, it->second))
+        diff.push_back({DiffEntry::Kind::Modified, name});
+      before.erase(it);
+    } else {
+      diff.push_back({DiffEntry::Kind::Added, name});
+    }
+  }
+  for (const auto &[name, summary] : before)
+    diff.push_back({DiffEntry::Kind::Removed, name});
+}
+
+/** @brief Partitions written by each spill pass. */
+constexpr std::size_t spill_partitions = 64;
+
+/** @brief Re-partitioning passes after which the diff gives up. */
+constexpr unsigned max_spill_depth = 4;
+
+struct FileCloser {
+  void operator()(std::FILE *file) const { std::fclose(file); }
+};
+using TempFile = std::unique_ptr<std::FILE, FileCloser>;
+
+void write_impl(std::FILE *file, const void *data, std::size_t size) {
+  if (size > 0 && std::fwrite(data, size, 1, file) != 1)
+    throw std::system_error(errno, std::generic_category(),
+                            "write diff spill file");
+}
+
+bool read_impl(std::FILE *file, void *data, std::size_t size) {
+  return size == 0 || std::fread(data, size, 1, file) == 1;
+}
+
+void write_string_impl(std::FILE *file, const std::string &s) {
+  auto const size = static_cast<std::uint32_t>(s.size());
+  write_impl(file, &size, sizeof(size));
+  write_impl(file, s.data(), s.size());
+}
+
+bool read_string_impl(std::FILE *file, std::string &s) {
+  std::uint32_t size = 0;
+  if (!read_impl(file, &size, sizeof(size)))
+    return false;
+  s.resize(size);
+  return read_impl(file, s.data(), size);
+}
+
+void write_summary_impl(std::FILE *file, const Summary &summary) {
+  write_string_impl(file, summary.name);
+  write_string_impl(file, summary.link_name);
+  auto const size = static_cast<std::uint64_t>(summary.size);
+  write_impl(file, &size, sizeof(size));
+  write_impl(file, &summary.type, sizeof(summary.type));
+  write_impl(file, summary.digest.data(), summary.digest.size());
+}
+
+std::optional<Summary> read_summary_impl(std::FILE *file) {
+  Summary summary;
+  std::uint64_t size = 0;
+  if (!read_string_impl(file, summary.name) ||
+      !read_string_impl(file, summary.link_name) ||
+      !read_impl(file, &size, sizeof(size)) ||
+      !read_impl(file, &summary.type, sizeof(summary.type)) ||
+      !read_impl(file, summary.digest.data(), summary.digest.size()))
+    return std::nullopt;
+  summary.size = static_cast<std::size_t>(size);
+  return summary;
+}
+
+/**
+ * @brief Second half of a Grace hash join, used once the in-memory join
+ * exceeds DiffOptions::max_pending: summaries of both archives are
+ * partitioned by name hash into anonymous temporary files, and each pair of
+ * partitions is joined on its own. A partition where either archive still
+ * has too many names is partitioned again with another hash.
+ */
+class SpillJoin {
+public:
+  explicit SpillJoin(unsigned depth) : depth_(depth) {}
+
+  void add_before(const Summary &summary) { add(before_, summary); }
+  void add_after(const Summary &summary) { add(after_, summary); }
+
+  void join(std::size_t max_pending, std::vector<DiffEntry> &diff) {
+    for (std::size_t p = 0; p < spill_partitions; ++p)
+      join_partition(before_[p].get(), after_[p].get(), max_pending, diff);
+  }
+
+private:
+  using Partitions = std::array<TempFile, spill_partitions>;
+
+  /** @brief Partition of a name, from a hash remixed for every depth. */
+  std::size_t partition(const std::string &name) const {
+    std::uint64_t h = std::hash<std::string>{}(name) +
+                      (depth_ + 1) * 0x9e3779b97f4a7c15ull;
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ull;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebull;
+    return static_cast<std::size_t>((h ^ (h >> 31)) % spill_partitions);
+  }
+
+  void add(Partitions &partitions, const Summary &summary) {
+    auto &file = partitions[partition(summary.name)];
+    if (!file) {
+      file.reset(std::tmpfile());
+      if (!file)
+        throw std::system_error(errno, std::generic_category(),
+                                "create diff spill file");
+    }
+    write_summary_impl(file.get(), summary);
+  }
+
+  void join_partition(std::FILE *before, std::FILE *after,
+                      std::size_t max_pending, std::vector<DiffEntry> &diff) {
+    SummaryMap before_last, after_last;
+    for (auto [file, map] : {std::pair{before, &before_last},
+                             std::pair{after, &after_last}}) {
+      if (!file)
+        continue;
+      std::rewind(file);
+      while (auto summary = read_summary_impl(file)) {
+        keep_last_impl(*map, std::move(*summary));
+        if (map->size() > max_pending) {
+          repartition(before, after, max_pending, diff);
+          return;
+        }
+      }
+    }
+    join_maps_impl(before_last, after_last, diff);
+  }
+
+  void repartition(std::FILE *before, std::FILE *after,
+                   std::size_t max_pending, std::vector<DiffEntry> &diff) {
+    if (depth_ + 1 >= max_spill_depth)
+      throw std::length_error(
+          "archive diff partition exceeds max_pending after " +
+          std::to_string(max_spill_depth) + " spill passes");
+    SpillJoin next(depth_ + 1);
+    if (before) {
+      std::rewind(before);
+      while (auto summary = read_summary_impl(before))
+        next.add_before(*summary);
+    }
+    if (after) {
+      std::rewind(after);
+      while (auto summary = read_summary_impl(after))
+        next.add_after(*summary);
+    }
+    next.join(max_pending, diff);
+  }
+
+  unsigned depth_;
+  Partitions before_;
+  Partitions after_;
+};
+
+/**
+ * @brief Hash join: collect the summaries of both archives by name, a later
+ * copy of a name replacing the earlier one as extraction would, and compare
+ * them once both streams end. Once more than max_pending summaries are held,
+ * everything is handed to a SpillJoin.
+ */
+void hash_join_impl(Reader &before, Reader &after, std::size_t max_pending,
+                    std::vector<DiffEntry> &diff) {
+  SummaryMap before_last, after_last;
+
+  bool before_open = true, after_open = true;
+  while ((before_open || after_open) &&
+         before_last.size() + after_last.size() <= max_pending) {
+    if (before_open) {
+      if (auto a = before.next())
+        keep_last_impl(before_last, std::move(*a));
+      else
+        before_open = false;
+    }
+    if (after_open) {
+      if (auto b = after.next())
+        keep_last_impl(after_last, std::move(*b));
+      else
+        after_open = false;
+    }
+  }
+
+  if (before_open || after_open) {
+    // The maps hold the latest copies so far, and anything still queued
+    // comes after them.
+    SpillJoin spill(0);
+    for (const auto &[name, summary] : before_last)
+      spill.add_before(summary);
+    for (const auto &[name, summary] : after_last)
+      spill.add_after(summary);
+    before_last.clear();
+    after_last.clear();
+    while (auto a = before.next())
+      spill.add_before(*a);
+    while (auto b = after.next())
+      spill.add_after(*b);
+    spill.join(max_pending, diff);
+  } else {
+    join_maps_impl(before_last, after_last, diff);
+  }
+  std::sort(diff.begin(), diff.end(),
+            [](const DiffEntry &x, const DiffEntry &y) { return x.name < y.name; });
+}
+} // unnamed namespace
+
+std::vector<DiffEntry> diff_archives(std::istream &before, std::istream &after,
+                                     DiffOptions options) {
+  if (options.max_pending == 0)
+    throw std::invalid_argument("max_pending must be positive");
+  Reader before_reader(before, options.queue_depth);
+  Reader after_reader(after, options.queue_depth);
+
+  std::vector<DiffEntry> diff;
+  if (options.sorted)
+    merge_join_impl(before_reader, after_reader, diff);
+  else
+    hash_join_impl(before_reader, after_reader, options.max_pending, diff);
+
+  before_reader.rethrow();
+  after_reader.rethrow();
+  return diff;
+}
+} // namespace boost_iostreams_tar_filter
@@ -0,0 +1,38 @@
+#include <boost-iostreams-tar-filter/archive-reader.hxx>
+#include <boost-iostreams-tar-filter/detail/base-cpio-filter-impl.hxx>
+#include <boost-iostreams-tar-filter/detail/base-tar-filter-impl.hxx>
+#include <boost-iostreams-tar-filter/detail/visit-loop.hxx>
+
+#include <algorithm>
+#include <vector>
+
+namespace boost_iostreams_tar_filter {
+ArchiveFormat archive_format_from_magic(std::string_view head) {
+  for (auto const magic : {"070701", "070702", "070707"})
+    if (head.substr(0, 6) == magic)
+      return ArchiveFormat::Cpio;
+  return ArchiveFormat::Tar;
+}
+
+bool visit_cpio(std::istream &in, EntryVisitor &visitor,
+                std::size_t buffer_size) {
+  detail::BaseCpioFilterImpl impl;
+  std::vector<char> buffer(buffer_size);
+  return detail::visit_stream(in, impl, visitor, buffer);
+}
+
+bool visit_archive(std::istream &in, EntryVisitor &visitor,
+                   std::size_t buffer_size) {
+  std::vector<char> buffer(std::max<std::size_t>(buffer_size, 6));
+  in.read(buffer.data(), 6);
+  auto const prefetched = static_cast<std::size_t>(in.gcount());
+
+  if (archive_format_from_magic({buffer.data(), prefetched}) ==
+      ArchiveFormat::Cpio) {
+    detail::BaseCpioFilterImpl impl;
+    return detail::visit_stream(in, impl, visitor, buffer, prefetched);
+  }
+  detail::BaseTarFilterImpl impl;
+  return detail::visit_stream(in, impl, visitor, buffer, prefetched);
+}
+} // namespace boost_iostreams_tar_filter
@@ -0,0 +1,231 @@
+#include <boost-iostreams-tar-filter/archive-store.hxx>
+#include <boost-iostreams-tar-filter/tar-reader.hxx>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <list>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+namespace boost_iostreams_tar_filter {
+namespace {
+/**
+ * @brief Bump allocator handing out slices of shared arena blocks.
+ */
+class Arena {
+public:
+  explicit Arena(std::size_t block_size) : block_size_(block_size) {}
+
+  /**
+   * @brief Reserve size bytes; the returned pointer shares ownership of the
+   * block it lives in.
+   */
+  std::shared_ptr<char> allocate(std::size_t size) {
+    if (size > block_size_ / 4) {
+      // Large files get their own block so they do not pin a shared one.
+      return std::shared_ptr<char>(new char[size ? size : 1],
+                                   std::default_delete<char[]>());
+    }
+    if (!block_ || used_ + size > block_size_) {
+      block_ = std::shared_ptr<char>(new char[block_size_],
+                                     std::default_delete<char[]>());
+      used_ = 0;
+    }
+    auto slice = std::shared_ptr<char>(block_, block_.get() + used_);
+    used_ += size;
+    return slice;
+  }
+
+private:
+  std::size_t block_size_;
+  std::shared_ptr<char> block_;
+  std::size_t used_ = 0;
+};
+
+/**
+ * @brief Visitor copying regular files into the arena.
+ *
+ * The files of the archive are newer than every stored one, so the final
+ * eviction would drop the earliest of them first once they alone exceed the
+ * budget; the visitor drops them as it goes instead, which holds the
+ * incoming bytes to the budget while loading.
+ */
+class LoadVisitor : public EntryVisitor {
+public:
+  struct Loaded {
+    std::string name;
+    std::shared_ptr<char> data;
+    std::size_t size;
+  };
+
+  LoadVisitor(Arena &arena, std::size_t max_size)
+      : arena_(arena), max_size_(max_size) {}
+
+  bool on_entry_begin(const Entry &entry) override {
+    if (auto it = by_name_.find(entry.name); it != by_name_.end()) {
+      // A later copy of the path replaces the earlier one, whatever it is.
+      bytes_ -= it->second->size;
+      loaded.erase(it->second);
+      by_name_.erase(it);
+    }
+    if (!entry.is_regular_file() || entry.size > max_size_)
+      return false;
+    while (bytes_ + entry.size > max_size_) {
+      bytes_ -= loaded.front().size;
+      by_name_.erase(loaded.front().name);
+      loaded.pop_front();
+    }
+    bytes_ += entry.size;
+    loaded.push_back(Loaded{entry.name, arena_.allocate(entry.size), 0});
+    by_name_.emplace(entry.name, std::prev(loaded.end()));
+    return true;
+  }
+
+  void on_entry_data(const char *begin, const char *end) override {
+    auto &file = loaded.back();
+    std::memcpy(file.data.get() + file.size, begin,
+                static_cast<std::size_t>(end - begin));
+    file.size += static_cast<std::size_t>(end - begin);
+  }
+
+  void on_entry_end(const Entry &) override {}
+
+  std::list<Loaded> loaded;
+
+private:
+  Arena &arena_;
+  std::size_t max_size_;
+  std::size_t bytes_ = 0;
+  std::unordered_map<std::string, std::list<Loaded>::iterator> by_name_;
+};
+} // unnamed namespace
+
+ArchiveStore::ArchiveStore(std::size_t byte_budget,
+                           std::size_t arena_block_size)
+    : byte_budget_(byte_budget), arena_block_size_(arena_block_size),
+      index_(new Index) {}
+
+ArchiveStore::~ArchiveStore() {
+  for (const auto &readers : readers_)
+    while (readers.load() != 0)
+      std::this_thread::yield();
+  delete index_.load();
+}
+
+/**
+ * @brief Parse the archive into a private arena, within the budget, then
+ * merge the files into a copy of the current index, evict, and publish the
+ * copy.
+ */
+bool ArchiveStore::load(std::istream &in) {
+  Arena arena(arena_block_size_);
+  LoadVisitor visitor(arena, byte_budget_);
+  auto const done = visit_tar(in, visitor);
+
+  std::lock_guard<std::mutex> lock(writer_mutex_);
+  auto next = std::make_unique<Index>(*index_.load());
+  for (auto &loaded : visitor.loaded) {
+    auto node = std::make_shared<Node>();
+    node->file = File{std::move(loaded.data), loaded.size};
+    node->last_access.store(tick_.fetch_add(1, std::memory_order_relaxed),
+                            std::memory_order_relaxed);
+    next->bytes += loaded.size;
+    auto [it, inserted] = next->nodes.try_emplace(std::move(loaded.name), node);
+    if (!inserted) {
+      next->bytes -= it->second->file.size;
+      it->second = std::move(node);
+    }
+  }
+
+  if (next->bytes > byte_budget_) {
+    std::vector<std::pair<std::uint64_t, const std::string *>> by_age;
+    by_age.reserve(next->nodes.size());
+    for (const auto &[name, node] : next->nodes)
+      by_age.emplace_back(node->last_access.load(std::memory_order_relaxed),
+                          &name);
+    std::sort(by_age.begin(), by_age.end());
+    for (const auto &[tick, name] : by_age) {
+      if (next->bytes <= byte_budget_)
+        break;
+      auto it = next->nodes.find(*name);
+      next->bytes -= it->second->file.size;
+      next->nodes.erase(it);
+    }
+  }
+
+  publish(next.release());
+  return done;
+}
+
+/**
+ * @brief Count the reader in the current epoch's counter. Retrying when the
+ * epoch moved on ensures a reader counted in the previous epoch loaded the
+ * snapshot pointer before publish() started waiting for that epoch.
+ */
+unsigned ArchiveStore::enter() const {
+  for (;;) {
+    auto const epoch = epoch_.load();
+    readers_[epoch].fetch_add(1);
+    if (epoch_.load() == epoch)
+      return epoch;
+    readers_[epoch].fetch_sub(1, std::memory_order_release);
+  }
+}
+
+void ArchiveStore::leave(unsigned epoch) const {
+  readers_[epoch].fetch_sub(1, std::memory_order_release);
+}
+
+/**
+ * @brief Lock-free lookup.
+ *
+ * The reader is counted in its epoch before the snapshot pointer is loaded,
+ * which keeps publish() from freeing a snapshot this reader may still use.
+ */
+ArchiveStore::File ArchiveStore::find(std::string_view path) const {
+  auto const epoch = enter();
+  File file;
+  const auto *index = index_.load();
+  if (auto it = index->nodes.find(path); it != index->nodes.end()) {
+    it->second->last_access.store(tick_.fetch_add(1, std::memory_order_relaxed),
+                                  std::memory_order_relaxed);
+    file = it->second->file;
+  }
+  leave(epoch);
+  return file;
+}
+
+std::size_t ArchiveStore::size_bytes() const {
+  auto const epoch = enter();
+  auto const bytes = index_.load()->bytes;
+  leave(epoch);
+  return bytes;
+}
+
+std::size_t ArchiveStore::count() const {
+  auto const epoch = enter();
+  auto const count = index_.load()->nodes.size();
+  leave(epoch);
+  return count;
+}
+
+/**
+ * @brief Swap in a new snapshot and free the old one. Caller holds the
+ * writer mutex.
+ *
+ * Readers entering after the epoch flip only see the new snapshot, so once
+ * the previous epoch's counter drains (the duration of the lookups already
+ * in flight) nobody can see the old one. Memory is therefore released on
+ * every publish, however busy the readers are.
+ */
+void ArchiveStore::publish(Index *index) {
+  auto *const old = index_.exchange(index);
+  auto const previous = epoch_.load();
+  epoch_.store(previous ^ 1u);
+  while (readers_[previous].load() != 0)
+    std::this_thread::yield();
+  delete old;
+}
+} // namespace boost_iostreams_tar_filter
@@ -0,0 +1,444 @@
+#include <boost-iostreams-tar-filter/detail/base-cpio-filter-impl.hxx>
+
+#include <algorithm>
+#include <cstring>
+#include <ios>
+#include <string>
+
+namespace boost_iostreams_tar_filter::detail {
+namespace {
+constexpr std::size_t magic_size = 6;
+constexpr std::size_t newc_header_size = 110;
+constexpr std::size_t odc_header_size = 76;
+constexpr char trailer_name[] = "TRAILER!!!";
+
+/**
+ * @brief Parse a fixed-width hexadecimal (newc) or octal (odc) field.
+ */
+std::uint64_t parse_field_impl(const char *p, std::size_t n, unsigned base) {
+  std::uint64_t result = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    auto const c = p[i];
+    unsigned digit;
+    if (c >= '0' && c <= '9')
+      digit = static_cast<unsigned>(c - '0');
+    else if (c >= 'a' && c <= 'f')
+      digit = static_cast<unsigned>(c - 'a' + 10);
+    else if (c >= 'A' && c <= 'F')
+      digit = static_cast<unsigned>(c - 'A' + 10);
+    else
+      digit = base;
+    if (digit >= base)
+      throw std::ios_base::failure("malformed cpio header field");
+    result = result * base + digit;
+  }
+  return result;
+}
+
+/**
+ * @brief Map the S_IFMT bits of a cpio mode to a TAR typeflag. Sockets,
+ * which TAR cannot represent, are reported as FIFOs.
+ */
+char type_from_mode_impl(std::uint64_t mode) {
+  switch (mode & 0170000) {
+  case 0040000:
+    return Entry::Directory;
+  case 0120000:
+    return Entry::SymbolicLink;
+  case 0020000:
+    return Entry::CharacterDevice;
+  case 0060000:
+    return Entry::BlockDevice;
+  case 0010000:
+  case 0140000:
+    return Entry::Fifo;
+  default:
+    return Entry::RegularFile;
+  }
+}
+
+/**
+ * @brief Bytes needed to align offset to a 4-byte boundary (newc/crc only).
+ */
+std::size_t align4_impl(std::size_t offset, BaseCpioFilterImpl::Format format) {
+  return format == BaseCpioFilterImpl::Format::Odc ? 0 : (4 - offset % 4) % 4;
+}
+} // unnamed namespace
+
+bool BaseCpioFilterImpl::read_header(const char *&src_begin,
+                                     const char *const src_end) {
+  if (header_buffer.size() < header_bytes_needed)
+    header_buffer.resize(header_bytes_needed);
+  auto const to_copy =
+      std::min(header_bytes_needed - header_bytes_read,
+               static_cast<std::size_t>(src_end - src_begin));
+  std::memcpy(header_buffer.data() + header_bytes_read, src_begin, to_copy);
+  src_begin += to_copy;
+  header_bytes_read += to_copy;
+  return header_bytes_read == header_bytes_needed;
+}
+
+bool BaseCpioFilterImpl::read_metadata(const char *&src_begin,
+                                       const char *const src_end) {
+  while (src_begin < src_end) {
+    switch (state) {
+    case State::ReadHeader:
+      if (header_bytes_needed == 0)
+        header_bytes_needed = magic_size;
+      if (!read_header(src_begin, src_end))
+        return false;
+      if (header_bytes_needed == magic_size) {
+        if (std::memcmp(header_buffer.data(), "070701", magic_size) == 0)
+          format = Format::Newc;
+        else if (std::memcmp(header_buffer.data(), "070702", magic_size) == 0)
+          format = Format::Crc;
+        else if (std::memcmp(header_buffer.data(), "070707", magic_size) == 0)
+          format = Format::Odc;
+        else if (after_trailer_) {
+          // Not another archive: whatever follows the last one is ignored.
+          state = State::Done;
+          return true;
+        } else {
+          throw std::ios_base::failure("not a cpio header");
+        }
+        after_trailer_ = false;
+        fixed_header_size_ =
+            format == Format::Odc ? odc_header_size : newc_header_size;
+        header_bytes_needed = fixed_header_size_;
+        break;
+      }
+      parse_header();
+      state = State::ReadName;
+      break;
+
+    case State::ReadName:
+      if (!read_header(src_begin, src_end))
+        return false;
+      begin_entry();
+      if (state != State::ReadLinkTarget)
+        return true;
+      break;
+
+    case State::ReadLinkTarget:
+      if (!read_header(src_begin, src_end))
+        return false;
+      current_entry.link_name.assign(
+          header_buffer.data() + header_bytes_needed - file_size_, file_size_);
+      header_bytes_read = 0;
+      header_bytes_needed = 0;
+      file_size_ = 0;
+      state = State::SkipPadding;
+      return true;
+
+    default:
+      return true;
+    }
+  }
+  return false;
+}
+
+void BaseCpioFilterImpl::parse_header() {
+  auto const h = header_buffer.data();
+  current_entry = Entry{};
+  std::uint64_t mode;
+  if (format == Format::Odc) {
+    inode_ = {parse_field_impl(h + 6, 6, 8), 0, parse_field_impl(h + 12, 6, 8)};
+    mode = parse_field_impl(h + 18, 6, 8);
+    current_entry.uid = static_cast<std::uint32_t>(parse_field_impl(h + 24, 6, 8));
+    current_entry.gid = static_cast<std::uint32_t>(parse_field_impl(h + 30, 6, 8));
+    nlink_ = static_cast<std::uint32_t>(parse_field_impl(h + 36, 6, 8));
+    current_entry.mtime = static_cast<std::int64_t>(parse_field_impl(h + 48, 11, 8));
+    name_size_ = static_cast<std::size_t>(parse_field_impl(h + 59, 6, 8));
+    file_size_ = static_cast<std::size_t>(parse_field_impl(h + 65, 11, 8));
+  } else {
+    auto const field = [h](std::size_t index) {
+      return parse_field_impl(h + magic_size + 8 * index, 8, 16);
+    };
+    mode = field(1);
+    current_entry.uid = static_cast<std::uint32_t>(field(2));
+    current_entry.gid = static_cast<std::uint32_t>(field(3));
+    nlink_ = static_cast<std::uint32_t>(field(4));
+    current_entry.mtime = static_cast<std::int64_t>(field(5));
+    file_size_ = static_cast<std::size_t>(field(6));
+    inode_ = {field(7), field(8), field(0)};
+    name_size_ = static_cast<std::size_t>(field(11));
+  }
+  if (name_size_ == 0)
+    throw std::ios_base::failure("malformed cpio name size");
+  current_entry.mode = static_cast<std::uint32_t>(mode & 07777);
+  current_entry.type = type_from_mode_impl(mode);
+  current_entry.size = file_size_;
+  name_padding_ = align4_impl(fixed_header_size_ + name_size_, format);
+  header_bytes_needed = fixed_header_size_ + name_size_ + name_padding_;
+}
+
+void BaseCpioFilterImpl::begin_entry() {
+  auto const name = header_buffer.data() + fixed_header_size_;
+  current_entry.name.assign(name, std::find(name, name + name_size_, '\0'));
+  is_trailer_ = current_entry.name == trailer_name;
+  file_bytes_read = 0;
+  padding_bytes = align4_impl(file_size_, format);
+  padding_bytes_skipped = 0;
+  skip_file_data = false;
+  header_bytes_read = 0;
+  header_bytes_needed = 0;
+
+  if (is_trailer_) {
+    after_trailer_ = true;
+    state = State::SkipTrailerPadding;
+  } else if (current_entry.is_symlink() && file_size_ > 0) {
+    // The target is the payload; buffer it after the name.
+    header_bytes_read = fixed_header_size_ + name_size_ + name_padding_;
+    header_bytes_needed = header_bytes_read + file_size_;
+    state = State::ReadLinkTarget;
+  } else if (current_entry.is_regular_file()) {
+    state = State::ReadFileData;
+  } else {
+    padding_bytes += file_size_;
+    file_size_ = 0;
+    state = State::SkipPadding;
+  }
+  if (state != State::ReadLinkTarget)
+    current_entry.size = file_size_;
+  else
+    current_entry.size = 0;
+}
+
+bool BaseCpioFilterImpl::skip_trailer_padding(const char *&src_begin,
+                                               const char *const src_end) {
+  src_begin =
+      std::find_if(src_begin, src_end, [](char c) { return c != '\0'; });
+  if (src_begin == src_end)
+    return false;
+  state = State::ReadHeader;
+  return true;
+}
+
+/**
+ * @brief Same stages as visit(), copying regular file payload into the
+ * destination instead of reporting it.
+ */
+bool BaseCpioFilterImpl::filter(const char *&src_begin,
+                                const char *const src_end, char *&dest_begin,
+                                const char *const dest_end, bool flush) {
+  while (src_begin < src_end && dest_begin < dest_end) {
+    switch (state) {
+    case State::ReadHeader:
+    case State::ReadName:
+    case State::ReadLinkTarget:
+      if (!read_metadata(src_begin, src_end))
+        break;
+      if (state == State::Done)
+        return false;
+      if (state == State::ReadFileData && file_size_ == 0)
+        state = State::SkipPadding;
+      break;
+
+    case State::SkipTrailerPadding:
+      skip_trailer_padding(src_begin, src_end);
+      break;
+
+    case State::ReadFileData: {
+      auto const to_copy = std::min(
+          file_size_ - file_bytes_read,
+          std::min(static_cast<std::size_t>(src_end - src_begin),
+                   static_cast<std::size_t>(dest_end - dest_begin)));
+      std::copy(src_begin, src_begin + to_copy, dest_begin);
+      src_begin += to_copy;
+      dest_begin += to_copy;
+      file_bytes_read += to_copy;
+      if (file_bytes_read == file_size_)
+        state = State::SkipPadding;
+      break;
+    }
+
+    case State::SkipPadding: {
+      auto const to_skip =
+          std::min(padding_bytes - padding_bytes_skipped,
+                   static_cast<std::size_t>(src_end - src_begin));
+      src_begin += to_skip;
+      padding_bytes_skipped += to_skip;
+      if (padding_bytes_skipped == padding_bytes)
+        state = State::ReadHeader;
+      break;
+    }
+
+    case State::Done:
+      return false;
+    }
+  }
+  // At the end of the input nothing more can be produced, also when the
+  // input may continue with another archive.
+  return state != State::Done && !(flush && src_begin == src_end);
+}
+
+/**
+ * @brief Visitor-driven variant of filter(); payload slices point into
+ * [src_begin, src_end).
+ */
+bool BaseCpioFilterImpl::visit(const char *&src_begin,
+                               const char *const src_end,
+                               EntryVisitor &visitor) {
+  while (src_begin < src_end) {
+    switch (state) {
+    case State::ReadHeader:
+    case State::ReadName:
+    case State::ReadLinkTarget: {
+      if (!read_metadata(src_begin, src_end))
+        break;
+      if (state == State::Done)
+        return false;
+      if (state == State::SkipTrailerPadding) {
+        // Inode numbers start over in the next archive.
+        report_remaining_links(visitor);
+        break;
+      }
+      if (format != Format::Odc && nlink_ > 1 &&
+          current_entry.is_regular_file() && file_size_ == 0) {
+        // newc stores the data with the last link of a set only.
+        if (auto const it = linked_names_.find(inode_);
+            it != linked_names_.end()) {
+          current_entry.type = Entry::HardLink;
+          current_entry.link_name = it->second;
+          visitor.on_entry_begin(current_entry);
+          visitor.on_entry_end(current_entry);
+        } else {
+          deferred_links_[inode_].push_back(current_entry);
+        }
+        state = State::SkipPadding;
+        break;
+      }
+      skip_file_data = !visitor.on_entry_begin(current_entry);
+      if (state == State::SkipPadding || file_size_ == 0) {
+        visitor.on_entry_end(current_entry);
+        report_links(visitor);
+        state = State::SkipPadding;
+      }
+      break;
+    }
+
+    case State::ReadFileData: {
+      auto const to_read =
+          std::min(file_size_ - file_bytes_read,
+                   static_cast<std::size_t>(src_end - src_begin));
+      if (!skip_file_data)
+        visitor.on_entry_data(src_begin, src_begin + to_read);
+      src_begin += to_read;
+      file_bytes_read += to_read;
+      if (file_bytes_read == file_size_) {
+        visitor.on_entry_end(current_entry);
+        report_links(visitor);
+        state = State::SkipPadding;
+      }
+      break;
+    }
+
+    case State::SkipTrailerPadding:
+      skip_trailer_padding(src_begin, src_end);
+      break;
+
+    case State::SkipPadding: {
+      auto const to_skip =
+          std::min(padding_bytes - padding_bytes_skipped,
+                   static_cast<std::size_t>(src_end - src_begin));
+      src_begin += to_skip;
+      padding_bytes_skipped += to_skip;
+      if (padding_bytes_skipped == padding_bytes)
+        state = State::ReadHeader;
+      break;
+    }
+
+    case State::Done:
+      return false;
+    }
+  }
+  if (state == State::SkipPadding && padding_bytes_skipped == padding_bytes)
+    state = State::ReadHeader;
+  return state != State::Done;
+}
+
+void BaseCpioFilterImpl::report_links(EntryVisitor &visitor) {
+  if (nlink_ <= 1 || format == Format::Odc)
+    return;
+  linked_names_[inode_] = current_entry.name;
+  auto const it = deferred_links_.find(inode_);
+  if (it == deferred_links_.end())
+    return;
+  for (auto &link : it->second) {
+    link.type = Entry::HardLink;
+    link.link_name = current_entry.name;
+    visitor.on_entry_begin(link);
+    visitor.on_entry_end(link);
+  }
+  deferred_links_.erase(it);
+}
+
+void BaseCpioFilterImpl::report_remaining_links(EntryVisitor &visitor) {
+  for (auto &[inode, links] : deferred_links_) {
+    auto const &first = links.front();
+    visitor.on_entry_begin(first);
+    visitor.on_entry_end(first);
+    for (std::size_t i = 1; i < links.size(); ++i) {
+      links[i].type = Entry::HardLink;
+      links[i].link_name = first.name;
+      visitor.on_entry_begin(links[i]);
+      visitor.on_entry_end(links[i]);
+    }
+  }
+  deferred_links_.clear();
+  linked_names_.clear();
+}
+
+std::size_t BaseCpioFilterImpl::pending_discard() const {
+  switch (state) {
+  case State::ReadFileData:
+    if (!skip_file_data)
+      return 0;
+    return file_size_ - file_bytes_read + padding_bytes - padding_bytes_skipped;
+  case State::SkipPadding:
+    return padding_bytes - padding_bytes_skipped;
+  default:
+    return 0;
+  }
+}
+
+void BaseCpioFilterImpl::discard(std::size_t count, EntryVisitor &visitor) {
+  while (count > 0) {
+    if (state == State::ReadFileData) {
+      auto const to_skip = std::min(count, file_size_ - file_bytes_read);
+      file_bytes_read += to_skip;
+      count -= to_skip;
+      if (file_bytes_read == file_size_) {
+        visitor.on_entry_end(current_entry);
+        report_links(visitor);
+        state = State::SkipPadding;
+      }
+    } else if (state == State::SkipPadding) {
+      auto const to_skip =
+          std::min(count, padding_bytes - padding_bytes_skipped);
+      padding_bytes_skipped += to_skip;
+      count -= to_skip;
+      if (padding_bytes_skipped == padding_bytes)
+        state = State::ReadHeader;
+    } else {
+      break;
+    }
+  }
+}
+
+void BaseCpioFilterImpl::close() {
+  state = State::ReadHeader;
+  header_bytes_read = 0;
+  header_bytes_needed = 0;
+  file_size_ = 0;
+  file_bytes_read = 0;
+  padding_bytes = 0;
+  padding_bytes_skipped = 0;
+  skip_file_data = false;
+  after_trailer_ = false;
+  header_buffer.clear();
+  current_entry = Entry{};
+  deferred_links_.clear();
+  linked_names_.clear();
+}
+} // namespace boost_iostreams_tar_filter::detail
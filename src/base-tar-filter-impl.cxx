@@ -1,8 +1,13 @@
 #include <boost-iostreams-tar-filter/detail/base-tar-filter-impl.hxx>
 #include <boost-iostreams-tar-filter/detail/tar-header.hxx>
+#include <algorithm>
+#include <charconv>
 #include <cstdint>
 #include <cstring>
+#include <ios>
+#include <limits>
 #include <string>
+#include <string_view>
 
 namespace boost_iostreams_tar_filter::detail {
 namespace {
@@ -93,21 +98,49 @@ std::size_t parse_octal_impl(const char *p, std::size_t n) {
 }
 
 /**
- * @brief Extract file size from a TarHeader, handling octal and base-256
+ * @brief Parse a numeric TAR header field, handling octal and base-256
  * encodings.
  *
- * The function inspects the first byte to determine whether the size uses
+ * The function inspects the first byte to determine whether the field uses
  * the base-256 (binary) encoding (high bit set) or the traditional octal text.
  *
+ * @param p Pointer to the first byte of the field.
+ * @param n Size of the field in bytes.
+ * @return int64_t Decoded value.
+ */
+int64_t parse_numeric_impl(const char *p, std::size_t n) {
+  if (static_cast<unsigned char>(p[0]) & 0x80)
+    return parse_base256_impl(p, n);
+  else
+    return static_cast<int64_t>(parse_octal_impl(p, n));
+}
+
+/**
+ * @brief Extract file size from a TarHeader, handling octal and base-256
+ * encodings.
+ *
  * @param tar Pointer to the parsed TarHeader.
  * @return std::size_t File size in bytes.
  */
 std::size_t parse_file_size_impl(const TarHeader *tar) {
-  if (static_cast<unsigned char>(tar->size[0]) & 0x80)
-    return static_cast<std::size_t>(
-        parse_base256_impl(tar->size, sizeof(tar->size)));
-  else
-    return parse_octal_impl(tar->size, sizeof(tar->size));
+  return static_cast<std::size_t>(
+      parse_numeric_impl(tar->size, sizeof(tar->size)));
+}
+
+/**
+ * @brief Build a std::string from a fixed-size header field that is
+ * NUL-terminated only when shorter than the field.
+ *
+ * @param p Pointer to the first byte of the field.
+ * @param n Size of the field in bytes.
+ * @return std::string The field contents up to the first NUL.
+ */
+std::string extract_string_impl(const char *p, std::size_t n) {
+  std::size_t len = 0;
+  for (; len < n; ++len)
+    if (p[len] == '\0')
+      break;
+  return std::string(p, len);
 }
 
 /**
@@ -116,18 +149,18 @@ std::size_t parse_file_size_impl(const TarHeader *tar) {
  * File name fields in the TAR header may not occupy all 100 bytes and are
  * not guaranteed to be NUL-terminated if the full length is used. This
  * helper returns a std::string constructed from the name bytes up to the
- * first NUL or the full length.
+ * first NUL or the full length, joined with the ustar prefix when present.
  *
  * @param tar Pointer to the TarHeader.
  * @return std::string The file name as a std::string.
  */
 std::string extract_file_name_impl(const TarHeader *tar) {
-  const char *start = tar->name;
-  std::size_t len = 0;
-  for (; len < sizeof(tar->name); ++len)
-    if (start[len] == '\0')
-      break;
-  return std::string(start, len);
+  auto name = extract_string_impl(tar->name, sizeof(tar->name));
+  // POSIX ustar splits long paths into prefix + name. GNU archives reuse the
+  // prefix area for other fields, so only honour it for the POSIX magic.
+  if (std::memcmp(tar->magic, "ustar", 6) == 0 && tar->prefix[0] != '\0')
+    return extract_string_impl(tar->prefix, sizeof(tar->prefix)) + '/' + name;
+  return name;
 }
 
 /**
@@ -143,6 +176,104 @@ inline bool is_regular_file(const TarHeader *tar) {
   return tar->typeflag[0] == '0' || tar->typeflag[0] == '\0';
 }
 
+/**
+ * @brief Decode every header field exposed through Entry.
+ *
+ * @param tar Pointer to the TarHeader.
+ * @return Entry Decoded entry metadata.
+ */
+Entry parse_entry_impl(const TarHeader *tar) {
+  Entry entry;
+  entry.name = extract_file_name_impl(tar);
+  entry.link_name = extract_string_impl(tar->linkname, sizeof(tar->linkname));
+  entry.size = parse_file_size_impl(tar);
+  entry.mode = static_cast<std::uint32_t>(
+      parse_numeric_impl(tar->mode, sizeof(tar->mode)));
+  entry.uid =
+      static_cast<std::uint32_t>(parse_numeric_impl(tar->uid, sizeof(tar->uid)));
+  entry.gid =
+      static_cast<std::uint32_t>(parse_numeric_impl(tar->gid, sizeof(tar->gid)));
+  entry.mtime = parse_numeric_impl(tar->mtime, sizeof(tar->mtime));
+  entry.type = tar->typeflag[0];
+  return entry;
+}
+
+/** @brief Typeflag of a GNU volume label. */
+constexpr char gnu_volume_header = 'V';
+/** @brief Typeflag of a GNU multi-volume continuation header. */
+constexpr char gnu_multi_volume = 'M';
+/** @brief Position of the 12-byte offset field of GNU headers, the number
+ * of payload bytes stored in earlier volumes. */
+constexpr std::size_t gnu_offset_field = 369;
+/** @brief Typeflag of a pax extended header for the next entry. */
+constexpr char pax_extended_header = 'x';
+/** @brief Typeflag of a pax global extended header. */
+constexpr char pax_global_header = 'g';
+/** @brief Typeflag of a GNU long-name record for the next entry. */
+constexpr char gnu_long_name = 'L';
+/** @brief Typeflag of a GNU long-link record for the next entry. */
+constexpr char gnu_long_link = 'K';
+
+/**
+ * @brief Check whether a typeflag marks a record that extends the header
+ * after it rather than an entry of its own.
+ */
+bool is_extension_impl(char type) {
+  return type == pax_extended_header || type == pax_global_header ||
+         type == gnu_long_name || type == gnu_long_link;
+}
+
+/**
+ * @brief Parse the decimal value of a numeric pax record.
+ *
+ * @param key Record keyword for error messages.
+ * @param value Record value.
+ * @param min Smallest accepted value.
+ * @param max Largest accepted value.
+ * @param fraction Whether a fractional part (as in mtime) is allowed; it is
+ * truncated.
+ * @throws std::ios_base::failure when the value is not a number in range.
+ */
+std::int64_t parse_pax_integer_impl(std::string_view key,
+                                    std::string_view value, std::int64_t min,
+                                    std::int64_t max, bool fraction = false) {
+  std::int64_t result = 0;
+  auto const end = value.data() + value.size();
+  auto const [ptr, ec] = std::from_chars(value.data(), end, result);
+  if (ec != std::errc() || (ptr != end && !(fraction && *ptr == '.')) ||
+      result < min || result > max)
+    throw std::ios_base::failure("malformed pax " + std::string(key) +
+                                 " record");
+  return result;
+}
+
+/**
+ * @brief Split the contents of a pax extended header into its
+ * "<length> <key>=<value>\n" records.
+ *
+ * @param data Contents of the extended header.
+ * @param on_record Called with the key and value of each record.
+ * @throws std::ios_base::failure on a malformed record.
+ */
+template <typename OnRecord>
+void for_each_pax_record_impl(std::string_view data, OnRecord &&on_record) {
+  while (!data.empty() && data.front() != '\0') {
+    std::size_t length = 0;
+    auto const [ptr, ec] =
+        std::from_chars(data.data(), data.data() + data.size(), length);
+    auto const digits = static_cast<std::size_t>(ptr - data.data());
+    if (ec != std::errc() || length <= digits + 1 || length > data.size() ||
+        *ptr != ' ' || data[length - 1] != '\n')
+      throw std::ios_base::failure("malformed pax extended header");
+    auto const record = data.substr(digits + 1, length - digits - 2);
+    auto const equals = record.find('=');
+    if (equals == std::string_view::npos)
+      throw std::ios_base::failure("malformed pax extended header");
+    on_record(record.substr(0, equals), record.substr(equals + 1));
+    data.remove_prefix(length);
+  }
+}
+
 } // unnamed namespace
 
 /**
@@ -186,40 +317,22 @@ bool BaseTarFilterImpl::filter(const char *&src_begin,
   while (src_begin < src_end && dest_begin < dest_end) {
     switch (state) {
     case State::ReadHeader: {
-      auto needed = 512 - header_bytes_read;
-      auto available = static_cast<std::size_t>(src_end - src_begin);
-      auto to_copy = std::min(needed, available);
-
-      if (header_buffer.size() < 512)
-        header_buffer.resize(512);
-      std::memcpy(&header_buffer[header_bytes_read], src_begin,
-                  to_copy * sizeof(char));
-      src_begin += to_copy;
-      header_bytes_read += to_copy;
-
-      if (header_bytes_read == 512) {
-        if (is_zero_block_impl(header_buffer.data())) {
-          state = State::Done;
-          return false;
-        }
-        auto tar = reinterpret_cast<const TarHeader *>(header_buffer.data());
-        file_size_ = parse_file_size_impl(tar);
-        current_file_name = extract_file_name_impl(tar);
-        file_bytes_read = 0;
-        padding_bytes = (512 - (file_size_ % 512)) % 512;
-        padding_bytes_skipped = 0;
-
-        if (is_regular_file(tar)) {
-          state = State::ReadFileData;
-        } else {
-          state = State::SkipPadding;
-          file_size_ = 0;
-        }
-        header_bytes_read = 0;
+      if (!read_header(src_begin, src_end))
+        break;
+      if (is_zero_block_impl(header_buffer.data())) {
+        state = State::Done;
+        return false;
       }
+      if (volume_start_ && continue_volume())
+        break;
+      begin_entry();
       break;
     }
 
+    case State::ReadExtension:
+      read_extension(src_begin, src_end);
+      break;
+
     case State::ReadFileData: {
       auto remaining = file_size_ - file_bytes_read;
       auto src_avail = static_cast<std::size_t>(src_end - src_begin);
@@ -231,6 +344,7 @@ bool BaseTarFilterImpl::filter(const char *&src_begin,
       src_begin += to_copy;
       dest_begin += to_copy;
       file_bytes_read += to_copy;
+      input_offset_ += to_copy;
 
       if (file_bytes_read == file_size_)
         state = State::SkipPadding;
@@ -244,6 +358,7 @@ bool BaseTarFilterImpl::filter(const char *&src_begin,
 
       src_begin += to_skip;
       padding_bytes_skipped += to_skip;
+      input_offset_ += to_skip;
 
       if (padding_bytes_skipped == padding_bytes)
         state = State::ReadHeader;
@@ -258,6 +373,343 @@ bool BaseTarFilterImpl::filter(const char *&src_begin,
   return true;
 }
 
+/**
+ * @brief Accumulate header bytes until a full 512-byte block is buffered.
+ *
+ * @param src_begin Reference to the start pointer of the source buffer;
+ * advanced by the number of bytes consumed.
+ * @param src_end Pointer to one-past-the-end of the source buffer.
+ * @return true when header_buffer holds a complete header block.
+ */
+bool BaseTarFilterImpl::read_header(const char *&src_begin,
+                                    const char *const src_end) {
+  auto needed = 512 - header_bytes_read;
+  auto available = static_cast<std::size_t>(src_end - src_begin);
+  auto to_copy = std::min(needed, available);
+
+  if (header_buffer.size() < 512)
+    header_buffer.resize(512);
+  std::memcpy(&header_buffer[header_bytes_read], src_begin,
+              to_copy * sizeof(char));
+  src_begin += to_copy;
+  header_bytes_read += to_copy;
+  input_offset_ += to_copy;
+
+  if (header_bytes_read != 512)
+    return false;
+  header_bytes_read = 0;
+  return true;
+}
+
+/**
+ * @brief Decode the buffered header and prepare the state machine for the
+ * entry's payload.
+ *
+ * Extension records move to ReadExtension. Regular files move to
+ * ReadFileData. Every other entry type moves straight to SkipPadding; any
+ * data such entries carry is skipped together with its padding.
+ */
+bool BaseTarFilterImpl::begin_entry() {
+  auto tar = reinterpret_cast<const TarHeader *>(header_buffer.data());
+  if (is_extension_impl(tar->typeflag[0])) {
+    if (!extension_offset_)
+      extension_offset_ = input_offset_ - 512;
+    auto const size = parse_file_size_impl(tar);
+    if (size > max_extension_size)
+      throw std::ios_base::failure("tar extension record of " +
+                                   std::to_string(size) +
+                                   " bytes exceeds the limit");
+    extension_type_ = tar->typeflag[0];
+    extension_data_.clear();
+    file_size_ = size;
+    file_bytes_read = 0;
+    padding_bytes = (512 - (size % 512)) % 512;
+    padding_bytes_skipped = 0;
+    state = State::ReadExtension;
+    if (size == 0) {
+      apply_extension();
+      state = State::SkipPadding;
+    }
+    return false;
+  }
+
+  current_entry = parse_entry_impl(tar);
+  for (const auto *overrides : {&global_, &pending_}) {
+    if (overrides->path)
+      current_entry.name = *overrides->path;
+    if (overrides->link_path)
+      current_entry.link_name = *overrides->link_path;
+    if (overrides->size)
+      current_entry.size = *overrides->size;
+    if (overrides->mtime)
+      current_entry.mtime = *overrides->mtime;
+    if (overrides->uid)
+      current_entry.uid = *overrides->uid;
+    if (overrides->gid)
+      current_entry.gid = *overrides->gid;
+  }
+  pending_ = Overrides{};
+  entry_offset_ = extension_offset_.value_or(input_offset_ - 512);
+  extension_offset_.reset();
+  current_file_name = current_entry.name;
+  file_size_ = current_entry.size;
+  file_bytes_read = 0;
+  padding_bytes = (512 - (file_size_ % 512)) % 512;
+  padding_bytes_skipped = 0;
+  skip_file_data = false;
+
+  if (is_regular_file(tar)) {
+    state = State::ReadFileData;
+  } else {
+    state = State::SkipPadding;
+    padding_bytes += file_size_;
+    file_size_ = 0;
+  }
+  return true;
+}
+
+void BaseTarFilterImpl::read_extension(const char *&src_begin,
+                                       const char *const src_end) {
+  auto const to_read =
+      std::min(file_size_ - file_bytes_read,
+               static_cast<std::size_t>(src_end - src_begin));
+  extension_data_.append(src_begin, to_read);
+  src_begin += to_read;
+  file_bytes_read += to_read;
+  input_offset_ += to_read;
+  if (file_bytes_read == file_size_) {
+    apply_extension();
+    state = State::SkipPadding;
+  }
+}
+
+/**
+ * @brief GNU records hold a NUL-terminated name; pax records are
+ * "<length> <key>=<value>\n" lines, where an empty value removes the
+ * override.
+ */
+void BaseTarFilterImpl::apply_extension() {
+  if (extension_type_ == gnu_long_name || extension_type_ == gnu_long_link) {
+    auto name = extension_data_.substr(0, extension_data_.find('\0'));
+    if (extension_type_ == gnu_long_name)
+      pending_.path = std::move(name);
+    else
+      pending_.link_path = std::move(name);
+    return;
+  }
+
+  constexpr auto int64_max = std::numeric_limits<std::int64_t>::max();
+  constexpr auto uint32_max = std::numeric_limits<std::uint32_t>::max();
+  auto &overrides =
+      extension_type_ == pax_global_header ? global_ : pending_;
+  for_each_pax_record_impl(
+      extension_data_, [&](std::string_view key, std::string_view value) {
+        if (key == "path") {
+          overrides.path = std::string(value);
+          if (value.empty())
+            overrides.path.reset();
+        } else if (key == "linkpath") {
+          overrides.link_path = std::string(value);
+          if (value.empty())
+            overrides.link_path.reset();
+        } else if (value.empty()) {
+          if (key == "size")
+            overrides.size.reset();
+          else if (key == "mtime")
+            overrides.mtime.reset();
+          else if (key == "uid")
+            overrides.uid.reset();
+          else if (key == "gid")
+            overrides.gid.reset();
+        } else if (key == "size") {
+          overrides.size = static_cast<std::size_t>(
+              parse_pax_integer_impl(key, value, 0, int64_max));
+        } else if (key == "mtime") {
+          overrides.mtime = parse_pax_integer_impl(
+              key, value, std::numeric_limits<std::int64_t>::min(),
+              int64_max, true);
+        } else if (key == "uid") {
+          overrides.uid = static_cast<std::uint32_t>(
+              parse_pax_integer_impl(key, value, 0, uint32_max));
+        } else if (key == "gid") {
+          overrides.gid = static_cast<std::uint32_t>(
+              parse_pax_integer_impl(key, value, 0, uint32_max));
+        }
+      });
+}
+
+void BaseTarFilterImpl::begin_volume() {
+  if (header_bytes_read != 0 || state == State::ReadExtension ||
+      (state == State::SkipPadding && padding_bytes_skipped != padding_bytes))
+    throw std::ios_base::failure("tar volume ends inside a header block");
+  volume_start_ = true;
+  continuation_pending_ =
+      state == State::ReadFileData && file_bytes_read < file_size_;
+  state = State::ReadHeader;
+}
+
+/**
+ * @brief GNU tar starts each continuation volume with an optional 'V' label
+ * and, when a file was split, an 'M' header whose offset field says how much
+ * of the file earlier volumes held and whose size is what is left.
+ */
+bool BaseTarFilterImpl::continue_volume() {
+  auto tar = reinterpret_cast<const TarHeader *>(header_buffer.data());
+  if (tar->typeflag[0] == gnu_volume_header) {
+    padding_bytes = (parse_file_size_impl(tar) + 511) / 512 * 512;
+    padding_bytes_skipped = 0;
+    state = State::SkipPadding;
+    return true;
+  }
+
+  volume_start_ = false;
+  if (!continuation_pending_)
+    return false;
+  continuation_pending_ = false;
+
+  auto const name = extract_string_impl(tar->name, sizeof(tar->name));
+  auto const offset = static_cast<std::size_t>(
+      parse_numeric_impl(header_buffer.data() + gnu_offset_field, 12));
+  if (tar->typeflag[0] != gnu_multi_volume ||
+      current_entry.name.compare(0, name.size(), name) != 0)
+    throw std::ios_base::failure("missing multi-volume continuation of " +
+                                 current_entry.name);
+  if (offset != file_bytes_read ||
+      parse_file_size_impl(tar) != file_size_ - file_bytes_read)
+    throw std::ios_base::failure("multi-volume continuation of " +
+                                 current_entry.name +
+                                 " does not match the previous volume");
+  padding_bytes = (512 - (file_size_ % 512)) % 512;
+  padding_bytes_skipped = 0;
+  state = State::ReadFileData;
+  return true;
+}
+
+/**
+ * @brief Visitor-driven variant of filter().
+ *
+ * Payload bytes are never copied: each slice handed to
+ * EntryVisitor::on_entry_data() points into [src_begin, src_end). When the
+ * visitor declines an entry the payload is consumed without being reported.
+ *
+ * @param src_begin Reference to the start pointer of the source buffer;
+ * advanced by the number of bytes consumed.
+ * @param src_end Pointer to one-past-the-end of the source buffer.
+ * @param visitor Receiver of entries and payload slices.
+ * @return true when more input is expected.
+ * @return false once the end-of-archive marker was reached.
+ */
+bool BaseTarFilterImpl::visit(const char *&src_begin,
+                              const char *const src_end,
+                              EntryVisitor &visitor) {
+  while (src_begin < src_end) {
+    switch (state) {
+    case State::ReadHeader: {
+      if (!read_header(src_begin, src_end))
+        break;
+      if (is_zero_block_impl(header_buffer.data())) {
+        state = State::Done;
+        return false;
+      }
+      if (volume_start_ && continue_volume())
+        break;
+      if (!begin_entry())
+        break;
+      skip_file_data = !visitor.on_entry_begin(current_entry);
+      if (state == State::SkipPadding || file_size_ == 0) {
+        visitor.on_entry_end(current_entry);
+        state = State::SkipPadding;
+      }
+      break;
+    }
+
+    case State::ReadFileData: {
+      auto remaining = file_size_ - file_bytes_read;
+      auto src_avail = static_cast<std::size_t>(src_end - src_begin);
+      auto const to_read = std::min(remaining, src_avail);
+
+      if (!skip_file_data)
+        visitor.on_entry_data(src_begin, src_begin + to_read);
+
+      src_begin += to_read;
+      file_bytes_read += to_read;
+      input_offset_ += to_read;
+
+      if (file_bytes_read == file_size_) {
+        visitor.on_entry_end(current_entry);
+        state = State::SkipPadding;
+      }
+      break;
+    }
+
+    case State::ReadExtension:
+      read_extension(src_begin, src_end);
+      break;
+
+    case State::SkipPadding: {
+      auto remaining = padding_bytes - padding_bytes_skipped;
+      auto src_avail = static_cast<std::size_t>(src_end - src_begin);
+      auto to_skip = std::min(remaining, src_avail);
+
+      src_begin += to_skip;
+      padding_bytes_skipped += to_skip;
+      input_offset_ += to_skip;
+
+      if (padding_bytes_skipped == padding_bytes)
+        state = State::ReadHeader;
+      break;
+    }
+
+    case State::Done:
+      return false;
+    }
+  }
+
+  return state != State::Done;
+}
+
+std::size_t BaseTarFilterImpl::pending_discard() const {
+  switch (state) {
+  case State::ReadFileData:
+    if (!skip_file_data)
+      return 0;
+    return file_size_ - file_bytes_read + padding_bytes - padding_bytes_skipped;
+  case State::SkipPadding:
+    return padding_bytes - padding_bytes_skipped;
+  default:
+    return 0;
+  }
+}
+
+/**
+ * @brief Advance the payload/padding counters exactly like visit() would for
+ * a declined entry, without a source buffer.
+ */
+void BaseTarFilterImpl::discard(std::size_t count, EntryVisitor &visitor) {
+  while (count > 0) {
+    if (state == State::ReadFileData) {
+      auto const to_skip = std::min(count, file_size_ - file_bytes_read);
+      file_bytes_read += to_skip;
+      input_offset_ += to_skip;
+      count -= to_skip;
+      if (file_bytes_read == file_size_) {
+        visitor.on_entry_end(current_entry);
+        state = State::SkipPadding;
+      }
+    } else if (state == State::SkipPadding) {
+      auto const to_skip =
+          std::min(count, padding_bytes - padding_bytes_skipped);
+      padding_bytes_skipped += to_skip;
+      input_offset_ += to_skip;
+      count -= to_skip;
+      if (padding_bytes_skipped == padding_bytes)
+        state = State::ReadHeader;
+    } else {
+      break;
+    }
+  }
+}
+
 /**
  * @brief Reset internal parser state so the filter can be reused.
  *
@@ -270,7 +722,18 @@ void BaseTarFilterImpl::close() {
   file_bytes_read = 0;
   padding_bytes_skipped = 0;
   file_size_ = 0;
+  skip_file_data = false;
+  volume_start_ = false;
+  continuation_pending_ = false;
+  input_offset_ = 0;
+  entry_offset_ = 0;
+  extension_offset_.reset();
+  extension_type_ = 0;
+  extension_data_.clear();
+  pending_ = Overrides{};
+  global_ = Overrides{};
   header_buffer.clear();
   current_file_name.clear();
+  current_entry = Entry{};
 }
 } // namespace boost_iostreams_tar_filter::detail
\ No newline at end of file
@@ -0,0 +1,194 @@
+#include <boost-iostreams-tar-filter/chunk-index.hxx>
+
+#include <algorithm>
+#include <array>
+
+namespace boost_iostreams_tar_filter {
+namespace {
+/**
+ * @brief Gear table: 256 pseudo-random 64-bit values (splitmix64), fixed so
+ * manifests are comparable across runs and machines.
+ */
+constexpr std::array<std::uint64_t, 256> make_gear_table_impl() {
+  std::array<std::uint64_t, 256> table{};
+  std::uint64_t state = 0x9e3779b97f4a7c15ull;
+  for (auto &value : table) {
+    state += 0x9e3779b97f4a7c15ull;
+    auto z = state;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    value = z ^ (z >> 31);
+  }
+  return table;
+}
+
+constexpr auto gear_table = make_gear_table_impl();
+
+/**
+ * @brief Mask with `bits` one bits spread over the high half of the hash,
+ * where the gear hash mixes best.
+ */
+std::uint64_t make_mask_impl(unsigned bits) {
+  std::uint64_t mask = 0;
+  for (unsigned i = 0; i < bits; ++i)
+    mask |= std::uint64_t(1) << (63 - 2 * i);
+  return mask;
+}
+
+unsigned log2_impl(std::size_t value) {
+  unsigned bits = 0;
+  while (value > 1) {
+    value >>= 1;
+    ++bits;
+  }
+  return bits;
+}
+
+/**
+ * @brief Merkle root of a list of leaf digests.
+ *
+ * Inner nodes are SHA-256(0x01 || left || right); an odd node is promoted
+ * unchanged. An empty list hashes to SHA-256 of the empty string.
+ */
+Digest merkle_root_impl(std::vector<Digest> level) {
+  if (level.empty())
+    return Sha256::digest("", 0);
+  while (level.size() > 1) {
+    std::vector<Digest> next;
+    for (std::size_t i = 0; i + 1 < level.size(); i += 2) {
+      Sha256 sha;
+      const std::uint8_t tag = 0x01;
+      sha.update(&tag, 1);
+      sha.update(level[i].data(), level[i].size());
+      sha.update(level[i + 1].data(), level[i + 1].size());
+      next.push_back(sha.finish());
+    }
+    if (level.size() % 2)
+      next.push_back(level.back());
+    level = std::move(next);
+  }
+  return level.front();
+}
+} // unnamed namespace
+
+std::vector<Digest> ChunkManifest::missing_chunks(
+    const std::unordered_set<Digest, DigestHash> &have) const {
+  std::vector<Digest> missing;
+  std::unordered_set<Digest, DigestHash> seen;
+  for (const auto &entry : entries)
+    for (const auto &chunk : entry.chunks)
+      if (!have.count(chunk.digest) && seen.insert(chunk.digest).second)
+        missing.push_back(chunk.digest);
+  return missing;
+}
+
+void ChunkManifest::write(std::ostream &out) const {
+  out << "archive " << to_hex(root) << '\n';
+  for (const auto &entry : entries) {
+    out << "entry " << to_hex(entry.root) << ' ' << entry.size << ' '
+        << entry.name << '\n';
+    for (const auto &chunk : entry.chunks)
+      out << "chunk " << to_hex(chunk.digest) << ' ' << chunk.offset << ' '
+          << chunk.size << '\n';
+  }
+}
+
+/**
+ * @brief Normalized chunking uses a stricter mask (two more bits) before the
+ * average size and a looser one (two fewer bits) after it, which narrows the
+ * chunk size distribution around avg_size.
+ */
+ChunkIndexBuilder::ChunkIndexBuilder(ChunkingOptions options)
+    : options_(options) {
+  options_.min_size = std::max<std::size_t>(options_.min_size, 64);
+  options_.max_size = std::max(options_.max_size, options_.min_size);
+  auto const bits = log2_impl(options_.avg_size);
+  mask_small_ = make_mask_impl(bits + 2);
+  mask_large_ = make_mask_impl(bits > 2 ? bits - 2 : 1);
+}
+
+bool ChunkIndexBuilder::on_entry_begin(const Entry &entry) {
+  if (!entry.is_regular_file())
+    return false;
+  manifest_.entries.push_back(ChunkedEntry{entry.name, entry.size, {}, {}});
+  hash_ = 0;
+  chunk_size_ = 0;
+  offset_ = 0;
+  return true;
+}
+
+/**
+ * @brief Scan the slice for cut points; bytes are fed to the chunk's
+ * SHA-256 in runs between cut points rather than one by one.
+ */
+void ChunkIndexBuilder::on_entry_data(const char *begin, const char *end) {
+  auto p = reinterpret_cast<const unsigned char *>(begin);
+  auto const stop = reinterpret_cast<const unsigned char *>(end);
+  auto run = p;
+  auto const skip_to = options_.min_size - 64;
+
+  while (p < stop) {
+    if (chunk_size_ < skip_to) {
+      auto const skip = std::min<std::size_t>(skip_to - chunk_size_,
+                                              static_cast<std::size_t>(stop - p));
+      p += skip;
+      chunk_size_ += skip;
+      continue;
+    }
+
+    hash_ = (hash_ << 1) + gear_table[*p++];
+    ++chunk_size_;
+    if (chunk_size_ < options_.min_size)
+      continue;
+    auto const mask =
+        chunk_size_ < options_.avg_size ? mask_small_ : mask_large_;
+    if ((hash_ & mask) == 0 || chunk_size_ >= options_.max_size) {
+      sha_.update(run, static_cast<std::size_t>(p - run));
+      run = p;
+      cut();
+    }
+  }
+  sha_.update(run, static_cast<std::size_t>(p - run));
+}
+
+void ChunkIndexBuilder::on_entry_end(const Entry &entry) {
+  if (!entry.is_regular_file())
+    return;
+  if (chunk_size_ > 0)
+    cut();
+
+  auto &chunked = manifest_.entries.back();
+  std::vector<Digest> leaves;
+  leaves.reserve(chunked.chunks.size());
+  for (const auto &chunk : chunked.chunks)
+    leaves.push_back(chunk.digest);
+  chunked.root = merkle_root_impl(std::move(leaves));
+}
+
+/**
+ * @brief Archive root: Merkle tree over SHA-256(0x00 || name || 0x00 ||
+ * entry root) leaves, so renames change the root but not the chunks.
+ */
+ChunkManifest ChunkIndexBuilder::finish() {
+  std::vector<Digest> leaves;
+  for (const auto &entry : manifest_.entries) {
+    Sha256 sha;
+    const std::uint8_t tag = 0x00;
+    sha.update(&tag, 1);
+    sha.update(entry.name.data(), entry.name.size());
+    sha.update(&tag, 1);
+    sha.update(entry.root.data(), entry.root.size());
+    leaves.push_back(sha.finish());
+  }
+  manifest_.root = merkle_root_impl(std::move(leaves));
+  return std::move(manifest_);
+}
+
+void ChunkIndexBuilder::cut() {
+  manifest_.entries.back().chunks.push_back(
+      ContentChunk{offset_, chunk_size_, sha_.finish()});
+  offset_ += chunk_size_;
+  chunk_size_ = 0;
+  hash_ = 0;
+}
+} // namespace boost_iostreams_tar_filter
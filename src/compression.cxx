@@ -0,0 +1,101 @@
+#include <boost-iostreams-tar-filter/compression.hxx>
+#include <boost-iostreams-tar-filter/gzip-decompressor.hxx>
+#include <boost-iostreams-tar-filter/parallel-bzip2-decompressor.hxx>
+#ifdef BOOST_IOSTREAMS_TAR_FILTER_HAVE_LZ4
+#include <boost-iostreams-tar-filter/lz4-frame-decompressor.hxx>
+#endif
+
+#include <boost/iostreams/filter/lzma.hpp>
+#include <boost/iostreams/filter/zstd.hpp>
+
+#include <stdexcept>
+
+namespace boost_iostreams_tar_filter {
+namespace {
+bool ends_with_impl(std::string_view name, std::string_view suffix) {
+  return name.size() >= suffix.size() &&
+         name.substr(name.size() - suffix.size()) == suffix;
+}
+} // unnamed namespace
+
+Compression compression_from_name(std::string_view name) {
+  struct Suffix {
+    std::string_view suffix;
+    Compression compression;
+  };
+  static constexpr Suffix suffixes[] = {
+      {".gz", Compression::Gzip},   {".tgz", Compression::Gzip},
+      {".bz2", Compression::Bzip2}, {".tbz2", Compression::Bzip2},
+      {".tbz", Compression::Bzip2}, {".xz", Compression::Xz},
+      {".txz", Compression::Xz},    {".zst", Compression::Zstd},
+      {".tzst", Compression::Zstd}, {".lz4", Compression::Lz4},
+  };
+  for (const auto &[suffix, compression] : suffixes)
+    if (ends_with_impl(name, suffix))
+      return compression;
+  return Compression::None;
+}
+
+Compression compression_from_magic(std::string_view head) {
+  struct Magic {
+    std::string_view magic;
+    Compression compression;
+  };
+  static constexpr Magic magics[] = {
+      {{"\x1f\x8b", 2}, Compression::Gzip},
+      {{"BZh", 3}, Compression::Bzip2},
+      {{"\xfd" "7zXZ\0", 6}, Compression::Xz},
+      {{"\x28\xb5\x2f\xfd", 4}, Compression::Zstd},
+      {{"\x04\x22\x4d\x18", 4}, Compression::Lz4},
+  };
+  for (const auto &[magic, compression] : magics)
+    if (head.substr(0, magic.size()) == magic)
+      return compression;
+  return Compression::None;
+}
+
+void push_decompressor(boost::iostreams::filtering_istream &in,
+                       Compression compression) {
+  switch (compression) {
+  case Compression::None:
+    return;
+  case Compression::Gzip:
+    in.push(GzipDecompressor<>());
+    return;
+  case Compression::Bzip2:
+    in.push(ParallelBzip2Decompressor<>());
+    return;
+  case Compression::Xz:
+    in.push(boost::iostreams::lzma_decompressor());
+    return;
+  case Compression::Zstd:
+    in.push(boost::iostreams::zstd_decompressor());
+    return;
+  case Compression::Lz4:
+#ifdef BOOST_IOSTREAMS_TAR_FILTER_HAVE_LZ4
+    in.push(Lz4FrameDecompressor<>());
+    return;
+#else
+    throw std::invalid_argument("LZ4 support not built");
+#endif
+  }
+}
+
+const char *to_string(Compression compression) {
+  switch (compression) {
+  case Compression::None:
+    return "none";
+  case Compression::Gzip:
+    return "gzip";
+  case Compression::Bzip2:
+    return "bzip2";
+  case Compression::Xz:
+    return "xz";
+  case Compression::Zstd:
+    return "zstd";
+  case Compression::Lz4:
+    return "lz4";
+  }
+  return "unknown";
+}
+} // namespace boost_iostreams_tar_filter
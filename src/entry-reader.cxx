@@ -0,0 +1,186 @@
+#include <boost-iostreams-tar-filter/detail/gzip-inflater.hxx>
+#include <boost-iostreams-tar-filter/detail/tar-headers.hxx>
+#include <boost-iostreams-tar-filter/detail/visit-loop.hxx>
+#include <boost-iostreams-tar-filter/entry-reader.hxx>
+
+#include <algorithm>
+#include <cerrno>
+#include <fcntl.h>
+#include <ios>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <unistd.h>
+
+namespace boost_iostreams_tar_filter {
+namespace {
+void check_capacity_impl(const Entry &entry, std::span<std::byte> out) {
+  if (out.size() < entry.size)
+    throw std::invalid_argument("buffer of " + std::to_string(out.size()) +
+                                " bytes too small for " + entry.name + " (" +
+                                std::to_string(entry.size) + " bytes)");
+}
+
+
+/**
+ * @brief Skip count bytes of a stream, by seeking when it supports it.
+ */
+bool skip_impl(std::istream &in, std::uint64_t count, bool seekable) {
+  if (seekable)
+    return in.rdbuf()->pubseekoff(static_cast<std::streamoff>(count),
+                                  std::ios_base::cur,
+                                  std::ios_base::in) != std::streampos(-1);
+  while (count > 0) {
+    auto const chunk = std::min<std::uint64_t>(
+        count, std::numeric_limits<std::streamsize>::max());
+    in.ignore(static_cast<std::streamsize>(chunk));
+    if (static_cast<std::uint64_t>(in.gcount()) != chunk)
+      return false;
+    count -= chunk;
+  }
+  return true;
+}
+
+/**
+ * @brief Inflate exactly size bytes unless the stream ends first; reads
+ * stop short at gzip member boundaries.
+ */
+std::size_t inflate_full_impl(detail::GzipInflater &inflater, char *out,
+                              std::size_t size) {
+  std::size_t filled = 0;
+  while (filled < size) {
+    auto const count = inflater.read(out + filled, size - filled);
+    if (count == 0)
+      break;
+    filled += count;
+  }
+  return filled;
+}
+} // unnamed namespace
+
+std::optional<Entry> read_entry_into(const std::filesystem::path &archive,
+                                     const std::string &name,
+                                     std::span<std::byte> out) {
+  auto const fd = ::open(archive.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    throw std::system_error(errno, std::generic_category(),
+                            "cannot open " + archive.string());
+  struct Closer {
+    int fd;
+    ~Closer() { ::close(fd); }
+  } closer{fd};
+
+  // The last entry of the path decides, as in extraction.
+  std::optional<Entry> found;
+  std::uint64_t found_offset = 0;
+  detail::walk_tar_headers(
+      fd, archive.string(),
+      [&](const Entry &entry, std::uint64_t payload_offset) {
+        if (entry.name == name) {
+          found.reset();
+          if (entry.is_regular_file()) {
+            found = entry;
+            found_offset = payload_offset;
+          }
+        }
+        return true;
+      });
+  if (!found)
+    return std::nullopt;
+
+  check_capacity_impl(*found, out);
+  for (std::size_t filled = 0; filled < found->size;) {
+    auto const count =
+        ::pread(fd, out.data() + filled, found->size - filled,
+                static_cast<off_t>(found_offset + filled));
+    if (count < 0) {
+      if (errno == EINTR)
+        continue;
+      throw std::system_error(errno, std::generic_category(),
+                              "read " + archive.string());
+    }
+    if (count == 0)
+      throw std::ios_base::failure("tar payload extends past end of " +
+                                   archive.string());
+    filled += static_cast<std::size_t>(count);
+  }
+  return found;
+}
+
+/**
+ * @brief The stream cannot be rewound, so every copy of the path that fits
+ * is read into out as it streams by and the last one is kept.
+ */
+
+std::optional<Entry> read_entry_into(std::istream &in, const std::string &name,
+                                     std::span<std::byte> out) {
+  auto const seekable = detail::is_seekable(in);
+  char header[512];
+  detail::TarHeaderParser parser;
+  std::optional<Entry> found;
+  while (in.read(header, sizeof(header)) && parser.feed(header)) {
+    auto skip = parser.skip_payload();
+    if (const auto *entry = parser.entry(); entry && entry->name == name) {
+      found.reset();
+      if (entry->is_regular_file())
+        found = *entry;
+      if (found && found->size <= out.size()) {
+        if (!in.read(reinterpret_cast<char *>(out.data()),
+                     static_cast<std::streamsize>(found->size)))
+          throw std::ios_base::failure(
+              "tar payload extends past end of stream");
+        skip -= found->size;
+      }
+    }
+    if (!skip_impl(in, skip, seekable))
+      break;
+  }
+  if (found)
+    check_capacity_impl(*found, out);
+  return found;
+}
+
+/**
+ * @brief The header, and the extension records before it, are inflated
+ * block by block to decode the full Entry; the payload behind it is
+ * inflated into out.
+ */
+std::optional<Entry> read_entry_into(const GzipIndex &index,
+                                     std::istream &compressed,
+                                     const std::string &name,
+                                     std::span<std::byte> out) {
+  auto const indexed = std::find_if(
+      index.entries.rbegin(), index.entries.rend(),
+      [&](const IndexedEntry &entry) { return entry.name == name; });
+  if (indexed == index.entries.rend() ||
+      (indexed->type != Entry::RegularFile && indexed->type != '\0'))
+    return std::nullopt;
+
+  const auto &checkpoint = index.checkpoint_for(indexed->header_offset);
+  detail::GzipInflater inflater(compressed, checkpoint);
+  auto const lead = indexed->header_offset - checkpoint.uncompressed_offset;
+  char header[512];
+  detail::TarHeaderParser parser;
+  auto const mismatch = [&] {
+    return std::ios_base::failure("gzip stream does not match its index at " +
+                                  name);
+  };
+  if (inflater.discard(lead) != lead)
+    throw mismatch();
+  while (!parser.entry())
+    if (inflate_full_impl(inflater, header, sizeof(header)) !=
+            sizeof(header) ||
+        !parser.feed(header))
+      throw mismatch();
+  auto const entry = *parser.entry();
+  if (entry.name != name || !entry.is_regular_file())
+    throw mismatch();
+
+  check_capacity_impl(entry, out);
+  if (inflate_full_impl(inflater, reinterpret_cast<char *>(out.data()),
+                        entry.size) != entry.size)
+    throw std::ios_base::failure("tar payload extends past end of stream");
+  return entry;
+}
+} // namespace boost_iostreams_tar_filter
@@ -0,0 +1,427 @@
+#include <boost-iostreams-tar-filter/detail/sanitize-path.hxx>
+#include <boost-iostreams-tar-filter/extraction-sink.hxx>
+#include <boost-iostreams-tar-filter/tar-reader.hxx>
+
+#include <cerrno>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+
+namespace boost_iostreams_tar_filter {
+namespace {
+/**
+ * @brief Upper bound on cached directory fds before the cache is flushed.
+ */
+constexpr std::size_t max_cached_directories = 256;
+
+/**
+ * @brief Throw std::system_error for the current errno.
+ */
+[[noreturn]] void throw_errno_impl(const std::string &what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+/**
+ * @brief write() the whole buffer, retrying on short writes and EINTR.
+ */
+void write_all_impl(int fd, const char *data, std::size_t size) {
+  while (size > 0) {
+    auto const written = ::write(fd, data, size);
+    if (written < 0) {
+      if (errno == EINTR)
+        continue;
+      throw_errno_impl("write");
+    }
+    data += written;
+    size -= static_cast<std::size_t>(written);
+  }
+}
+
+/**
+ * @brief Replace whatever sits at base with a new, empty regular file.
+ *
+ * The old name is unlinked first rather than truncated, so a symlink left
+ * there by an earlier entry is never followed and a hard link to it keeps
+ * its contents.
+ */
+int create_file_impl(int dir_fd, const std::string &base, mode_t mode) {
+  ::unlinkat(dir_fd, base.c_str(), 0);
+  return ::openat(dir_fd, base.c_str(),
+                  O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, mode);
+}
+} // unnamed namespace
+
+// -----------------------------
+// ExtractionVisitor
+// -----------------------------
+
+bool ExtractionVisitor::on_entry_begin(const Entry &entry) {
+  entries_.push_back(entry);
+  items_.push_back(ExtractionItem{&entries_.back(), 0, {}, true, false});
+  offset_ = 0;
+  in_entry_ = true;
+  item_open_ = true;
+  return true;
+}
+
+/**
+ * @brief Extend the entry's item for this batch; consecutive slices of one
+ * buffer are contiguous, so a single span covers them all.
+ */
+void ExtractionVisitor::on_entry_data(const char *begin, const char *end) {
+  auto &item = current_item();
+  if (item.data.empty())
+    item.data = std::span<const char>(begin, end);
+  else
+    item.data = std::span<const char>(item.data.data(), end);
+  offset_ += static_cast<std::size_t>(end - begin);
+}
+
+void ExtractionVisitor::on_entry_end(const Entry &) {
+  current_item().ends_entry = true;
+  in_entry_ = false;
+  item_open_ = false;
+}
+
+/**
+ * @brief Flush the batch before the input buffer is reused. An entry still
+ * in progress is carried into the next batch.
+ */
+void ExtractionVisitor::on_buffer_end() {
+  if (!items_.empty())
+    sink_.consume(items_);
+  items_.clear();
+  item_open_ = false;
+
+  if (in_entry_) {
+    auto entry = std::move(entries_.back());
+    entries_.clear();
+    entries_.push_back(std::move(entry));
+  } else {
+    entries_.clear();
+  }
+}
+
+/**
+ * @brief Item of the current entry in this batch, opened on demand when the
+ * entry continues from the previous batch.
+ */
+ExtractionItem &ExtractionVisitor::current_item() {
+  if (!item_open_) {
+    items_.push_back(
+        ExtractionItem{&entries_.back(), offset_, {}, false, false});
+    item_open_ = true;
+  }
+  return items_.back();
+}
+
+bool extract_tar(std::istream &in, ExtractionSink &sink,
+                 std::size_t buffer_size) {
+  ExtractionVisitor visitor(sink);
+  auto const done = visit_tar(in, visitor, buffer_size);
+  sink.finish();
+  return done;
+}
+
+// -----------------------------
+// MemorySink
+// -----------------------------
+
+void MemorySink::consume(std::span<const ExtractionItem> batch) {
+  for (const auto &item : batch) {
+    if (item.begins_entry) {
+      // A later entry of the same path replaces the earlier one, like on
+      // disk. The header size is not trusted for a reservation.
+      entries_.push_back(*item.entry);
+      if (item.entry->is_regular_file())
+        files_[item.entry->name].clear();
+      else
+        files_.erase(item.entry->name);
+    }
+    if (!item.data.empty())
+      files_[item.entry->name].append(item.data.begin(), item.data.end());
+  }
+}
+
+// -----------------------------
+// FilesystemSink
+// -----------------------------
+
+FilesystemSink::FilesystemSink(const std::filesystem::path &root,
+                               FilesystemSinkOptions options)
+    : options_(options) {
+  std::filesystem::create_directories(root);
+  root_fd_ = ::open(root.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (root_fd_ < 0)
+    throw_errno_impl("open " + root.string());
+}
+
+FilesystemSink::~FilesystemSink() {
+  if (file_fd_ >= 0)
+    ::close(file_fd_);
+  close_directories();
+  if (root_fd_ >= 0)
+    ::close(root_fd_);
+}
+
+/**
+ * @brief Write a batch.
+ *
+ * With skip_unchanged, every regular file starting in the batch is stat'ed
+ * up front, so the lookups for a batch run back to back against warm
+ * directory fds. Unchanged files take the skip path: nothing is opened or
+ * written for them, including in later batches their payload spills into.
+ */
+void FilesystemSink::consume(std::span<const ExtractionItem> batch) {
+  if (options_.skip_unchanged) {
+    unchanged_.assign(batch.size(), 0);
+    for (std::size_t i = 0; i < batch.size(); ++i)
+      if (batch[i].begins_entry && batch[i].entry->is_regular_file())
+        unchanged_[i] = is_unchanged(*batch[i].entry);
+  }
+
+  for (std::size_t i = 0; i < batch.size(); ++i) {
+    const auto &item = batch[i];
+    if (item.begins_entry) {
+      skipping_ = options_.skip_unchanged && unchanged_[i];
+      if (skipping_)
+        ++skipped_;
+      else
+        begin_entry(*item.entry);
+    }
+    if (skipping_) {
+      skipping_ = !item.ends_entry;
+      continue;
+    }
+    if (!item.data.empty())
+      write_data(item.data);
+    if (item.ends_entry)
+      end_entry(*item.entry);
+  }
+}
+
+void FilesystemSink::finish() { close_directories(); }
+
+std::pair<std::string, std::string>
+FilesystemSink::split_path(const std::string &name) {
+  auto path = detail::sanitize_path(name);
+  auto const slash = path.rfind('/');
+  if (slash == std::string::npos)
+    return {std::string(), path};
+  return {path.substr(0, slash), path.substr(slash + 1)};
+}
+
+/**
+ * @brief Resolve (and create) a directory relative to the root, one
+ * component at a time, caching every fd on the way.
+ *
+ * Every component is opened with O_NOFOLLOW, so a symlink planted by an
+ * earlier entry fails the lookup with ELOOP instead of leading out of the
+ * root.
+ */
+int FilesystemSink::directory_fd(const std::string &dir) {
+  if (dir.empty())
+    return root_fd_;
+  if (auto it = directories_.find(dir); it != directories_.end())
+    return it->second;
+
+  auto const slash = dir.rfind('/');
+  auto const parent = slash == std::string::npos ? std::string()
+                                                 : dir.substr(0, slash);
+  auto const base = slash == std::string::npos ? dir : dir.substr(slash + 1);
+  auto const parent_fd = directory_fd(parent);
+
+  if (::mkdirat(parent_fd, base.c_str(), 0755) < 0 && errno != EEXIST)
+    throw_errno_impl("mkdir " + dir);
+  auto const fd = ::openat(parent_fd, base.c_str(),
+                           O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+  if (fd < 0)
+    throw_errno_impl("open " + dir);
+
+  directories_.emplace(dir, fd);
+  return fd;
+}
+
+void FilesystemSink::begin_entry(const Entry &entry) {
+  // Trim the cache between entries, never while fds of it are in use.
+  if (directories_.size() >= max_cached_directories)
+    close_directories();
+
+  auto const [dir, base] = split_path(entry.name);
+  if (base.empty())
+    return;
+
+  if (entry.is_directory()) {
+    directory_fd(dir.empty() ? base : dir + '/' + base);
+    return;
+  }
+  if (options_.deduplicate)
+    forget_first_copy(dir.empty() ? base : dir + '/' + base);
+
+  auto const dir_fd = directory_fd(dir);
+  if (entry.is_symlink()) {
+    ::unlinkat(dir_fd, base.c_str(), 0);
+    if (::symlinkat(entry.link_name.c_str(), dir_fd, base.c_str()) < 0)
+      throw_errno_impl("symlink " + entry.name);
+  } else if (entry.is_hard_link()) {
+    auto const [target_dir, target_base] = split_path(entry.link_name);
+    auto const target_fd = directory_fd(target_dir);
+    ::unlinkat(dir_fd, base.c_str(), 0);
+    if (::linkat(target_fd, target_base.c_str(), dir_fd, base.c_str(), 0) < 0)
+      throw_errno_impl("link " + entry.name);
+  } else if (entry.is_regular_file()) {
+    regular_ = true;
+    hashing_ = options_.deduplicate || options_.record_digests;
+    buffering_ = options_.deduplicate && entry.size <= options_.dedup_buffer_limit;
+    if (buffering_)
+      pending_.clear();
+    else
+      open_file(entry);
+  }
+}
+
+void FilesystemSink::write_data(std::span<const char> data) {
+  if (hashing_)
+    hasher_.update(data.data(), data.size());
+  if (buffering_)
+    pending_.append(data.begin(), data.end());
+  else if (file_fd_ >= 0)
+    write_all_impl(file_fd_, data.data(), data.size());
+}
+
+/**
+ * @brief Finish a regular file: resolve buffered duplicates to links, or
+ * write and close the file and remember it as the first copy of its
+ * contents.
+ */
+void FilesystemSink::end_entry(const Entry &entry) {
+  if (!regular_)
+    return;
+  regular_ = false;
+
+  if (!hashing_) {
+    close_file(entry);
+    return;
+  }
+  hashing_ = false;
+  auto const digest = hasher_.finish();
+  auto path = detail::sanitize_path(entry.name);
+  if (options_.record_digests)
+    digests_[path] = digest;
+
+  if (buffering_) {
+    buffering_ = false;
+    if (auto it = first_copies_.find(digest);
+        it != first_copies_.end() && link_duplicate(it->second, entry)) {
+      ++linked_;
+      return;
+    }
+    open_file(entry);
+    write_all_impl(file_fd_, pending_.data(), pending_.size());
+  }
+  close_file(entry);
+
+  if (options_.deduplicate && first_copies_.try_emplace(digest, path).second)
+    first_copy_digests_.emplace(std::move(path), digest);
+}
+
+/**
+ * @brief The entry about to be written replaces path, so later duplicates
+ * must not be linked to it.
+ */
+void FilesystemSink::forget_first_copy(const std::string &path) {
+  auto const it = first_copy_digests_.find(path);
+  if (it == first_copy_digests_.end())
+    return;
+  first_copies_.erase(it->second);
+  first_copy_digests_.erase(it);
+}
+
+void FilesystemSink::open_file(const Entry &entry) {
+  auto const [dir, base] = split_path(entry.name);
+  file_fd_ = create_file_impl(directory_fd(dir), base,
+                              static_cast<mode_t>(entry.mode & 07777));
+  if (file_fd_ < 0)
+    throw_errno_impl("open " + entry.name);
+}
+
+void FilesystemSink::close_file(const Entry &entry) {
+  if (file_fd_ < 0)
+    return;
+  auto const fd = file_fd_;
+  file_fd_ = -1;
+
+  const struct timespec times[2] = {{0, UTIME_OMIT},
+                                    {static_cast<time_t>(entry.mtime), 0}};
+  auto const timed = ::futimens(fd, times);
+  auto const saved_errno = errno;
+  if (::close(fd) < 0)
+    throw_errno_impl("close " + entry.name);
+  if (timed < 0) {
+    errno = saved_errno;
+    throw_errno_impl("futimens " + entry.name);
+  }
+}
+
+/**
+ * @brief Hard link or reflink entry to first_path.
+ *
+ * A hard-linked duplicate shares the first copy's inode, including its mode
+ * and mtime. A reflinked duplicate is a separate inode and gets its own.
+ */
+bool FilesystemSink::link_duplicate(const std::string &first_path,
+                                    const Entry &entry) {
+  auto const path = detail::sanitize_path(entry.name);
+  if (path == first_path)
+    return false;
+  auto const [first_dir, first_base] = split_path(first_path);
+  auto const [dir, base] = split_path(path);
+  auto const first_fd = directory_fd(first_dir);
+  auto const dir_fd = directory_fd(dir);
+
+  if (options_.dedup_link == DedupLink::HardLink) {
+    ::unlinkat(dir_fd, base.c_str(), 0);
+    return ::linkat(first_fd, first_base.c_str(), dir_fd, base.c_str(), 0) ==
+           0;
+  }
+
+  auto const source = ::openat(first_fd, first_base.c_str(),
+                               O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+  if (source < 0)
+    return false;
+  file_fd_ =
+      create_file_impl(dir_fd, base, static_cast<mode_t>(entry.mode & 07777));
+  auto const cloned = file_fd_ >= 0 && ::ioctl(file_fd_, FICLONE, source) == 0;
+  ::close(source);
+  if (!cloned) {
+    if (file_fd_ >= 0)
+      ::close(file_fd_);
+    file_fd_ = -1;
+    return false;
+  }
+  close_file(entry);
+  return true;
+}
+
+bool FilesystemSink::is_unchanged(const Entry &entry) {
+  auto const [dir, base] = split_path(entry.name);
+  if (base.empty())
+    return false;
+  struct stat st;
+  if (::fstatat(directory_fd(dir), base.c_str(), &st, AT_SYMLINK_NOFOLLOW) < 0)
+    return false;
+  return S_ISREG(st.st_mode) &&
+         static_cast<std::size_t>(st.st_size) == entry.size &&
+         st.st_mtim.tv_sec == entry.mtime;
+}
+
+void FilesystemSink::close_directories() {
+  for (auto &[dir, fd] : directories_)
+    ::close(fd);
+  directories_.clear();
+}
+} // namespace boost_iostreams_tar_filter
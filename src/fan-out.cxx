@@ -0,0 +1,108 @@
+#include <boost-iostreams-tar-filter/detail/base-tar-filter-impl.hxx>
+#include <boost-iostreams-tar-filter/detail/bounded-queue.hxx>
+#include <boost-iostreams-tar-filter/fan-out.hxx>
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace boost_iostreams_tar_filter {
+namespace {
+/** @brief A shared, immutable slice of the input stream. */
+struct Chunk {
+  std::shared_ptr<std::vector<char>> buffer;
+  std::size_t size = 0;
+};
+} // unnamed namespace
+
+FanOut::FanOut(std::size_t buffer_size, std::size_t queue_depth)
+    : buffer_size_(buffer_size), queue_depth_(queue_depth) {}
+
+void FanOut::add_consumer(RawConsumer consumer) {
+  consumers_.push_back(std::move(consumer));
+}
+
+void FanOut::add_consumer(EntryVisitor &visitor) {
+  auto impl = std::make_shared<detail::BaseTarFilterImpl>();
+  consumers_.push_back([impl, &visitor](const char *begin, const char *end) {
+    if (impl->state == detail::BaseTarFilterImpl::State::Done)
+      return;
+    impl->visit(begin, end, visitor);
+    visitor.on_buffer_end();
+  });
+}
+
+/**
+ * @brief Broadcast loop.
+ *
+ * Read buffers are recycled once no consumer references them any more, so
+ * steady-state memory is bounded by the queue depth times the number of
+ * consumers.
+ */
+void FanOut::run(std::istream &in) {
+  std::vector<std::unique_ptr<detail::BoundedQueue<Chunk>>> queues;
+  std::vector<std::thread> threads;
+  std::mutex error_mutex;
+  std::exception_ptr error;
+
+  for (auto &consumer : consumers_) {
+    queues.push_back(std::make_unique<detail::BoundedQueue<Chunk>>(queue_depth_));
+    threads.emplace_back([&, queue = queues.back().get()] {
+      bool failed = false;
+      while (auto chunk = queue->pop()) {
+        if (failed)
+          continue;
+        try {
+          const char *data = chunk->buffer->data();
+          consumer(data, data + chunk->size);
+        } catch (...) {
+          std::lock_guard<std::mutex> lock(error_mutex);
+          if (!error)
+            error = std::current_exception();
+          failed = true;
+        }
+      }
+    });
+  }
+
+  std::vector<std::shared_ptr<std::vector<char>>> buffers;
+  auto acquire = [&] {
+    for (auto &buffer : buffers)
+      if (buffer.use_count() == 1) {
+        // Pairs with the release decrement of the last consumer's reference.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return buffer;
+      }
+    buffers.push_back(std::make_shared<std::vector<char>>(buffer_size_));
+    return buffers.back();
+  };
+
+  try {
+    for (;;) {
+      auto buffer = acquire();
+      in.read(buffer->data(), static_cast<std::streamsize>(buffer->size()));
+      auto const count = static_cast<std::size_t>(in.gcount());
+      if (count == 0)
+        break;
+      for (auto &queue : queues)
+        queue->push(Chunk{buffer, count});
+    }
+  } catch (...) {
+    for (auto &queue : queues)
+      queue->close();
+    for (auto &thread : threads)
+      thread.join();
+    throw;
+  }
+
+  for (auto &queue : queues)
+    queue->close();
+  for (auto &thread : threads)
+    thread.join();
+  if (error)
+    std::rethrow_exception(error);
+}
+} // namespace boost_iostreams_tar_filter
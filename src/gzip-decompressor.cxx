@@ -0,0 +1,147 @@
+#include <boost-iostreams-tar-filter/detail/gzip-decompressor-impl.hxx>
+#include <boost-iostreams-tar-filter/detail/gzip-inflater.hxx>
+#include <boost-iostreams-tar-filter/detail/inflater.hxx>
+
+#include <ios>
+#include <stdexcept>
+#include <string>
+#include <zlib.h>
+
+namespace boost_iostreams_tar_filter {
+namespace {
+/**
+ * @brief Streaming inflate through the zlib API; also serves zlib-ng built in
+ * zlib-compat mode.
+ */
+class ZlibInflater final : public detail::Inflater {
+public:
+  ZlibInflater() {
+    if (inflateInit2(&stream_, 47) != Z_OK)
+      throw std::ios_base::failure("inflateInit2 failed");
+  }
+  ~ZlibInflater() override { inflateEnd(&stream_); }
+
+  bool inflate(const char *&src_begin, const char *src_end, char *&dest_begin,
+               const char *dest_end, bool flush) override {
+    // symmetric_filter drops input left unconsumed while output space
+    // remains, so the next member must be started within the same call.
+    for (;;) {
+      if (member_ended_) {
+        // Another member may follow; only the end of the source tells.
+        if (src_begin == src_end)
+          return !flush;
+        inflateReset(&stream_);
+        member_ended_ = false;
+      }
+
+      stream_.next_in =
+          reinterpret_cast<Bytef *>(const_cast<char *>(src_begin));
+      stream_.avail_in = static_cast<uInt>(src_end - src_begin);
+      stream_.next_out = reinterpret_cast<Bytef *>(dest_begin);
+      stream_.avail_out = static_cast<uInt>(dest_end - dest_begin);
+
+      auto const ret = ::inflate(&stream_, Z_NO_FLUSH);
+      src_begin = reinterpret_cast<const char *>(stream_.next_in);
+      dest_begin = reinterpret_cast<char *>(stream_.next_out);
+
+      if (ret == Z_STREAM_END) {
+        member_ended_ = true;
+        continue;
+      }
+      if (ret == Z_BUF_ERROR && flush && src_begin == src_end &&
+          dest_begin != dest_end)
+        throw std::ios_base::failure("truncated gzip stream");
+      if (ret != Z_OK && ret != Z_BUF_ERROR)
+        detail::throw_zlib_error(stream_, ret);
+      return true;
+    }
+  }
+
+  void reset() override {
+    inflateReset(&stream_);
+    member_ended_ = false;
+  }
+
+private:
+  z_stream stream_{};
+  bool member_ended_ = false;
+};
+} // unnamed namespace
+
+InflateEngine default_inflate_engine() {
+#if defined(BOOST_IOSTREAMS_TAR_FILTER_DEFAULT_ENGINE_ZLIB_NG)
+  return InflateEngine::ZlibNg;
+#elif defined(BOOST_IOSTREAMS_TAR_FILTER_DEFAULT_ENGINE_ISAL)
+  return InflateEngine::Isal;
+#else
+  return InflateEngine::Zlib;
+#endif
+}
+
+std::vector<InflateEngine> available_inflate_engines() {
+  return {
+      InflateEngine::Zlib,
+#ifdef BOOST_IOSTREAMS_TAR_FILTER_HAVE_ZLIB_NG
+      InflateEngine::ZlibNg,
+#endif
+#ifdef BOOST_IOSTREAMS_TAR_FILTER_HAVE_LIBDEFLATE
+      InflateEngine::Libdeflate,
+#endif
+#ifdef BOOST_IOSTREAMS_TAR_FILTER_HAVE_ISAL
+      InflateEngine::Isal,
+#endif
+  };
+}
+
+const char *to_string(InflateEngine engine) {
+  switch (engine) {
+  case InflateEngine::Zlib:
+    return "zlib";
+  case InflateEngine::ZlibNg:
+    return "zlib-ng";
+  case InflateEngine::Libdeflate:
+    return "libdeflate";
+  case InflateEngine::Isal:
+    return "isal";
+  }
+  return "unknown";
+}
+
+namespace detail {
+std::unique_ptr<Inflater> make_inflater(InflateEngine engine) {
+  switch (engine) {
+  case InflateEngine::Zlib:
+    return std::make_unique<ZlibInflater>();
+#ifdef BOOST_IOSTREAMS_TAR_FILTER_HAVE_ZLIB_NG
+  case InflateEngine::ZlibNg:
+    return make_zlib_ng_inflater();
+#endif
+#ifdef BOOST_IOSTREAMS_TAR_FILTER_HAVE_LIBDEFLATE
+  case InflateEngine::Libdeflate:
+    return make_libdeflate_inflater();
+#endif
+#ifdef BOOST_IOSTREAMS_TAR_FILTER_HAVE_ISAL
+  case InflateEngine::Isal:
+    return make_isal_inflater();
+#endif
+  default:
+    throw std::invalid_argument(std::string("inflate engine not built: ") +
+                                to_string(engine));
+  }
+}
+
+BaseGzipDecompressorImpl::BaseGzipDecompressorImpl(InflateEngine engine)
+    : inflater_(make_inflater(engine)) {}
+
+BaseGzipDecompressorImpl::~BaseGzipDecompressorImpl() = default;
+
+bool BaseGzipDecompressorImpl::filter(const char *&src_begin,
+                                      const char *const src_end,
+                                      char *&dest_begin,
+                                      const char *const dest_end, bool flush) {
+  return inflater_->inflate(src_begin, src_end, dest_begin, dest_end, flush);
+}
+
+void BaseGzipDecompressorImpl::close() { inflater_->reset(); }
+} // namespace detail
+} // namespace boost_iostreams_tar_filter
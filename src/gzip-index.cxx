@@ -0,0 +1,392 @@
+#include <boost-iostreams-tar-filter/detail/base-tar-filter-impl.hxx>
+#include <boost-iostreams-tar-filter/detail/gzip-inflater.hxx>
+#include <boost-iostreams-tar-filter/detail/worker-pool.hxx>
+#include <boost-iostreams-tar-filter/gzip-index.hxx>
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <ios>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+namespace boost_iostreams_tar_filter {
+namespace {
+/** @brief Size of the deflate dictionary. */
+constexpr std::size_t window_size = 32768;
+
+/** @brief Magic prefix of serialized indexes. */
+constexpr char index_magic[8] = {'T', 'F', 'G', 'Z', 'I', 'X', '0', '1'};
+
+template <typename T> void write_pod_impl(std::ostream &out, const T &value) {
+  out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+template <typename T> T read_pod_impl(std::istream &in) {
+  T value{};
+  if (!in.read(reinterpret_cast<char *>(&value), sizeof(value)))
+    throw std::ios_base::failure("truncated gzip index");
+  return value;
+}
+
+/**
+ * @brief Visitor recording where every entry header sits, skipping all
+ * payloads.
+ *
+ * The parser hides pax and GNU extension records, so the offset comes from
+ * the parser itself rather than from the sizes of the reported entries.
+ */
+class IndexVisitor : public EntryVisitor {
+public:
+  IndexVisitor(const detail::BaseTarFilterImpl &impl,
+               std::vector<IndexedEntry> &entries)
+      : impl_(impl), entries_(entries) {}
+
+  bool on_entry_begin(const Entry &entry) override {
+    entries_.push_back(IndexedEntry{entry.name, impl_.entry_offset(),
+                                    entry.size, entry.type});
+    return false;
+  }
+  void on_entry_data(const char *, const char *) override {}
+  void on_entry_end(const Entry &) override {}
+
+private:
+  const detail::BaseTarFilterImpl &impl_;
+  std::vector<IndexedEntry> &entries_;
+};
+} // unnamed namespace
+
+/**
+ * @brief Single pass: inflate with Z_BLOCK to stop at every deflate block
+ * boundary, record a checkpoint whenever enough output has accumulated since
+ * the previous one, and feed the output to the TAR parser to locate entries.
+ *
+ * Output is inflated into a circular 32 KiB window, which doubles as the
+ * dictionary saved with each checkpoint.
+ */
+GzipIndex GzipIndex::build(std::istream &in, std::uint64_t spacing) {
+  GzipIndex index;
+  index.checkpoints.push_back(GzipCheckpoint{});
+
+  z_stream stream{};
+  if (inflateInit2(&stream, 47) != Z_OK)
+    throw std::ios_base::failure("inflateInit2 failed");
+  struct Guard {
+    z_stream &stream;
+    ~Guard() { inflateEnd(&stream); }
+  } guard{stream};
+
+  detail::BaseTarFilterImpl impl;
+  IndexVisitor visitor(impl, index.entries);
+  std::vector<unsigned char> input(1 << 16);
+  std::vector<unsigned char> window(window_size);
+  std::uint64_t total_in = 0, total_out = 0, last = 0;
+  bool finished = false;
+
+  while (!finished) {
+    if (stream.avail_in == 0) {
+      in.read(reinterpret_cast<char *>(input.data()),
+              static_cast<std::streamsize>(input.size()));
+      stream.avail_in = static_cast<uInt>(in.gcount());
+      stream.next_in = input.data();
+      if (stream.avail_in == 0)
+        throw std::ios_base::failure("truncated gzip stream");
+    }
+    if (stream.avail_out == 0) {
+      stream.avail_out = static_cast<uInt>(window.size());
+      stream.next_out = window.data();
+    }
+
+    auto const in_before = stream.avail_in;
+    auto const out_before = stream.next_out;
+    auto const ret = inflate(&stream, Z_BLOCK);
+    total_in += in_before - stream.avail_in;
+    total_out += static_cast<std::uint64_t>(stream.next_out - out_before);
+
+    if (impl.state != detail::BaseTarFilterImpl::State::Done) {
+      auto begin = reinterpret_cast<const char *>(out_before);
+      impl.visit(begin, reinterpret_cast<const char *>(stream.next_out),
+                 visitor);
+    }
+
+    if (ret == Z_STREAM_END) {
+      if (stream.avail_in == 0) {
+        in.read(reinterpret_cast<char *>(input.data()),
+                static_cast<std::streamsize>(input.size()));
+        stream.avail_in = static_cast<uInt>(in.gcount());
+        stream.next_in = input.data();
+      }
+      if (stream.avail_in == 0) {
+        finished = true;
+      } else {
+        inflateReset(&stream);
+        index.checkpoints.push_back(
+            GzipCheckpoint{total_in, total_out, 0, {}});
+        last = total_out;
+      }
+      continue;
+    }
+    if (ret != Z_OK && ret != Z_BUF_ERROR)
+      detail::throw_zlib_error(stream, ret);
+
+    // Block boundary that is not the end of the member.
+    if ((stream.data_type & 128) && !(stream.data_type & 64) &&
+        total_out - last >= spacing) {
+      GzipCheckpoint checkpoint{total_in, total_out,
+                                static_cast<std::uint8_t>(stream.data_type & 7),
+                                std::vector<unsigned char>(window_size)};
+      auto const left = stream.avail_out;
+      std::memcpy(checkpoint.window.data(), window.data() + window_size - left,
+                  left);
+      std::memcpy(checkpoint.window.data() + left, window.data(),
+                  window_size - left);
+      index.checkpoints.push_back(std::move(checkpoint));
+      last = total_out;
+    }
+  }
+
+  index.uncompressed_size = total_out;
+  return index;
+}
+
+GzipIndex GzipIndex::read(std::istream &in) {
+  char magic[sizeof(index_magic)];
+  if (!in.read(magic, sizeof(magic)) ||
+      std::memcmp(magic, index_magic, sizeof(magic)) != 0)
+    throw std::ios_base::failure("not a gzip index");
+
+  GzipIndex index;
+  index.uncompressed_size = read_pod_impl<std::uint64_t>(in);
+  index.checkpoints.resize(read_pod_impl<std::uint64_t>(in));
+  for (auto &checkpoint : index.checkpoints) {
+    checkpoint.compressed_offset = read_pod_impl<std::uint64_t>(in);
+    checkpoint.uncompressed_offset = read_pod_impl<std::uint64_t>(in);
+    checkpoint.bits = read_pod_impl<std::uint8_t>(in);
+    checkpoint.window.resize(read_pod_impl<std::uint32_t>(in));
+    if (!in.read(reinterpret_cast<char *>(checkpoint.window.data()),
+                 static_cast<std::streamsize>(checkpoint.window.size())))
+      throw std::ios_base::failure("truncated gzip index");
+  }
+  index.entries.resize(read_pod_impl<std::uint64_t>(in));
+  for (auto &entry : index.entries) {
+    entry.header_offset = read_pod_impl<std::uint64_t>(in);
+    entry.size = read_pod_impl<std::uint64_t>(in);
+    entry.type = read_pod_impl<char>(in);
+    entry.name.resize(read_pod_impl<std::uint32_t>(in));
+    if (!in.read(entry.name.data(),
+                 static_cast<std::streamsize>(entry.name.size())))
+      throw std::ios_base::failure("truncated gzip index");
+  }
+  return index;
+}
+
+void GzipIndex::write(std::ostream &out) const {
+  out.write(index_magic, sizeof(index_magic));
+  write_pod_impl<std::uint64_t>(out, uncompressed_size);
+  write_pod_impl<std::uint64_t>(out, checkpoints.size());
+  for (const auto &checkpoint : checkpoints) {
+    write_pod_impl<std::uint64_t>(out, checkpoint.compressed_offset);
+    write_pod_impl<std::uint64_t>(out, checkpoint.uncompressed_offset);
+    write_pod_impl<std::uint8_t>(out, checkpoint.bits);
+    write_pod_impl<std::uint32_t>(
+        out, static_cast<std::uint32_t>(checkpoint.window.size()));
+    out.write(reinterpret_cast<const char *>(checkpoint.window.data()),
+              static_cast<std::streamsize>(checkpoint.window.size()));
+  }
+  write_pod_impl<std::uint64_t>(out, entries.size());
+  for (const auto &entry : entries) {
+    write_pod_impl<std::uint64_t>(out, entry.header_offset);
+    write_pod_impl<std::uint64_t>(out, entry.size);
+    write_pod_impl<char>(out, entry.type);
+    write_pod_impl<std::uint32_t>(out,
+                                  static_cast<std::uint32_t>(entry.name.size()));
+    out.write(entry.name.data(), static_cast<std::streamsize>(entry.name.size()));
+  }
+}
+
+const GzipCheckpoint &GzipIndex::checkpoint_for(std::uint64_t offset) const {
+  auto it = std::upper_bound(
+      checkpoints.begin(), checkpoints.end(), offset,
+      [](std::uint64_t value, const GzipCheckpoint &checkpoint) {
+        return value < checkpoint.uncompressed_offset;
+      });
+  return *std::prev(it);
+}
+
+// -----------------------------
+// Parallel extraction
+// -----------------------------
+
+namespace {
+/**
+ * @brief Visitor of one range in extract_tar_gz_parallel(): feeds a private
+ * FilesystemSink, skips entries whose path appears again later in the
+ * archive and sets hard links aside for the final pass.
+ */
+class RangeExtractor : public EntryVisitor {
+public:
+  /**
+   * @param superseded Per index entry, whether a later entry has its path.
+   * @param first_entry Index position of the range's first entry.
+   */
+  RangeExtractor(const std::filesystem::path &root,
+                 FilesystemSinkOptions options, std::mutex &mutex,
+                 std::vector<Entry> &hard_links,
+                 const std::vector<bool> &superseded, std::size_t first_entry)
+      : sink_(root, options), visitor_(sink_), mutex_(mutex),
+        hard_links_(hard_links), superseded_(superseded),
+        next_entry_(first_entry) {}
+
+  ~RangeExtractor() override { sink_.finish(); }
+
+  bool on_entry_begin(const Entry &entry) override {
+    auto const position = next_entry_++;
+    if (position < superseded_.size() && superseded_[position]) {
+      diverted_ = true;
+      return false;
+    }
+    diverted_ = entry.is_hard_link();
+    if (!diverted_)
+      return visitor_.on_entry_begin(entry);
+    std::lock_guard<std::mutex> lock(mutex_);
+    hard_links_.push_back(entry);
+    return false;
+  }
+  void on_entry_data(const char *begin, const char *end) override {
+    visitor_.on_entry_data(begin, end);
+  }
+  void on_entry_end(const Entry &entry) override {
+    if (!diverted_)
+      visitor_.on_entry_end(entry);
+  }
+  void on_buffer_end() override { visitor_.on_buffer_end(); }
+
+private:
+  FilesystemSink sink_;
+  ExtractionVisitor visitor_;
+  std::mutex &mutex_;
+  std::vector<Entry> &hard_links_;
+  const std::vector<bool> &superseded_;
+  std::size_t next_entry_;
+  bool diverted_ = false;
+};
+
+/**
+ * @brief Partition entries into ranges of roughly equal uncompressed size
+ * and run one checkpoint inflater + BaseTarFilterImpl per range.
+ *
+ * make_visitor receives the range and the index position of its first
+ * entry. The visitors are declared before the pool, so when a range throws,
+ * the pool's destructor drains the remaining jobs before the visitors they
+ * use are destroyed.
+ */
+std::size_t visit_ranges_impl(
+    const GzipIndex &index, const StreamOpener &open,
+    const std::function<std::unique_ptr<EntryVisitor>(std::size_t,
+                                                      std::size_t)>
+        &make_visitor,
+    std::size_t threads) {
+  std::vector<std::unique_ptr<EntryVisitor>> visitors;
+  detail::WorkerPool pool(threads);
+
+  std::vector<std::uint64_t> starts{0};
+  std::vector<std::size_t> first_entries{0};
+  auto const target = index.uncompressed_size / pool.size() + 1;
+  for (std::size_t i = 0; i < index.entries.size(); ++i)
+    if (index.entries[i].header_offset >= starts.back() + target) {
+      starts.push_back(index.entries[i].header_offset);
+      first_entries.push_back(i);
+    }
+
+  for (std::size_t range = 0; range < starts.size(); ++range)
+    visitors.push_back(make_visitor(range, first_entries[range]));
+
+  std::vector<std::future<void>> jobs;
+  for (std::size_t range = 0; range < starts.size(); ++range) {
+    auto const begin = starts[range];
+    auto const end = range + 1 < starts.size() ? starts[range + 1]
+                                               : index.uncompressed_size;
+    auto &visitor = *visitors[range];
+    jobs.push_back(pool.submit([&index, &open, &visitor, begin, end] {
+      auto stream = open();
+      const auto &checkpoint = index.checkpoint_for(begin);
+      detail::GzipInflater inflater(*stream, checkpoint);
+      auto const lead = begin - checkpoint.uncompressed_offset;
+      if (inflater.discard(lead) != lead)
+        throw std::ios_base::failure("gzip stream shorter than its index");
+
+      detail::BaseTarFilterImpl impl;
+      std::vector<char> buffer(1 << 16);
+      for (auto remaining = end - begin; remaining > 0;) {
+        auto const count = inflater.read(
+            buffer.data(), static_cast<std::size_t>(std::min<std::uint64_t>(
+                               remaining, buffer.size())));
+        if (count == 0)
+          break;
+        const char *data = buffer.data();
+        impl.visit(data, data + count, visitor);
+        visitor.on_buffer_end();
+        remaining -= count;
+        if (impl.state == detail::BaseTarFilterImpl::State::Done)
+          break;
+      }
+    }));
+  }
+
+  for (auto &job : jobs)
+    job.get();
+  return starts.size();
+}
+} // unnamed namespace
+
+std::size_t visit_tar_gz_parallel(
+    const GzipIndex &index, const StreamOpener &open,
+    const std::function<std::unique_ptr<EntryVisitor>(std::size_t)>
+        &make_visitor,
+    std::size_t threads) {
+  return visit_ranges_impl(
+      index, open,
+      [&](std::size_t range, std::size_t) { return make_visitor(range); },
+      threads);
+}
+
+/**
+ * @brief Ranges run concurrently, so a path stored twice is resolved from
+ * the index up front: only its last entry is extracted, as in a sequential
+ * pass.
+ */
+void extract_tar_gz_parallel(const GzipIndex &index, const StreamOpener &open,
+                             const std::filesystem::path &root,
+                             FilesystemSinkOptions options,
+                             std::size_t threads) {
+  std::vector<bool> superseded(index.entries.size());
+  std::unordered_map<std::string_view, std::size_t> last;
+  for (std::size_t i = 0; i < index.entries.size(); ++i) {
+    auto [it, inserted] = last.try_emplace(index.entries[i].name, i);
+    if (!inserted) {
+      superseded[it->second] = true;
+      it->second = i;
+    }
+  }
+
+  std::mutex mutex;
+  std::vector<Entry> hard_links;
+  visit_ranges_impl(
+      index, open,
+      [&](std::size_t, std::size_t first_entry) {
+        return std::make_unique<RangeExtractor>(
+            root, options, mutex, hard_links, superseded, first_entry);
+      },
+      threads);
+
+  FilesystemSink sink(root, options);
+  ExtractionVisitor visitor(sink);
+  for (const auto &entry : hard_links) {
+    visitor.on_entry_begin(entry);
+    visitor.on_entry_end(entry);
+  }
+  visitor.on_buffer_end();
+  sink.finish();
+}
+} // namespace boost_iostreams_tar_filter
@@ -0,0 +1,118 @@
+#include <boost-iostreams-tar-filter/detail/gzip-inflater.hxx>
+
+#include <algorithm>
+#include <ios>
+#include <string>
+
+namespace boost_iostreams_tar_filter::detail {
+void throw_zlib_error(const z_stream &stream, int ret) {
+  throw std::ios_base::failure(std::string("inflate failed: ") +
+                               (stream.msg ? stream.msg : zError(ret)));
+}
+
+GzipInflater::GzipInflater(std::istream &in, bool verify)
+    : in_(in), input_(1 << 16), verify_(verify) {
+  if (inflateInit2(&stream_, 47) != Z_OK)
+    throw std::ios_base::failure("inflateInit2 failed");
+  inflateValidate(&stream_, verify_);
+}
+
+GzipInflater::GzipInflater(std::istream &in, const GzipCheckpoint &checkpoint,
+                           bool verify)
+    : in_(in), input_(1 << 16), verify_(verify) {
+  raw_ = !checkpoint.window.empty();
+  if (inflateInit2(&stream_, raw_ ? -15 : 47) != Z_OK)
+    throw std::ios_base::failure("inflateInit2 failed");
+  if (!raw_)
+    inflateValidate(&stream_, verify_);
+
+  in_.clear();
+  in_.seekg(static_cast<std::streamoff>(checkpoint.compressed_offset -
+                                        (checkpoint.bits ? 1 : 0)));
+  if (!in_)
+    throw std::ios_base::failure("cannot seek to gzip checkpoint");
+  if (!raw_)
+    return;
+
+  if (checkpoint.bits) {
+    auto const byte = in_.get();
+    if (byte == std::char_traits<char>::eof())
+      throw std::ios_base::failure("truncated gzip stream");
+    inflatePrime(&stream_, checkpoint.bits, byte >> (8 - checkpoint.bits));
+  }
+  inflateSetDictionary(&stream_, checkpoint.window.data(),
+                       static_cast<uInt>(checkpoint.window.size()));
+}
+
+GzipInflater::~GzipInflater() { inflateEnd(&stream_); }
+
+void GzipInflater::next_member() {
+  // inflateReset2() re-enables validation, inflateReset() keeps the setting.
+  if (raw_) {
+    inflateReset2(&stream_, 47);
+    inflateValidate(&stream_, verify_);
+    raw_ = false;
+  } else {
+    inflateReset(&stream_);
+  }
+}
+
+bool GzipInflater::fill() {
+  in_.read(reinterpret_cast<char *>(input_.data()),
+           static_cast<std::streamsize>(input_.size()));
+  stream_.next_in = input_.data();
+  stream_.avail_in = static_cast<uInt>(in_.gcount());
+  return stream_.avail_in > 0;
+}
+
+/**
+ * @brief Inflate into the caller's buffer. At the end of a member the
+ * 8-byte trailer is skipped (raw mode) and the next member, if any, is
+ * inflated with gzip header parsing.
+ */
+std::size_t GzipInflater::read(char *out, std::size_t size) {
+  stream_.next_out = reinterpret_cast<Bytef *>(out);
+  stream_.avail_out = static_cast<uInt>(size);
+
+  while (stream_.avail_out > 0 && !finished_) {
+    if (stream_.avail_in == 0 && !fill()) {
+      finished_ = true;
+      break;
+    }
+    auto const ret = inflate(&stream_, Z_NO_FLUSH);
+    if (ret == Z_STREAM_END) {
+      if (raw_) {
+        for (int trailer = 8; trailer > 0;) {
+          if (stream_.avail_in == 0 && !fill())
+            break;
+          auto const take = std::min<uInt>(stream_.avail_in, trailer);
+          stream_.next_in += take;
+          stream_.avail_in -= take;
+          trailer -= static_cast<int>(take);
+        }
+      }
+      next_member();
+      if (stream_.avail_in == 0 && !fill())
+        finished_ = true;
+    } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+      throw_zlib_error(stream_, ret);
+    }
+  }
+  return size - stream_.avail_out;
+}
+
+std::uint64_t GzipInflater::discard(std::uint64_t count) {
+  if (scratch_.empty())
+    scratch_.resize(32768);
+  std::uint64_t discarded = 0;
+  while (discarded < count) {
+    auto const got = read(scratch_.data(),
+                          static_cast<std::size_t>(std::min<std::uint64_t>(
+                              count - discarded, scratch_.size())));
+    if (got == 0)
+      break;
+    discarded += got;
+  }
+  return discarded;
+}
+} // namespace boost_iostreams_tar_filter::detail
@@ -0,0 +1,66 @@
+#include <boost-iostreams-tar-filter/detail/inflater.hxx>
+
+#include <ios>
+#include <isa-l/igzip_lib.h>
+#include <string>
+
+namespace boost_iostreams_tar_filter::detail {
+namespace {
+/**
+ * @brief Streaming inflate through ISA-L igzip with gzip header and CRC
+ * handling.
+ */
+class IsalInflater final : public Inflater {
+public:
+  IsalInflater() { reset(); }
+
+  bool inflate(const char *&src_begin, const char *src_end, char *&dest_begin,
+               const char *dest_end, bool flush) override {
+    // Members are started within the same call, see the zlib engine.
+    for (;;) {
+      if (state_.block_state == ISAL_BLOCK_FINISH) {
+        if (src_begin == src_end)
+          return !flush;
+        reset();
+      }
+
+      state_.next_in =
+          reinterpret_cast<std::uint8_t *>(const_cast<char *>(src_begin));
+      state_.avail_in = static_cast<std::uint32_t>(src_end - src_begin);
+      state_.next_out = reinterpret_cast<std::uint8_t *>(dest_begin);
+      state_.avail_out = static_cast<std::uint32_t>(dest_end - dest_begin);
+
+      auto const ret = isal_inflate(&state_);
+      auto const progressed =
+          reinterpret_cast<char *>(state_.next_out) != dest_begin ||
+          reinterpret_cast<const char *>(state_.next_in) != src_begin;
+      src_begin = reinterpret_cast<const char *>(state_.next_in);
+      dest_begin = reinterpret_cast<char *>(state_.next_out);
+
+      if (ret != ISAL_DECOMP_OK && ret != ISAL_END_INPUT &&
+          ret != ISAL_OUT_OVERFLOW)
+        throw std::ios_base::failure("isal_inflate failed: " +
+                                     std::to_string(ret));
+      if (state_.block_state == ISAL_BLOCK_FINISH)
+        continue;
+      if (!progressed && flush && src_begin == src_end &&
+          dest_begin != dest_end)
+        throw std::ios_base::failure("truncated gzip stream");
+      return true;
+    }
+  }
+
+  void reset() override {
+    isal_inflate_init(&state_);
+    state_.crc_flag = ISAL_GZIP;
+  }
+
+private:
+  inflate_state state_{};
+};
+} // unnamed namespace
+
+std::unique_ptr<Inflater> make_isal_inflater() {
+  return std::make_unique<IsalInflater>();
+}
+} // namespace boost_iostreams_tar_filter::detail
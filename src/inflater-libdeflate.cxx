@@ -0,0 +1,105 @@
+#include <boost-iostreams-tar-filter/detail/inflater.hxx>
+
+#include <algorithm>
+#include <cstring>
+#include <ios>
+#include <libdeflate.h>
+#include <vector>
+
+namespace boost_iostreams_tar_filter::detail {
+namespace {
+/**
+ * @brief Whole-buffer inflate through libdeflate.
+ *
+ * libdeflate only decompresses complete members, so the compressed stream is
+ * collected until the source is exhausted, every member is then decompressed
+ * in one go and the result is handed out over the following calls. Input
+ * beyond libdeflate_max_input is rejected instead of buffered.
+ */
+class LibdeflateInflater final : public Inflater {
+public:
+  LibdeflateInflater() : decompressor_(libdeflate_alloc_decompressor()) {
+    if (!decompressor_)
+      throw std::bad_alloc();
+  }
+  ~LibdeflateInflater() override {
+    libdeflate_free_decompressor(decompressor_);
+  }
+
+  bool inflate(const char *&src_begin, const char *src_end, char *&dest_begin,
+               const char *dest_end, bool flush) override {
+    if (static_cast<std::size_t>(src_end - src_begin) >
+        libdeflate_max_input - input_.size())
+      throw std::ios_base::failure(
+          "libdeflate: gzip stream exceeds libdeflate_max_input");
+    input_.insert(input_.end(), src_begin, src_end);
+    src_begin = src_end;
+    if (!flush)
+      return true;
+    if (!decompressed_)
+      decompress();
+
+    auto const count = std::min(output_.size() - output_offset_,
+                                static_cast<std::size_t>(dest_end - dest_begin));
+    std::memcpy(dest_begin, output_.data() + output_offset_, count);
+    dest_begin += count;
+    output_offset_ += count;
+    return output_offset_ != output_.size();
+  }
+
+  void reset() override {
+    input_.clear();
+    output_.clear();
+    output_offset_ = 0;
+    decompressed_ = false;
+  }
+
+private:
+  /**
+   * @brief Decompress every member of input_ into output_, sizing the
+   * output from the ISIZE trailer of the last member and growing on demand.
+   */
+  void decompress() {
+    decompressed_ = true;
+    if (input_.empty())
+      return;
+
+    std::size_t capacity = input_.size() * 4;
+    if (input_.size() >= 4) {
+      std::uint32_t isize;
+      std::memcpy(&isize, input_.data() + input_.size() - 4, sizeof(isize));
+      capacity = std::max<std::size_t>(capacity, isize);
+    }
+
+    std::size_t in_offset = 0;
+    while (in_offset < input_.size()) {
+      std::size_t consumed = 0, produced = 0;
+      auto const out_offset = output_.size();
+      for (;;) {
+        output_.resize(out_offset + capacity);
+        auto const result = libdeflate_gzip_decompress_ex(
+            decompressor_, input_.data() + in_offset, input_.size() - in_offset,
+            output_.data() + out_offset, capacity, &consumed, &produced);
+        if (result == LIBDEFLATE_SUCCESS)
+          break;
+        if (result != LIBDEFLATE_INSUFFICIENT_SPACE)
+          throw std::ios_base::failure("libdeflate: corrupt gzip stream");
+        capacity *= 2;
+      }
+      output_.resize(out_offset + produced);
+      in_offset += consumed;
+    }
+  }
+
+  libdeflate_decompressor *decompressor_;
+  std::vector<char> input_;
+  std::vector<char> output_;
+  std::size_t output_offset_ = 0;
+  bool decompressed_ = false;
+};
+} // unnamed namespace
+
+std::unique_ptr<Inflater> make_libdeflate_inflater() {
+  return std::make_unique<LibdeflateInflater>();
+}
+} // namespace boost_iostreams_tar_filter::detail
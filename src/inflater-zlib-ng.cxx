@@ -0,0 +1,68 @@
+#include <boost-iostreams-tar-filter/detail/inflater.hxx>
+
+#include <ios>
+#include <string>
+#include <zlib-ng.h>
+
+namespace boost_iostreams_tar_filter::detail {
+namespace {
+/**
+ * @brief Streaming inflate through the native zlib-ng API; mirrors the zlib
+ * engine.
+ */
+class ZlibNgInflater final : public Inflater {
+public:
+  ZlibNgInflater() {
+    if (zng_inflateInit2(&stream_, 47) != Z_OK)
+      throw std::ios_base::failure("zng_inflateInit2 failed");
+  }
+  ~ZlibNgInflater() override { zng_inflateEnd(&stream_); }
+
+  bool inflate(const char *&src_begin, const char *src_end, char *&dest_begin,
+               const char *dest_end, bool flush) override {
+    for (;;) {
+      if (member_ended_) {
+        if (src_begin == src_end)
+          return !flush;
+        zng_inflateReset(&stream_);
+        member_ended_ = false;
+      }
+
+      stream_.next_in = reinterpret_cast<const uint8_t *>(src_begin);
+      stream_.avail_in = static_cast<uint32_t>(src_end - src_begin);
+      stream_.next_out = reinterpret_cast<uint8_t *>(dest_begin);
+      stream_.avail_out = static_cast<uint32_t>(dest_end - dest_begin);
+
+      auto const ret = zng_inflate(&stream_, Z_NO_FLUSH);
+      src_begin = reinterpret_cast<const char *>(stream_.next_in);
+      dest_begin = reinterpret_cast<char *>(stream_.next_out);
+
+      if (ret == Z_STREAM_END) {
+        member_ended_ = true;
+        continue;
+      }
+      if (ret == Z_BUF_ERROR && flush && src_begin == src_end &&
+          dest_begin != dest_end)
+        throw std::ios_base::failure("truncated gzip stream");
+      if (ret != Z_OK && ret != Z_BUF_ERROR)
+        throw std::ios_base::failure(std::string("inflate failed: ") +
+                                     (stream_.msg ? stream_.msg : "zlib-ng"));
+      return true;
+    }
+  }
+
+  void reset() override {
+    zng_inflateReset(&stream_);
+    member_ended_ = false;
+  }
+
+private:
+  zng_stream stream_{};
+  bool member_ended_ = false;
+};
+} // unnamed namespace
+
+std::unique_ptr<Inflater> make_zlib_ng_inflater() {
+  return std::make_unique<ZlibNgInflater>();
+}
+} // namespace boost_iostreams_tar_filter::detail
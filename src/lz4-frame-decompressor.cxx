@@ -0,0 +1,431 @@
+#include <boost-iostreams-tar-filter/detail/lz4-frame-decompressor-impl.hxx>
+#include <boost-iostreams-tar-filter/detail/worker-pool.hxx>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <ios>
+#include <lz4.h>
+#include <string>
+#include <vector>
+
+namespace boost_iostreams_tar_filter::detail {
+namespace {
+constexpr std::uint32_t frame_magic = 0x184D2204;
+constexpr std::uint32_t skippable_magic = 0x184D2A50;
+constexpr std::uint32_t skippable_mask = 0xFFFFFFF0;
+constexpr std::uint32_t legacy_magic = 0x184C2102;
+constexpr std::uint32_t uncompressed_flag = 0x80000000;
+constexpr std::size_t history_size = 64 * 1024;
+
+inline std::uint32_t read_le32_impl(const unsigned char *p) {
+  return std::uint32_t(p[0]) | std::uint32_t(p[1]) << 8 |
+         std::uint32_t(p[2]) << 16 | std::uint32_t(p[3]) << 24;
+}
+
+inline std::uint32_t rotl_impl(std::uint32_t x, int r) {
+  return (x << r) | (x >> (32 - r));
+}
+
+/**
+ * @brief Streaming XXH32, the checksum of the LZ4 frame format.
+ */
+class Xxh32 {
+public:
+  explicit Xxh32(std::uint32_t seed = 0) { reset(seed); }
+
+  void reset(std::uint32_t seed = 0) {
+    v_[0] = seed + p1 + p2;
+    v_[1] = seed + p2;
+    v_[2] = seed;
+    v_[3] = seed - p1;
+    total_ = 0;
+    buffered_ = 0;
+  }
+
+  void update(const unsigned char *data, std::size_t size) {
+    total_ += size;
+    if (buffered_ + size < 16) {
+      std::memcpy(buffer_ + buffered_, data, size);
+      buffered_ += size;
+      return;
+    }
+    if (buffered_ > 0) {
+      auto const fill = 16 - buffered_;
+      std::memcpy(buffer_ + buffered_, data, fill);
+      stripe(buffer_);
+      data += fill;
+      size -= fill;
+      buffered_ = 0;
+    }
+    for (; size >= 16; data += 16, size -= 16)
+      stripe(data);
+    std::memcpy(buffer_, data, size);
+    buffered_ = size;
+  }
+
+  std::uint32_t digest() const {
+    std::uint32_t h = total_ >= 16 ? rotl_impl(v_[0], 1) + rotl_impl(v_[1], 7) +
+                                         rotl_impl(v_[2], 12) +
+                                         rotl_impl(v_[3], 18)
+                                   : v_[2] + p5;
+    h += static_cast<std::uint32_t>(total_);
+    std::size_t i = 0;
+    for (; i + 4 <= buffered_; i += 4)
+      h = rotl_impl(h + read_le32_impl(buffer_ + i) * p3, 17) * p4;
+    for (; i < buffered_; ++i)
+      h = rotl_impl(h + buffer_[i] * p5, 11) * p1;
+    h ^= h >> 15;
+    h *= p2;
+    h ^= h >> 13;
+    h *= p3;
+    h ^= h >> 16;
+    return h;
+  }
+
+  static std::uint32_t of(const unsigned char *data, std::size_t size) {
+    Xxh32 hash;
+    hash.update(data, size);
+    return hash.digest();
+  }
+
+private:
+  static constexpr std::uint32_t p1 = 2654435761U;
+  static constexpr std::uint32_t p2 = 2246822519U;
+  static constexpr std::uint32_t p3 = 3266489917U;
+  static constexpr std::uint32_t p4 = 668265263U;
+  static constexpr std::uint32_t p5 = 374761393U;
+
+  void stripe(const unsigned char *data) {
+    for (int i = 0; i < 4; ++i)
+      v_[i] = rotl_impl(v_[i] + read_le32_impl(data + 4 * i) * p2, 13) * p1;
+  }
+
+  std::uint32_t v_[4];
+  std::uint64_t total_ = 0;
+  unsigned char buffer_[16];
+  std::size_t buffered_ = 0;
+};
+
+/**
+ * @brief Decode one block, verifying its checksum when present.
+ *
+ * @param dictionary Previous output of a linked-block frame, or empty.
+ */
+std::string decode_block_impl(const unsigned char *data, std::size_t size,
+                              bool compressed, bool has_checksum,
+                              std::size_t max_size,
+                              const std::string &dictionary) {
+  if (has_checksum && Xxh32::of(data, size) != read_le32_impl(data + size))
+    throw std::ios_base::failure("LZ4 block checksum mismatch");
+  if (!compressed)
+    return std::string(reinterpret_cast<const char *>(data), size);
+
+  std::string out(max_size, '\0');
+  auto const produced =
+      dictionary.empty()
+          ? LZ4_decompress_safe(reinterpret_cast<const char *>(data),
+                                out.data(), static_cast<int>(size),
+                                static_cast<int>(max_size))
+          : LZ4_decompress_safe_usingDict(
+                reinterpret_cast<const char *>(data), out.data(),
+                static_cast<int>(size), static_cast<int>(max_size),
+                dictionary.data(), static_cast<int>(dictionary.size()));
+  if (produced < 0)
+    throw std::ios_base::failure("corrupt LZ4 block");
+  out.resize(static_cast<std::size_t>(produced));
+  return out;
+}
+} // unnamed namespace
+
+/**
+ * @class Lz4FrameDecoder
+ * @brief State behind BaseLz4FrameDecompressorImpl: frame parser, worker
+ * pool and reorder queue.
+ */
+class Lz4FrameDecoder {
+public:
+  Lz4FrameDecoder(std::size_t threads, std::size_t max_in_flight)
+      : pool_(threads),
+        max_in_flight_(max_in_flight ? max_in_flight : 2 * pool_.size()) {}
+
+  bool filter(const char *&src_begin, const char *src_end, char *&dest_begin,
+              const char *dest_end, bool flush) {
+    input_.insert(input_.end(), src_begin, src_end);
+    src_begin = src_end;
+
+    for (;;) {
+      auto const blocked = scan(flush);
+      emit(dest_begin, dest_end, flush || blocked);
+      if (dest_begin == dest_end)
+        return true;
+      if (!blocked)
+        break;
+    }
+    return !flush;
+  }
+
+  void reset() {
+    input_.clear();
+    position_ = 0;
+    stage_ = Stage::Magic;
+    pending_.clear();
+    output_.clear();
+    output_offset_ = 0;
+    content_hash_.reset();
+  }
+
+private:
+  enum class Stage { Magic, FrameHeader, Blocks, ContentChecksum, Skip };
+
+  /**
+   * @brief A decoded block, or the end of a frame carrying its content
+   * checksum.
+   */
+  struct Pending {
+    std::future<std::string> data;
+    bool frame_end = false;
+    bool has_checksum = false;
+    std::uint32_t checksum = 0;
+  };
+
+  std::size_t available() const { return input_.size() - position_; }
+  const unsigned char *at() const { return input_.data() + position_; }
+
+  /**
+   * @brief Advance through the buffered input, submitting every complete
+   * block.
+   *
+   * @return true when stopped because max_in_flight blocks are pending.
+   */
+  bool scan(bool flush) {
+    for (;;) {
+      switch (stage_) {
+      case Stage::Magic: {
+        if (available() < 4)
+          return wait_for_input(flush, available() > 0, "truncated LZ4 frame");
+        auto const magic = read_le32_impl(at());
+        position_ += 4;
+        if (magic == frame_magic) {
+          stage_ = Stage::FrameHeader;
+        } else if ((magic & skippable_mask) == skippable_magic) {
+          skip_header_ = true;
+          stage_ = Stage::Skip;
+        } else if (magic == legacy_magic) {
+          throw std::ios_base::failure("legacy LZ4 frames are not supported");
+        } else {
+          throw std::ios_base::failure("not an LZ4 frame");
+        }
+        break;
+      }
+
+      case Stage::FrameHeader: {
+        if (available() < 2)
+          return wait_for_input(flush, true, "truncated LZ4 frame header");
+        auto const flags = at()[0];
+        auto const block_descriptor = at()[1];
+        auto const descriptor_size =
+            std::size_t(2) + (flags & 0x08 ? 8 : 0) + (flags & 0x01 ? 4 : 0);
+        if (available() < descriptor_size + 1)
+          return wait_for_input(flush, true, "truncated LZ4 frame header");
+        if ((flags >> 6) != 1 || (flags & 0x02) || (block_descriptor & 0x8F))
+          throw std::ios_base::failure("unsupported LZ4 frame version");
+        if (flags & 0x01)
+          throw std::ios_base::failure(
+              "LZ4 frames with a dictionary are not supported");
+        auto const size_id = (block_descriptor >> 4) & 0x07;
+        if (size_id < 4)
+          throw std::ios_base::failure("invalid LZ4 block size");
+        if (((Xxh32::of(at(), descriptor_size) >> 8) & 0xFF) !=
+            at()[descriptor_size])
+          throw std::ios_base::failure("LZ4 frame header checksum mismatch");
+
+        independent_ = flags & 0x20;
+        block_checksum_ = flags & 0x10;
+        content_checksum_ = flags & 0x04;
+        max_block_size_ = std::size_t(1) << (8 + 2 * size_id);
+        history_.clear();
+        position_ += descriptor_size + 1;
+        stage_ = Stage::Blocks;
+        break;
+      }
+
+      case Stage::Blocks: {
+        if (pending_.size() >= max_in_flight_)
+          return true;
+        if (available() < 4)
+          return wait_for_input(flush, true, "truncated LZ4 frame");
+        auto const header = read_le32_impl(at());
+        if (header == 0) {
+          position_ += 4;
+          stage_ = Stage::ContentChecksum;
+          break;
+        }
+        auto const size = static_cast<std::size_t>(header & ~uncompressed_flag);
+        if (size > max_block_size_)
+          throw std::ios_base::failure("LZ4 block exceeds the frame's maximum");
+        if (available() < 4 + size + (block_checksum_ ? 4 : 0))
+          return wait_for_input(flush, true, "truncated LZ4 block");
+        submit(at() + 4, size, !(header & uncompressed_flag));
+        position_ += 4 + size + (block_checksum_ ? 4 : 0);
+        break;
+      }
+
+      case Stage::ContentChecksum: {
+        Pending end;
+        end.frame_end = true;
+        if (content_checksum_) {
+          if (available() < 4)
+            return wait_for_input(flush, true, "truncated LZ4 frame");
+          end.has_checksum = true;
+          end.checksum = read_le32_impl(at());
+          position_ += 4;
+        }
+        pending_.push_back(std::move(end));
+        stage_ = Stage::Magic;
+        break;
+      }
+
+      case Stage::Skip: {
+        if (skip_header_) {
+          if (available() < 4)
+            return wait_for_input(flush, true, "truncated LZ4 skippable frame");
+          skip_ = read_le32_impl(at());
+          position_ += 4;
+          skip_header_ = false;
+        }
+        auto const count = static_cast<std::size_t>(
+            std::min<std::uint64_t>(skip_, available()));
+        position_ += count;
+        skip_ -= count;
+        if (skip_ > 0)
+          return wait_for_input(flush, true, "truncated LZ4 skippable frame");
+        stage_ = Stage::Magic;
+        break;
+      }
+      }
+    }
+  }
+
+  /**
+   * @brief Out of input in the middle of the current stage: fail at the end
+   * of the source, otherwise wait for more.
+   */
+  bool wait_for_input(bool flush, bool partial, const char *what) {
+    if (flush && partial)
+      throw std::ios_base::failure(what);
+    compact();
+    return false;
+  }
+
+  void submit(const unsigned char *data, std::size_t size, bool compressed) {
+    Pending pending;
+    if (independent_) {
+      pending.data = pool_.submit(
+          [block = std::vector<unsigned char>(
+               data, data + size + (block_checksum_ ? 4 : 0)),
+           size, compressed, checksum = block_checksum_,
+           max_size = max_block_size_] {
+            return decode_block_impl(block.data(), size, compressed, checksum,
+                                     max_size, std::string());
+          });
+    } else {
+      // Linked blocks reference the previous 64 KiB of output.
+      std::promise<std::string> promise;
+      auto decoded = decode_block_impl(data, size, compressed, block_checksum_,
+                                       max_block_size_, history_);
+      history_ += decoded;
+      if (history_.size() > history_size)
+        history_.erase(0, history_.size() - history_size);
+      promise.set_value(std::move(decoded));
+      pending.data = promise.get_future();
+    }
+    pending_.push_back(std::move(pending));
+  }
+
+  /**
+   * @brief Drop consumed input once it makes up half the buffer, so the
+   * kept tail is moved a bounded number of times.
+   */
+  void compact() {
+    if (position_ == 0 || position_ < input_.size() / 2)
+      return;
+    input_.erase(input_.begin(),
+                 input_.begin() + static_cast<std::ptrdiff_t>(position_));
+    position_ = 0;
+  }
+
+  /**
+   * @brief Copy decoded blocks to the destination in input order, checking
+   * content checksums at frame ends.
+   *
+   * @param wait Whether to block on blocks still being decoded.
+   */
+  void emit(char *&dest_begin, const char *dest_end, bool wait) {
+    for (;;) {
+      auto const count =
+          std::min(output_.size() - output_offset_,
+                   static_cast<std::size_t>(dest_end - dest_begin));
+      std::memcpy(dest_begin, output_.data() + output_offset_, count);
+      dest_begin += count;
+      output_offset_ += count;
+      if (dest_begin == dest_end || pending_.empty())
+        return;
+
+      auto &front = pending_.front();
+      if (front.frame_end) {
+        if (front.has_checksum && content_hash_.digest() != front.checksum)
+          throw std::ios_base::failure("LZ4 content checksum mismatch");
+        content_hash_.reset();
+        pending_.pop_front();
+        continue;
+      }
+      if (!wait && front.data.wait_for(std::chrono::seconds(0)) !=
+                       std::future_status::ready)
+        return;
+
+      output_ = front.data.get();
+      output_offset_ = 0;
+      pending_.pop_front();
+      content_hash_.update(reinterpret_cast<const unsigned char *>(output_.data()),
+                           output_.size());
+    }
+  }
+
+  WorkerPool pool_;
+  std::size_t max_in_flight_;
+  std::vector<unsigned char> input_;
+  std::size_t position_ = 0;
+  Stage stage_ = Stage::Magic;
+  std::uint64_t skip_ = 0;
+  bool skip_header_ = false;
+  bool independent_ = false;
+  bool block_checksum_ = false;
+  bool content_checksum_ = false;
+  std::size_t max_block_size_ = 0;
+  std::string history_;
+  std::deque<Pending> pending_;
+  std::string output_;
+  std::size_t output_offset_ = 0;
+  Xxh32 content_hash_;
+};
+
+BaseLz4FrameDecompressorImpl::BaseLz4FrameDecompressorImpl(
+    std::size_t threads, std::size_t max_in_flight)
+    : decoder_(std::make_unique<Lz4FrameDecoder>(threads, max_in_flight)) {}
+
+BaseLz4FrameDecompressorImpl::~BaseLz4FrameDecompressorImpl() = default;
+
+bool BaseLz4FrameDecompressorImpl::filter(const char *&src_begin,
+                                          const char *const src_end,
+                                          char *&dest_begin,
+                                          const char *const dest_end,
+                                          bool flush) {
+  return decoder_->filter(src_begin, src_end, dest_begin, dest_end, flush);
+}
+
+void BaseLz4FrameDecompressorImpl::close() { decoder_->reset(); }
+} // namespace boost_iostreams_tar_filter::detail
@@ -0,0 +1,158 @@
+#include <boost-iostreams-tar-filter/multi-part-source.hxx>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <fcntl.h>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <unistd.h>
+
+namespace boost_iostreams_tar_filter {
+namespace detail {
+/**
+ * @brief Parts, their offsets and the read position shared by the copies of
+ * a MultiPartSource.
+ */
+class MultiPartFile {
+public:
+  explicit MultiPartFile(std::vector<std::filesystem::path> parts)
+      : parts_(std::move(parts)) {
+    offsets_.reserve(parts_.size() + 1);
+    offsets_.push_back(0);
+    for (const auto &part : parts_)
+      offsets_.push_back(offsets_.back() + std::filesystem::file_size(part));
+  }
+
+  MultiPartFile(const MultiPartFile &) = delete;
+  MultiPartFile &operator=(const MultiPartFile &) = delete;
+
+  ~MultiPartFile() {
+    if (fd_ >= 0)
+      ::close(fd_);
+  }
+
+  std::streamsize read(char *s, std::streamsize n) {
+    std::streamsize total = 0;
+    while (total < n && position_ < size()) {
+      auto const part = part_at(position_);
+      open(part);
+      auto const part_end = offsets_[part + 1];
+      auto const want = static_cast<std::size_t>(std::min<std::uint64_t>(
+          static_cast<std::uint64_t>(n - total), part_end - position_));
+      auto const count =
+          ::pread(fd_, s + total, want,
+                  static_cast<off_t>(position_ - offsets_[part]));
+      if (count < 0) {
+        if (errno == EINTR)
+          continue;
+        throw std::system_error(errno, std::generic_category(),
+                                "pread " + parts_[part].string());
+      }
+      if (count == 0)
+        throw std::ios_base::failure("split part shrank: " +
+                                     parts_[part].string());
+      position_ += static_cast<std::uint64_t>(count);
+      total += count;
+    }
+    return total == 0 && n > 0 ? -1 : total;
+  }
+
+  std::uint64_t seek(std::uint64_t target) {
+    position_ = std::min(target, size());
+    return position_;
+  }
+
+  std::uint64_t position() const { return position_; }
+  std::uint64_t size() const { return offsets_.back(); }
+  const std::vector<std::uint64_t> &offsets() const { return offsets_; }
+
+private:
+  /**
+   * @brief Index of the part holding a position below size(); empty parts
+   * are skipped.
+   */
+  std::size_t part_at(std::uint64_t position) const {
+    if (open_part_ < parts_.size() && offsets_[open_part_] <= position &&
+        position < offsets_[open_part_ + 1])
+      return open_part_;
+    auto const it =
+        std::upper_bound(offsets_.begin(), offsets_.end(), position);
+    return static_cast<std::size_t>(it - offsets_.begin()) - 1;
+  }
+
+  void open(std::size_t part) {
+    if (part == open_part_)
+      return;
+    if (fd_ >= 0)
+      ::close(fd_);
+    open_part_ = parts_.size();
+    fd_ = ::open(parts_[part].c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0)
+      throw std::system_error(errno, std::generic_category(),
+                              "open " + parts_[part].string());
+    ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+    open_part_ = part;
+  }
+
+  std::vector<std::filesystem::path> parts_;
+  std::vector<std::uint64_t> offsets_;
+  std::uint64_t position_ = 0;
+  std::size_t open_part_ = static_cast<std::size_t>(-1);
+  int fd_ = -1;
+};
+} // namespace detail
+
+std::vector<std::filesystem::path>
+find_split_parts(const std::filesystem::path &prefix) {
+  auto directory = prefix.parent_path();
+  if (directory.empty())
+    directory = ".";
+  auto const stem = prefix.filename().string();
+
+  std::vector<std::filesystem::path> parts;
+  for (const auto &entry : std::filesystem::directory_iterator(directory)) {
+    auto const name = entry.path().filename().string();
+    if (name.size() <= stem.size() || name.compare(0, stem.size(), stem) != 0)
+      continue;
+    if (!std::all_of(name.begin() + static_cast<std::ptrdiff_t>(stem.size()),
+                     name.end(), [](unsigned char c) { return std::isalnum(c); }))
+      continue;
+    if (entry.is_regular_file())
+      parts.push_back(entry.path());
+  }
+  if (parts.empty())
+    throw std::invalid_argument("no split parts for " + prefix.string());
+  std::sort(parts.begin(), parts.end(), [](const auto &a, const auto &b) {
+    return a.filename().string() < b.filename().string();
+  });
+  return parts;
+}
+
+MultiPartSource::MultiPartSource(std::vector<std::filesystem::path> parts)
+    : file_(std::make_shared<detail::MultiPartFile>(std::move(parts))) {}
+
+std::streamsize MultiPartSource::read(char *s, std::streamsize n) {
+  return file_->read(s, n);
+}
+
+std::streampos MultiPartSource::seek(boost::iostreams::stream_offset off,
+                                     std::ios_base::seekdir way) {
+  std::int64_t base = 0;
+  if (way == std::ios_base::cur)
+    base = static_cast<std::int64_t>(file_->position());
+  else if (way == std::ios_base::end)
+    base = static_cast<std::int64_t>(file_->size());
+  auto const target = std::max<std::int64_t>(0, base + off);
+  return boost::iostreams::offset_to_position(
+      static_cast<boost::iostreams::stream_offset>(
+          file_->seek(static_cast<std::uint64_t>(target))));
+}
+
+const std::vector<std::uint64_t> &MultiPartSource::part_offsets() const {
+  return file_->offsets();
+}
+
+std::uint64_t MultiPartSource::size() const { return file_->size(); }
+} // namespace boost_iostreams_tar_filter
@@ -0,0 +1,486 @@
+#include <boost-iostreams-tar-filter/detail/parallel-bzip2-decompressor-impl.hxx>
+#include <boost-iostreams-tar-filter/detail/worker-pool.hxx>
+
+#include <algorithm>
+#include <bzlib.h>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <ios>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace boost_iostreams_tar_filter::detail {
+namespace {
+constexpr std::uint64_t block_magic = 0x314159265359;
+constexpr std::uint64_t end_magic = 0x177245385090;
+constexpr std::uint64_t magic_mask = (std::uint64_t(1) << 48) - 1;
+constexpr std::uint64_t no_block = ~std::uint64_t(0);
+
+/**
+ * @brief Read one bit, most significant bit of each byte first.
+ */
+inline unsigned bit_at_impl(const unsigned char *data, std::uint64_t bit) {
+  return (data[bit >> 3] >> (7 - (bit & 7))) & 1u;
+}
+
+/**
+ * @brief Append bits [begin, end) of data to a bit string of count bits.
+ *
+ * Bit by bit: only used to join candidates split at a false block magic.
+ */
+void append_bits_impl(std::string &bits, std::uint64_t &count,
+                      const unsigned char *data, std::uint64_t begin,
+                      std::uint64_t end) {
+  bits.resize(static_cast<std::size_t>((count + (end - begin) + 7) / 8));
+  for (auto bit = begin; bit < end; ++bit, ++count)
+    if (bit_at_impl(data, bit))
+      bits[static_cast<std::size_t>(count >> 3)] |=
+          static_cast<char>(0x80u >> (count & 7));
+}
+
+/**
+ * @brief Append values of up to 32 bits to a string, most significant bit
+ * first.
+ */
+class BitWriter {
+public:
+  explicit BitWriter(std::string &out) : out_(out) {}
+
+  void put(std::uint64_t value, int bits) {
+    while (bits > 0) {
+      auto const take = std::min(bits, 32);
+      bits -= take;
+      acc_ = (acc_ << take) | ((value >> bits) & ((std::uint64_t(1) << take) - 1));
+      count_ += take;
+      while (count_ >= 8) {
+        count_ -= 8;
+        out_.push_back(static_cast<char>(acc_ >> count_));
+      }
+      acc_ &= (std::uint64_t(1) << count_) - 1;
+    }
+  }
+
+  /**
+   * @brief Pad the last byte with zero bits.
+   */
+  void flush() {
+    if (count_ > 0)
+      out_.push_back(static_cast<char>(acc_ << (8 - count_)));
+    acc_ = 0;
+    count_ = 0;
+  }
+
+private:
+  std::string &out_;
+  std::uint64_t acc_ = 0;
+  int count_ = 0;
+};
+
+/**
+ * @brief Wrap the bits of one block, [begin_bit, end_bit) starting at its
+ * block magic, into a complete single-block bzip2 stream.
+ *
+ * The combined CRC of a single-block stream equals the block CRC, which
+ * follows the block magic.
+ */
+std::string make_single_block_stream_impl(const unsigned char *data,
+                                          std::uint64_t begin_bit,
+                                          std::uint64_t end_bit, char level) {
+  std::string out{'B', 'Z', 'h', level};
+  out.reserve(static_cast<std::size_t>((end_bit - begin_bit) / 8 + 16));
+
+  auto bit = begin_bit;
+  auto const shift = static_cast<unsigned>(begin_bit & 7);
+  if (shift == 0) {
+    auto const bytes = (end_bit - begin_bit) / 8;
+    out.append(reinterpret_cast<const char *>(data + begin_bit / 8),
+               static_cast<std::size_t>(bytes));
+    bit += bytes * 8;
+  } else {
+    for (; bit + 8 <= end_bit; bit += 8) {
+      auto const byte = static_cast<std::size_t>(bit >> 3);
+      out.push_back(static_cast<char>((data[byte] << shift) |
+                                      (data[byte + 1] >> (8 - shift))));
+    }
+  }
+
+  BitWriter writer(out);
+  for (; bit < end_bit; ++bit)
+    writer.put(bit_at_impl(data, bit), 1);
+
+  std::uint64_t crc = 0;
+  for (std::uint64_t i = 0; i < 32; ++i)
+    crc = (crc << 1) | bit_at_impl(data, begin_bit + 48 + i);
+  writer.put(end_magic, 48);
+  writer.put(crc, 32);
+  writer.flush();
+  return out;
+}
+
+/**
+ * @brief Decompress a complete bzip2 stream with libbz2.
+ */
+std::string decode_stream_impl(const std::string &stream) {
+  bz_stream bz{};
+  if (BZ2_bzDecompressInit(&bz, 0, 0) != BZ_OK)
+    throw std::ios_base::failure("BZ2_bzDecompressInit failed");
+  struct Guard {
+    bz_stream &bz;
+    ~Guard() { BZ2_bzDecompressEnd(&bz); }
+  } guard{bz};
+
+  std::string out(std::max<std::size_t>(stream.size() * 4, 1 << 16), '\0');
+  std::size_t produced = 0;
+  bz.next_in = const_cast<char *>(stream.data());
+  bz.avail_in = static_cast<unsigned>(stream.size());
+  for (;;) {
+    if (produced == out.size())
+      out.resize(out.size() * 2);
+    bz.next_out = out.data() + produced;
+    bz.avail_out = static_cast<unsigned>(out.size() - produced);
+    auto const ret = BZ2_bzDecompress(&bz);
+    produced = out.size() - bz.avail_out;
+    if (ret == BZ_STREAM_END)
+      break;
+    if (ret != BZ_OK)
+      throw std::ios_base::failure("corrupt bzip2 block (error " +
+                                   std::to_string(ret) + ")");
+    if (bz.avail_in == 0 && bz.avail_out != 0)
+      throw std::ios_base::failure("truncated bzip2 block");
+  }
+  out.resize(produced);
+  return out;
+}
+} // unnamed namespace
+
+/**
+ * @class Bzip2BlockDecoder
+ * @brief State behind BaseParallelBzip2DecompressorImpl: bit scanner,
+ * worker pool and reorder queue.
+ */
+class Bzip2BlockDecoder {
+public:
+  Bzip2BlockDecoder(std::size_t threads, std::size_t max_in_flight)
+      : pool_(threads),
+        max_in_flight_(max_in_flight ? max_in_flight : 2 * pool_.size()) {}
+
+  bool filter(const char *&src_begin, const char *src_end, char *&dest_begin,
+              const char *dest_end, bool flush) {
+    input_.insert(input_.end(), src_begin, src_end);
+    src_begin = src_end;
+
+    for (;;) {
+      auto const blocked = scan(flush);
+      emit(dest_begin, dest_end, flush || blocked);
+      if (dest_begin == dest_end)
+        return true;
+      if (!blocked)
+        break;
+    }
+    return !flush;
+  }
+
+  void reset() {
+    input_.clear();
+    scan_bit_ = 0;
+    block_begin_ = no_block;
+    stage_ = Stage::StreamHeader;
+    pending_.clear();
+    carry_.clear();
+    carry_bits_ = 0;
+    output_.clear();
+    output_offset_ = 0;
+  }
+
+private:
+  enum class Stage { StreamHeader, Blocks, StreamTrailer };
+  enum class Lookahead { No, Yes, NeedInput };
+
+  /**
+   * @brief A candidate block, delimited by block magics that may turn out
+   * to be a bit pattern inside compressed data.
+   */
+  struct Candidate {
+    /** @brief Single-block stream; the block bits start at byte 4. */
+    std::shared_ptr<const std::string> stream;
+    std::uint64_t bits = 0;
+    std::future<std::string> decoded;
+  };
+
+  /**
+   * @brief Whether the end-of-stream magic ending at magic_end is real: the
+   * stream CRC and zero padding must be followed by the end of the input or
+   * by the header of the next stream.
+   */
+  Lookahead check_stream_end(std::uint64_t magic_end, bool flush) const {
+    auto const next = static_cast<std::size_t>((magic_end + 32 + 7) / 8);
+    auto const available = static_cast<std::uint64_t>(input_.size()) * 8;
+    for (auto bit = magic_end + 32; bit < next * 8 && bit < available; ++bit)
+      if (bit_at_impl(input_.data(), bit))
+        return Lookahead::No;
+    if (input_.size() < next + 4) {
+      if (!flush)
+        return Lookahead::NeedInput;
+      return input_.size() == next ? Lookahead::Yes : Lookahead::No;
+    }
+    auto const level = static_cast<char>(input_[next + 3]);
+    return std::memcmp(input_.data() + next, "BZh", 3) == 0 && level >= '1' &&
+                   level <= '9'
+               ? Lookahead::Yes
+               : Lookahead::No;
+  }
+
+  /**
+   * @brief Advance through the buffered input, submitting every complete
+   * block.
+   *
+   * @return true when stopped because max_in_flight blocks are pending.
+   */
+  bool scan(bool flush) {
+    for (;;) {
+      switch (stage_) {
+      case Stage::StreamHeader: {
+        auto const byte = static_cast<std::size_t>(scan_bit_ / 8);
+        if (input_.size() < byte + 4) {
+          if (flush && input_.size() > byte)
+            throw std::ios_base::failure("truncated bzip2 stream header");
+          compact();
+          return false;
+        }
+        auto const level = static_cast<char>(input_[byte + 3]);
+        if (std::memcmp(input_.data() + byte, "BZh", 3) != 0 || level < '1' ||
+            level > '9')
+          throw std::ios_base::failure("not a bzip2 stream");
+        level_ = level;
+        scan_bit_ = (byte + 4) * 8;
+        register_bits_ = 0;
+        block_begin_ = no_block;
+        stage_ = Stage::Blocks;
+        break;
+      }
+
+      case Stage::Blocks: {
+        if (block_begin_ != no_block && pending_.size() >= max_in_flight_)
+          return true;
+
+        auto const end = static_cast<std::uint64_t>(input_.size()) * 8;
+        auto found = false;
+        while (scan_bit_ < end) {
+          register_ = ((register_ << 1) | bit_at_impl(input_.data(), scan_bit_)) &
+                      magic_mask;
+          ++scan_bit_;
+          if (++register_bits_ < 48)
+            continue;
+          if (register_ == block_magic) {
+            found = true;
+            break;
+          }
+          if (register_ == end_magic) {
+            auto const real = check_stream_end(scan_bit_, flush);
+            if (real == Lookahead::Yes) {
+              found = true;
+              break;
+            }
+            if (real == Lookahead::NeedInput) {
+              // Rescan the magic once the bytes after it arrived.
+              scan_bit_ -= 48;
+              register_bits_ = 0;
+              break;
+            }
+          }
+        }
+        if (!found) {
+          if (flush)
+            throw std::ios_base::failure("truncated bzip2 stream");
+          compact();
+          return false;
+        }
+
+        auto const magic_begin = scan_bit_ - 48;
+        if (block_begin_ != no_block)
+          submit(block_begin_, magic_begin);
+        register_bits_ = 0;
+        if (register_ == block_magic) {
+          block_begin_ = magic_begin;
+        } else {
+          block_begin_ = no_block;
+          trailer_end_ = scan_bit_ + 32;
+          stage_ = Stage::StreamTrailer;
+        }
+        break;
+      }
+
+      case Stage::StreamTrailer: {
+        // The combined stream CRC is skipped; libbz2 checks each block.
+        auto const next = (trailer_end_ + 7) / 8;
+        if (input_.size() < next) {
+          if (flush)
+            throw std::ios_base::failure("truncated bzip2 stream trailer");
+          return false;
+        }
+        scan_bit_ = next * 8;
+        stage_ = Stage::StreamHeader;
+        break;
+      }
+      }
+    }
+  }
+
+  /**
+   * @brief Queue the candidate [begin_bit, end_bit), behind the bits of a
+   * failed candidate carried over from emit().
+   */
+  void submit(std::uint64_t begin_bit, std::uint64_t end_bit) {
+    if (carry_bits_ == 0) {
+      pending_.push_back(make_candidate(
+          make_single_block_stream_impl(input_.data(), begin_bit, end_bit,
+                                        level_),
+          end_bit - begin_bit));
+      return;
+    }
+    append_bits_impl(carry_, carry_bits_, input_.data(), begin_bit, end_bit);
+    pending_.push_back(make_candidate(
+        make_single_block_stream_impl(
+            reinterpret_cast<const unsigned char *>(carry_.data()), 0,
+            carry_bits_, level_),
+        carry_bits_));
+    carry_.clear();
+    carry_bits_ = 0;
+  }
+
+  Candidate make_candidate(std::string stream, std::uint64_t bits) {
+    Candidate candidate;
+    candidate.stream = std::make_shared<const std::string>(std::move(stream));
+    candidate.bits = bits;
+    candidate.decoded = pool_.submit(
+        [stream = candidate.stream] { return decode_stream_impl(*stream); });
+    return candidate;
+  }
+
+  /**
+   * @brief Handle a candidate that failed to decode, as lbzip2 does: it
+   * ended at a false block magic, so join it with the candidate after it.
+   * When that one is still being scanned, its bits are carried into
+   * submit().
+   *
+   * @return false when there is nothing to join with, or the joined bits
+   * are too long to be one block: the data is corrupt.
+   */
+  bool join(const Candidate &failed) {
+    std::string bits;
+    std::uint64_t count = 0;
+    auto const block_bits = [](const Candidate &candidate) {
+      return reinterpret_cast<const unsigned char *>(candidate.stream->data()) +
+             4;
+    };
+    append_bits_impl(bits, count, block_bits(failed), 0, failed.bits);
+
+    if (pending_.empty()) {
+      if (block_begin_ == no_block)
+        return false;
+      carry_ = std::move(bits);
+      carry_bits_ = count;
+      return true;
+    }
+    auto next = std::move(pending_.front());
+    pending_.pop_front();
+    append_bits_impl(bits, count, block_bits(next), 0, next.bits);
+    // A block never compresses to more than its uncompressed size, plus
+    // table overhead.
+    if (count > static_cast<std::uint64_t>(level_ - '0') * 100000 * 8 * 2)
+      return false;
+    pending_.push_front(make_candidate(
+        make_single_block_stream_impl(
+            reinterpret_cast<const unsigned char *>(bits.data()), 0, count,
+            level_),
+        count));
+    return true;
+  }
+
+  /**
+   * @brief Drop input bytes that are neither part of the open block nor
+   * still to be scanned. Only done once they make up half the buffer, so
+   * the kept tail is moved a bounded number of times.
+   */
+  void compact() {
+    auto const keep_bit = block_begin_ != no_block ? block_begin_ : scan_bit_;
+    auto const drop = static_cast<std::size_t>(keep_bit / 8);
+    if (drop == 0 || drop < input_.size() / 2)
+      return;
+    input_.erase(input_.begin(),
+                 input_.begin() + static_cast<std::ptrdiff_t>(drop));
+    scan_bit_ -= drop * 8;
+    if (block_begin_ != no_block)
+      block_begin_ -= drop * 8;
+  }
+
+  /**
+   * @brief Copy decoded blocks to the destination in input order.
+   *
+   * @param wait Whether to block on blocks still being decoded.
+   */
+  void emit(char *&dest_begin, const char *dest_end, bool wait) {
+    for (;;) {
+      auto const count =
+          std::min(output_.size() - output_offset_,
+                   static_cast<std::size_t>(dest_end - dest_begin));
+      std::memcpy(dest_begin, output_.data() + output_offset_, count);
+      dest_begin += count;
+      output_offset_ += count;
+      if (dest_begin == dest_end || pending_.empty())
+        return;
+      if (!wait && pending_.front().decoded.wait_for(std::chrono::seconds(0)) !=
+                       std::future_status::ready)
+        return;
+
+      auto candidate = std::move(pending_.front());
+      pending_.pop_front();
+      try {
+        output_ = candidate.decoded.get();
+      } catch (const std::ios_base::failure &) {
+        if (!join(candidate))
+          throw;
+        continue;
+      }
+      output_offset_ = 0;
+    }
+  }
+
+  WorkerPool pool_;
+  std::size_t max_in_flight_;
+  std::vector<unsigned char> input_;
+  std::uint64_t scan_bit_ = 0;
+  std::uint64_t block_begin_ = no_block;
+  std::uint64_t trailer_end_ = 0;
+  std::uint64_t register_ = 0;
+  unsigned register_bits_ = 0;
+  char level_ = '9';
+  Stage stage_ = Stage::StreamHeader;
+  std::deque<Candidate> pending_;
+  std::string carry_;
+  std::uint64_t carry_bits_ = 0;
+  std::string output_;
+  std::size_t output_offset_ = 0;
+};
+
+BaseParallelBzip2DecompressorImpl::BaseParallelBzip2DecompressorImpl(
+    std::size_t threads, std::size_t max_in_flight)
+    : decoder_(std::make_unique<Bzip2BlockDecoder>(threads, max_in_flight)) {}
+
+BaseParallelBzip2DecompressorImpl::~BaseParallelBzip2DecompressorImpl() =
+    default;
+
+bool BaseParallelBzip2DecompressorImpl::filter(const char *&src_begin,
+                                               const char *const src_end,
+                                               char *&dest_begin,
+                                               const char *const dest_end,
+                                               bool flush) {
+  return decoder_->filter(src_begin, src_end, dest_begin, dest_end, flush);
+}
+
+void BaseParallelBzip2DecompressorImpl::close() { decoder_->reset(); }
+} // namespace boost_iostreams_tar_filter::detail
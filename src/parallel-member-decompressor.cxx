@@ -0,0 +1,179 @@
+#include <boost-iostreams-tar-filter/parallel-member-decompressor.hxx>
+
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/bzip2.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/lzma.hpp>
+#include <boost/iostreams/filter/zstd.hpp>
+#include <boost/iostreams/filtering_streambuf.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace boost_iostreams_tar_filter {
+namespace {
+namespace io = boost::iostreams;
+
+/** @brief Largest buffer reservation made from an entry's header size. */
+constexpr std::size_t max_reserve = 16 << 20;
+
+/** @brief Compression formats recognized by member suffix. */
+enum class Codec { None, Gzip, Bzip2, Xz, Zstd };
+
+/**
+ * @brief Check whether a string ends with the given suffix.
+ */
+bool ends_with_impl(const std::string &s, const std::string &suffix) {
+  return s.size() > suffix.size() &&
+         s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/**
+ * @brief Pick the codec of a member from its file name.
+ *
+ * @param entry Entry to inspect.
+ * @param suffix_length Receives the length of the matched suffix.
+ * @return Codec The detected codec; Codec::None for anything else.
+ */
+Codec detect_codec_impl(const Entry &entry, std::size_t &suffix_length) {
+  static const std::pair<const char *, Codec> suffixes[] = {
+      {".gz", Codec::Gzip},
+      {".bz2", Codec::Bzip2},
+      {".xz", Codec::Xz},
+      {".zst", Codec::Zstd},
+  };
+  if (entry.is_regular_file())
+    for (const auto &[suffix, codec] : suffixes)
+      if (ends_with_impl(entry.name, suffix)) {
+        suffix_length = std::char_traits<char>::length(suffix);
+        return codec;
+      }
+  suffix_length = 0;
+  return Codec::None;
+}
+
+/**
+ * @brief Decompress a whole member with the matching Boost.Iostreams filter.
+ */
+std::string decompress_impl(Codec codec, const std::string &data) {
+  io::filtering_istreambuf in;
+  switch (codec) {
+  case Codec::Gzip:
+    in.push(io::gzip_decompressor());
+    break;
+  case Codec::Bzip2:
+    in.push(io::bzip2_decompressor());
+    break;
+  case Codec::Xz:
+    in.push(io::lzma_decompressor());
+    break;
+  case Codec::Zstd:
+    in.push(io::zstd_decompressor());
+    break;
+  case Codec::None:
+    return data;
+  }
+  in.push(io::array_source(data.data(), data.size()));
+
+  std::string out;
+  io::copy(in, io::back_inserter(out));
+  return out;
+}
+} // unnamed namespace
+
+ParallelMemberDecompressor::ParallelMemberDecompressor(
+    EntryVisitor &downstream, std::size_t threads, std::size_t max_in_flight)
+    : downstream_(downstream), pool_(threads),
+      max_in_flight_(max_in_flight ? max_in_flight : 2 * pool_.size()) {}
+
+/**
+ * @brief Decide whether the entry can be streamed straight downstream or has
+ * to be buffered for the pool.
+ */
+bool ParallelMemberDecompressor::on_entry_begin(const Entry &entry) {
+  std::size_t suffix_length = 0;
+  entry_ = entry;
+  buffer_.clear();
+  pass_through_ = pending_.empty() &&
+                  detect_codec_impl(entry, suffix_length) == Codec::None;
+  if (pass_through_)
+    return downstream_.on_entry_begin(entry);
+  // The header size is untrusted; only reserve up to a bounded amount.
+  buffer_.reserve(std::min<std::size_t>(entry.size, max_reserve));
+  return true;
+}
+
+void ParallelMemberDecompressor::on_entry_data(const char *begin,
+                                               const char *end) {
+  if (pass_through_)
+    downstream_.on_entry_data(begin, end);
+  else
+    buffer_.append(begin, end);
+}
+
+/**
+ * @brief Queue the buffered member and apply backpressure once too many
+ * entries are in flight.
+ */
+void ParallelMemberDecompressor::on_entry_end(const Entry &entry) {
+  if (pass_through_) {
+    downstream_.on_entry_end(entry);
+    return;
+  }
+
+  std::size_t suffix_length = 0;
+  auto const codec = detect_codec_impl(entry_, suffix_length);
+  pending_.push_back(pool_.submit(
+      [codec, suffix_length, entry = std::move(entry_),
+       data = std::move(buffer_)]() mutable {
+        Decoded decoded{std::move(entry), decompress_impl(codec, data)};
+        decoded.entry.name.resize(decoded.entry.name.size() - suffix_length);
+        decoded.entry.size = decoded.data.size();
+        return decoded;
+      }));
+  buffer_ = std::string();
+
+  while (pending_.size() > max_in_flight_)
+    emit_front();
+}
+
+/**
+ * @brief Forward whatever is already finished at the head of the reorder
+ * buffer without blocking the reading thread, then let the downstream
+ * visitor flush the pass-through slices of the input buffer.
+ */
+void ParallelMemberDecompressor::on_buffer_end() {
+  while (!pending_.empty() &&
+         pending_.front().wait_for(std::chrono::seconds(0)) ==
+             std::future_status::ready)
+    emit_front();
+  downstream_.on_buffer_end();
+}
+
+void ParallelMemberDecompressor::finish() {
+  while (!pending_.empty())
+    emit_front();
+  downstream_.on_buffer_end();
+}
+
+void ParallelMemberDecompressor::emit_front() {
+  auto future = std::move(pending_.front());
+  pending_.pop_front();
+  emit(future.get());
+}
+
+/**
+ * @brief Forward one decoded entry. Its payload is the buffer lent to the
+ * downstream visitor, so on_buffer_end() follows before it is released.
+ */
+void ParallelMemberDecompressor::emit(Decoded decoded) {
+  if (downstream_.on_entry_begin(decoded.entry) && !decoded.data.empty())
+    downstream_.on_entry_data(decoded.data.data(),
+                              decoded.data.data() + decoded.data.size());
+  downstream_.on_entry_end(decoded.entry);
+  downstream_.on_buffer_end();
+}
+} // namespace boost_iostreams_tar_filter
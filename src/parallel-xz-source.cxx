@@ -0,0 +1,492 @@
+#include <boost-iostreams-tar-filter/detail/worker-pool.hxx>
+#include <boost-iostreams-tar-filter/parallel-xz-source.hxx>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <lzma.h>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace boost_iostreams_tar_filter {
+namespace {
+void read_at_impl(std::istream &in, std::uint64_t offset, void *data,
+                  std::size_t size) {
+  in.clear();
+  in.seekg(static_cast<std::streamoff>(offset));
+  if (!in.read(static_cast<char *>(data), static_cast<std::streamsize>(size)))
+    throw std::ios_base::failure("truncated xz file");
+}
+
+[[noreturn]] void throw_lzma_impl(const char *what, lzma_ret ret) {
+  throw std::ios_base::failure(std::string(what) + " failed (lzma error " +
+                               std::to_string(ret) + ")");
+}
+
+/**
+ * @brief Owner of an lzma_index until it is handed over.
+ */
+struct IndexGuard {
+  lzma_index *index = nullptr;
+  ~IndexGuard() {
+    if (index)
+      lzma_index_end(index, nullptr);
+  }
+};
+
+/**
+ * @brief Read the indexes of every stream, walking backwards from the end
+ * of the file like `xz --list`, and flatten them into a block list.
+ */
+std::vector<XzBlock> read_index_impl(std::istream &in) {
+  in.seekg(0, std::ios_base::end);
+  auto position = static_cast<std::uint64_t>(in.tellg());
+  IndexGuard combined;
+  std::uint64_t padding = 0;
+
+  while (position > 0) {
+    if (position < 2 * LZMA_STREAM_HEADER_SIZE)
+      throw std::ios_base::failure("not an xz file");
+
+    std::uint8_t footer[LZMA_STREAM_HEADER_SIZE];
+    read_at_impl(in, position - sizeof(footer), footer, sizeof(footer));
+    // Stream padding: multiples of four zero bytes after a stream.
+    if (std::all_of(footer + 8, footer + 12, [](auto b) { return b == 0; })) {
+      position -= 4;
+      padding += 4;
+      continue;
+    }
+
+    lzma_stream_flags footer_flags;
+    if (auto ret = lzma_stream_footer_decode(&footer_flags, footer);
+        ret != LZMA_OK)
+      throw_lzma_impl("lzma_stream_footer_decode", ret);
+    if (position < 2 * LZMA_STREAM_HEADER_SIZE + footer_flags.backward_size)
+      throw std::ios_base::failure("corrupt xz index size");
+
+    std::vector<std::uint8_t> buffer(
+        static_cast<std::size_t>(footer_flags.backward_size));
+    read_at_impl(in, position - sizeof(footer) - buffer.size(), buffer.data(),
+                 buffer.size());
+    IndexGuard index;
+    std::uint64_t memlimit = UINT64_MAX;
+    std::size_t in_pos = 0;
+    if (auto ret = lzma_index_buffer_decode(&index.index, &memlimit, nullptr,
+                                            buffer.data(), &in_pos,
+                                            buffer.size());
+        ret != LZMA_OK)
+      throw_lzma_impl("lzma_index_buffer_decode", ret);
+
+    auto const stream_size = lzma_index_stream_size(index.index);
+    if (stream_size > position)
+      throw std::ios_base::failure("corrupt xz index");
+    auto const stream_begin = position - stream_size;
+
+    std::uint8_t header[LZMA_STREAM_HEADER_SIZE];
+    read_at_impl(in, stream_begin, header, sizeof(header));
+    lzma_stream_flags header_flags;
+    if (auto ret = lzma_stream_header_decode(&header_flags, header);
+        ret != LZMA_OK)
+      throw_lzma_impl("lzma_stream_header_decode", ret);
+    if (lzma_stream_flags_compare(&header_flags, &footer_flags) != LZMA_OK)
+      throw std::ios_base::failure("xz stream header and footer differ");
+
+    if (auto ret = lzma_index_stream_flags(index.index, &footer_flags);
+        ret != LZMA_OK)
+      throw_lzma_impl("lzma_index_stream_flags", ret);
+    if (auto ret = lzma_index_stream_padding(index.index, padding);
+        ret != LZMA_OK)
+      throw_lzma_impl("lzma_index_stream_padding", ret);
+    if (combined.index) {
+      // On success the later streams are absorbed into index.
+      if (auto ret = lzma_index_cat(index.index, combined.index, nullptr);
+          ret != LZMA_OK)
+        throw_lzma_impl("lzma_index_cat", ret);
+    }
+    combined.index = std::exchange(index.index, nullptr);
+    position = stream_begin;
+    padding = 0;
+  }
+
+  std::vector<XzBlock> blocks;
+  if (!combined.index)
+    return blocks;
+  lzma_index_iter iter;
+  lzma_index_iter_init(&iter, combined.index);
+  while (!lzma_index_iter_next(&iter, LZMA_INDEX_ITER_BLOCK))
+    blocks.push_back(XzBlock{iter.block.compressed_file_offset,
+                             iter.block.total_size, iter.block.unpadded_size,
+                             iter.block.uncompressed_file_offset,
+                             iter.block.uncompressed_size,
+                             static_cast<std::uint32_t>(
+                                 iter.stream.flags->check)});
+  return blocks;
+}
+
+/** @brief Compressed bytes read, and decoded bytes produced, per step of
+ * an incrementally decoded block. */
+constexpr std::size_t stream_chunk = 64 * 1024;
+
+/**
+ * @brief lzma block decoder for one block, fed the block's data in pieces
+ * after its header.
+ */
+class BlockDecoder {
+public:
+  /**
+   * @param header Start of the block; at least the whole block header.
+   * @param size Bytes available at header.
+   * @param info Index entry of the block.
+   */
+  BlockDecoder(const std::uint8_t *header, std::size_t size,
+               const XzBlock &info)
+      : expected_(info.uncompressed_size) {
+    lzma_filter filters[LZMA_FILTERS_MAX + 1];
+    block_.version = 0;
+    block_.check = static_cast<lzma_check>(info.check);
+    block_.filters = filters;
+    if (size == 0)
+      throw std::ios_base::failure("corrupt xz block header");
+    block_.header_size = lzma_block_header_size_decode(header[0]);
+    if (block_.header_size > size)
+      throw std::ios_base::failure("corrupt xz block header");
+    if (auto ret = lzma_block_header_decode(&block_, nullptr, header);
+        ret != LZMA_OK)
+      throw_lzma_impl("lzma_block_header_decode", ret);
+    // The decoder copies the filter options it needs.
+    struct FilterGuard {
+      lzma_filter *filters;
+      ~FilterGuard() {
+        for (auto f = filters; f->id != LZMA_VLI_UNKNOWN; ++f)
+          std::free(f->options);
+      }
+    } filter_guard{filters};
+    if (auto ret = lzma_block_compressed_size(&block_, info.unpadded_size);
+        ret != LZMA_OK)
+      throw_lzma_impl("lzma_block_compressed_size", ret);
+    if (auto ret = lzma_block_decoder(&stream_, &block_); ret != LZMA_OK)
+      throw_lzma_impl("lzma_block_decoder", ret);
+  }
+  ~BlockDecoder() { lzma_end(&stream_); }
+  BlockDecoder(const BlockDecoder &) = delete;
+  BlockDecoder &operator=(const BlockDecoder &) = delete;
+
+  /** @brief Size of the block header, where the data starts. */
+  std::uint32_t header_size() const { return block_.header_size; }
+
+  /** @brief Whether the whole block, including its check, was decoded. */
+  bool finished() const { return finished_; }
+
+  /**
+   * @brief Decode from [in, in + avail) into out, advancing in and avail.
+   *
+   * @param last Whether no input follows the given bytes.
+   * @return Bytes written to out.
+   * @throws std::ios_base::failure on corrupt data or when the block does
+   * not decode to the size its index entry lists.
+   */
+  std::size_t decode(const std::uint8_t *&in, std::size_t &avail,
+                     std::uint8_t *out, std::size_t size, bool last) {
+    stream_.next_in = in;
+    stream_.avail_in = avail;
+    stream_.next_out = out;
+    stream_.avail_out = size;
+    auto const ret = lzma_code(&stream_, last ? LZMA_FINISH : LZMA_RUN);
+    in = stream_.next_in;
+    avail = stream_.avail_in;
+    auto const produced = size - stream_.avail_out;
+    if (ret == LZMA_STREAM_END)
+      finished_ = true;
+    else if (ret != LZMA_OK)
+      throw_lzma_impl("xz block decoding", ret);
+    if (stream_.total_out > expected_ ||
+        (finished_ && stream_.total_out != expected_))
+      throw std::ios_base::failure(
+          "xz block size differs from its index entry");
+    return produced;
+  }
+
+private:
+  lzma_block block_{};
+  lzma_stream stream_ = LZMA_STREAM_INIT;
+  std::uint64_t expected_;
+  bool finished_ = false;
+};
+
+/**
+ * @brief Decode one complete block (header, data, padding and check) that
+ * fits the per-block limit.
+ */
+std::string decode_block_impl(const std::vector<std::uint8_t> &data,
+                              const XzBlock &info) {
+  BlockDecoder decoder(data.data(), data.size(), info);
+  std::string out(static_cast<std::size_t>(info.uncompressed_size), '\0');
+  const std::uint8_t *in = data.data() + decoder.header_size();
+  std::size_t avail = data.size() - decoder.header_size();
+  std::size_t filled = 0;
+  while (!decoder.finished()) {
+    auto const count = decoder.decode(
+        in, avail, reinterpret_cast<std::uint8_t *>(out.data()) + filled,
+        out.size() - filled, true);
+    if (count == 0 && !decoder.finished() && avail == 0)
+      throw std::ios_base::failure("truncated xz block");
+    filled += count;
+  }
+  return out;
+}
+} // unnamed namespace
+
+namespace detail {
+/**
+ * @class XzBlockReader
+ * @brief State shared by copies of ParallelXzSource: block list, prefetch
+ * queue and read position.
+ *
+ * Compressed blocks are read on the calling thread and decoded on the pool;
+ * pending_ holds the futures of blocks [next_output_, next_submit_). A block
+ * above max_block_size, or the only block of the file, gets an empty future
+ * instead and is decoded on the calling thread in stream_chunk pieces.
+ */
+class XzBlockReader {
+public:
+  XzBlockReader(std::unique_ptr<std::istream> in, std::size_t threads,
+                std::size_t max_in_flight, std::uint64_t max_block_size)
+      : in_(std::move(in)), blocks_(read_index_impl(*in_)), pool_(threads),
+        max_in_flight_(max_in_flight ? max_in_flight : 2 * pool_.size()),
+        max_block_size_(max_block_size) {
+    if (!blocks_.empty())
+      size_ = blocks_.back().uncompressed_offset +
+              blocks_.back().uncompressed_size;
+  }
+
+  std::streamsize read(char *s, std::streamsize n) {
+    std::streamsize total = 0;
+    while (total < n) {
+      if (output_offset_ == output_.size()) {
+        if (streaming_) {
+          if (!streaming_->finished()) {
+            stream_next();
+            continue;
+          }
+          streaming_.reset();
+        }
+        if (next_output_ == blocks_.size())
+          break;
+        prefetch();
+        auto future = std::move(pending_.front());
+        pending_.pop_front();
+        const auto &info = blocks_[next_output_++];
+        if (!future.valid()) {
+          start_streaming(info);
+          continue;
+        }
+        output_ = future.get();
+        output_offset_ = static_cast<std::size_t>(skip_);
+        skip_ = 0;
+        continue;
+      }
+      auto const count = std::min<std::size_t>(
+          output_.size() - output_offset_, static_cast<std::size_t>(n - total));
+      std::memcpy(s + total, output_.data() + output_offset_, count);
+      output_offset_ += count;
+      total += static_cast<std::streamsize>(count);
+    }
+    position_ += static_cast<std::uint64_t>(total);
+    return total > 0 ? total : -1;
+  }
+
+  std::uint64_t seek(std::uint64_t target) {
+    target = std::min(target, size_);
+    if (target >= position_ &&
+        target - position_ <= output_.size() - output_offset_) {
+      output_offset_ += static_cast<std::size_t>(target - position_);
+      position_ = target;
+      return target;
+    }
+    if (streaming_ && target >= position_ && target < streaming_end_) {
+      // Forward within the streamed block: decode on instead of restarting.
+      skip_ += target - position_ - (output_.size() - output_offset_);
+      output_offset_ = output_.size();
+      position_ = target;
+      return target;
+    }
+    streaming_.reset();
+
+    auto const it = std::upper_bound(
+        blocks_.begin(), blocks_.end(), target,
+        [](std::uint64_t value, const XzBlock &block) {
+          return value < block.uncompressed_offset;
+        });
+    auto const block = target == size_
+                           ? blocks_.size()
+                           : static_cast<std::size_t>(it - blocks_.begin()) - 1;
+
+    if (block >= next_output_ && block < next_submit_) {
+      // Already queued: drop the blocks before it, keep the rest.
+      pending_.erase(pending_.begin(),
+                     pending_.begin() +
+                         static_cast<std::ptrdiff_t>(block - next_output_));
+    } else {
+      pending_.clear();
+      next_submit_ = block;
+    }
+    next_output_ = block;
+    output_.clear();
+    output_offset_ = 0;
+    skip_ = block < blocks_.size() ? target - blocks_[block].uncompressed_offset
+                                   : 0;
+    position_ = target;
+    return target;
+  }
+
+  const std::vector<XzBlock> &blocks() const { return blocks_; }
+  std::uint64_t size() const { return size_; }
+  std::uint64_t position() const { return position_; }
+
+private:
+  /**
+   * @brief Queue blocks until max_in_flight are pending.
+   */
+  void prefetch() {
+    while (next_submit_ < blocks_.size() &&
+           (pending_.size() < max_in_flight_ || pending_.empty())) {
+      const auto &info = blocks_[next_submit_++];
+      if (blocks_.size() == 1 || info.compressed_size > max_block_size_ ||
+          info.uncompressed_size > max_block_size_) {
+        pending_.emplace_back();
+        continue;
+      }
+      std::vector<std::uint8_t> data(
+          static_cast<std::size_t>(info.compressed_size));
+      read_at_impl(*in_, info.compressed_offset, data.data(), data.size());
+      pending_.push_back(pool_.submit(
+          [data = std::move(data), info] { return decode_block_impl(data, info); }));
+    }
+  }
+
+  /**
+   * @brief Read the header of a block too large for one job and set up its
+   * incremental decoder.
+   */
+  void start_streaming(const XzBlock &info) {
+    auto const head = static_cast<std::size_t>(
+        std::min<std::uint64_t>(info.compressed_size, stream_chunk));
+    input_.resize(stream_chunk);
+    read_at_impl(*in_, info.compressed_offset, input_.data(), head);
+    streaming_ = std::make_unique<BlockDecoder>(input_.data(), head, info);
+    next_in_ = input_.data() + streaming_->header_size();
+    avail_in_ = head - streaming_->header_size();
+    stream_offset_ = info.compressed_offset + head;
+    stream_left_ = info.compressed_size - head;
+    streaming_end_ = info.uncompressed_offset + info.uncompressed_size;
+    output_.clear();
+    output_offset_ = 0;
+  }
+
+  /**
+   * @brief Decode the next piece of the streamed block into output_,
+   * dropping the bytes a seek skipped.
+   */
+  void stream_next() {
+    output_.resize(stream_chunk);
+    std::size_t produced = 0;
+    while (produced == 0 && !streaming_->finished()) {
+      if (avail_in_ == 0 && stream_left_ > 0) {
+        auto const count = static_cast<std::size_t>(
+            std::min<std::uint64_t>(stream_left_, input_.size()));
+        read_at_impl(*in_, stream_offset_, input_.data(), count);
+        stream_offset_ += count;
+        stream_left_ -= count;
+        next_in_ = input_.data();
+        avail_in_ = count;
+      } else if (avail_in_ == 0) {
+        throw std::ios_base::failure("truncated xz block");
+      }
+      produced = streaming_->decode(
+          next_in_, avail_in_, reinterpret_cast<std::uint8_t *>(output_.data()),
+          output_.size(), stream_left_ == 0);
+    }
+    output_.resize(produced);
+    output_offset_ =
+        static_cast<std::size_t>(std::min<std::uint64_t>(skip_, produced));
+    skip_ -= output_offset_;
+  }
+
+  std::unique_ptr<std::istream> in_;
+  std::vector<XzBlock> blocks_;
+  std::uint64_t size_ = 0;
+  WorkerPool pool_;
+  std::size_t max_in_flight_;
+  std::uint64_t max_block_size_;
+  std::unique_ptr<BlockDecoder> streaming_; /**< @brief Decoder of the block
+                                               being streamed, if any. */
+  std::vector<std::uint8_t> input_;
+  const std::uint8_t *next_in_ = nullptr;
+  std::size_t avail_in_ = 0;
+  std::uint64_t stream_offset_ = 0; /**< @brief File offset of the next
+                                       compressed bytes of that block. */
+  std::uint64_t stream_left_ = 0;
+  std::uint64_t streaming_end_ = 0; /**< @brief End of that block in the
+                                       decoded stream. */
+  std::deque<std::future<std::string>> pending_;
+  std::size_t next_submit_ = 0;
+  std::size_t next_output_ = 0;
+  std::string output_;
+  std::size_t output_offset_ = 0;
+  std::uint64_t skip_ = 0;
+  std::uint64_t position_ = 0;
+};
+} // namespace detail
+
+namespace {
+std::unique_ptr<std::istream> open_impl(const std::filesystem::path &path) {
+  auto in = std::make_unique<std::ifstream>(path, std::ios::binary);
+  if (!*in)
+    throw std::system_error(errno, std::generic_category(),
+                            "cannot open " + path.string());
+  return in;
+}
+} // unnamed namespace
+
+ParallelXzSource::ParallelXzSource(const std::filesystem::path &path,
+                                   std::size_t threads,
+                                   std::size_t max_in_flight,
+                                   std::uint64_t max_block_size)
+    : ParallelXzSource(open_impl(path), threads, max_in_flight,
+                       max_block_size) {}
+
+ParallelXzSource::ParallelXzSource(std::unique_ptr<std::istream> in,
+                                   std::size_t threads,
+                                   std::size_t max_in_flight,
+                                   std::uint64_t max_block_size)
+    : reader_(std::make_shared<detail::XzBlockReader>(
+          std::move(in), threads, max_in_flight, max_block_size)) {}
+
+std::streamsize ParallelXzSource::read(char *s, std::streamsize n) {
+  return reader_->read(s, n);
+}
+
+std::streampos ParallelXzSource::seek(boost::iostreams::stream_offset off,
+                                      std::ios_base::seekdir way) {
+  std::int64_t base = 0;
+  if (way == std::ios_base::cur)
+    base = static_cast<std::int64_t>(reader_->position());
+  else if (way == std::ios_base::end)
+    base = static_cast<std::int64_t>(reader_->size());
+  auto const target = std::max<std::int64_t>(0, base + off);
+  return boost::iostreams::offset_to_position(
+      static_cast<boost::iostreams::stream_offset>(
+          reader_->seek(static_cast<std::uint64_t>(target))));
+}
+
+const std::vector<XzBlock> &ParallelXzSource::blocks() const {
+  return reader_->blocks();
+}
+
+std::uint64_t ParallelXzSource::size() const { return reader_->size(); }
+} // namespace boost_iostreams_tar_filter
@@ -0,0 +1,67 @@
+#include <boost-iostreams-tar-filter/pipe-source.hxx>
+
+#include <cerrno>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/stat.h>
+#include <system_error>
+
+namespace boost_iostreams_tar_filter {
+namespace {
+/**
+ * @brief Grow a pipe to size bytes, or to the unprivileged maximum when that
+ * is smaller. Failures leave the pipe as it was.
+ */
+void set_pipe_size_impl(int fd, std::size_t size) {
+  if (::fcntl(fd, F_SETPIPE_SZ, static_cast<int>(size)) >= 0 || errno != EPERM)
+    return;
+  std::size_t max_size = 0;
+  std::ifstream("/proc/sys/fs/pipe-max-size") >> max_size;
+  if (max_size > 0 && max_size < size)
+    ::fcntl(fd, F_SETPIPE_SZ, static_cast<int>(max_size));
+}
+} // unnamed namespace
+
+PipeSource::PipeSource(int fd, std::size_t pipe_size)
+    : fd_(fd), buffer_size_(default_pipe_size) {
+  struct stat st;
+  if (::fstat(fd, &st) < 0)
+    throw std::system_error(errno, std::generic_category(), "fstat");
+  is_pipe_ = S_ISFIFO(st.st_mode);
+  if (!is_pipe_) {
+    if (S_ISREG(st.st_mode))
+      ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    return;
+  }
+
+  if (pipe_size > 0)
+    set_pipe_size_impl(fd, pipe_size);
+  if (auto const size = ::fcntl(fd, F_GETPIPE_SZ); size > 0)
+    buffer_size_ = static_cast<std::size_t>(size);
+}
+
+/**
+ * @brief Keep reading while the writer is slower than us, so each call
+ * returns one full buffer instead of whatever the last write left.
+ */
+std::streamsize PipeSource::read(char *s, std::streamsize n) {
+  std::streamsize total = 0;
+  while (total < n) {
+    auto const count =
+        ::read(fd_, s + total, static_cast<std::size_t>(n - total));
+    if (count < 0) {
+      if (errno == EINTR)
+        continue;
+      throw std::system_error(errno, std::generic_category(), "read");
+    }
+    if (count == 0)
+      break;
+    total += count;
+  }
+  return total == 0 && n > 0 ? -1 : total;
+}
+
+std::streamsize PipeSource::optimal_buffer_size() const {
+  return static_cast<std::streamsize>(buffer_size_);
+}
+} // namespace boost_iostreams_tar_filter
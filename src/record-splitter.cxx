@@ -0,0 +1,84 @@
+#include <boost-iostreams-tar-filter/record-splitter.hxx>
+
+#include <cstring>
+#include <memory>
+#include <utility>
+
+namespace boost_iostreams_tar_filter {
+RecordSplitter::RecordSplitter(Parser parser, std::size_t threads,
+                               std::size_t batch_records, char delimiter)
+    : parser_(std::move(parser)), pool_(threads),
+      batch_records_(batch_records ? batch_records : 1),
+      delimiter_(delimiter) {}
+
+bool RecordSplitter::on_entry_begin(const Entry &entry) {
+  batch_ = RecordBatch{};
+  batch_.entry_name = entry.name;
+  return entry.is_regular_file();
+}
+
+/**
+ * @brief Append the slice to the current batch and record the position of
+ * every delimiter found in it.
+ *
+ * Bytes after the last delimiter stay at the tail of the batch and become the
+ * start of the next record, which is how records straddling two input
+ * buffers are reassembled.
+ */
+void RecordSplitter::on_entry_data(const char *begin, const char *end) {
+  while (begin < end) {
+    auto const found = static_cast<const char *>(
+        std::memchr(begin, delimiter_, static_cast<std::size_t>(end - begin)));
+    if (!found) {
+      batch_.data.append(begin, end);
+      break;
+    }
+    batch_.data.append(begin, found + 1);
+    batch_.ends.push_back(batch_.data.size() - 1);
+    begin = found + 1;
+    if (batch_.ends.size() == batch_records_)
+      dispatch();
+  }
+}
+
+/**
+ * @brief Emit the unterminated tail of the entry as a last record and flush
+ * the batch so it never mixes with the next entry.
+ */
+void RecordSplitter::on_entry_end(const Entry &) {
+  auto const tail_begin = batch_.ends.empty() ? 0 : batch_.ends.back() + 1;
+  if (batch_.data.size() > tail_begin)
+    batch_.ends.push_back(batch_.data.size());
+  if (!batch_.ends.empty())
+    dispatch();
+}
+
+void RecordSplitter::finish() {
+  while (!pending_.empty()) {
+    auto future = std::move(pending_.front());
+    pending_.pop_front();
+    future.get();
+  }
+}
+
+/**
+ * @brief Hand the current batch to the pool and start a new one, blocking
+ * once too many batches are waiting to be parsed.
+ */
+void RecordSplitter::dispatch() {
+  RecordBatch next;
+  next.entry_name = batch_.entry_name;
+  next.sequence = batch_.sequence + 1;
+  next.first_record = batch_.first_record + batch_.ends.size();
+
+  auto batch = std::make_shared<RecordBatch>(std::move(batch_));
+  batch_ = std::move(next);
+  pending_.push_back(pool_.submit([this, batch] { parser_(*batch); }));
+
+  while (pending_.size() > 2 * pool_.size()) {
+    auto future = std::move(pending_.front());
+    pending_.pop_front();
+    future.get();
+  }
+}
+} // namespace boost_iostreams_tar_filter
@@ -0,0 +1,30 @@
+#include <boost-iostreams-tar-filter/detail/sanitize-path.hxx>
+
+#include <system_error>
+
+namespace boost_iostreams_tar_filter::detail {
+/**
+ * @brief Rebuild the path component by component so entries cannot escape
+ * the extraction root.
+ */
+std::string sanitize_path(const std::string &name) {
+  std::string result;
+  std::size_t pos = 0;
+  while (pos < name.size()) {
+    auto next = name.find('/', pos);
+    if (next == std::string::npos)
+      next = name.size();
+    auto const component = name.substr(pos, next - pos);
+    pos = next + 1;
+    if (component.empty() || component == ".")
+      continue;
+    if (component == "..")
+      throw std::system_error(std::make_error_code(std::errc::invalid_argument),
+                              "refusing to extract " + name);
+    if (!result.empty())
+      result += '/';
+    result += component;
+  }
+  return result;
+}
+} // namespace boost_iostreams_tar_filter::detail
@@ -0,0 +1,151 @@
+#include <boost-iostreams-tar-filter/sha256.hxx>
+
+#include <algorithm>
+#include <cstring>
+
+namespace boost_iostreams_tar_filter {
+namespace {
+constexpr std::uint32_t round_constants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+inline std::uint32_t rotr(std::uint32_t x, int n) {
+  return (x >> n) | (x << (32 - n));
+}
+} // unnamed namespace
+
+void Sha256::reset() {
+  state_ = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+            0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+  block_size_ = 0;
+  length_ = 0;
+}
+
+/**
+ * @brief Absorb input, compressing whole blocks straight from the caller's
+ * buffer and only staging the partial tail.
+ */
+void Sha256::update(const void *data, std::size_t size) {
+  auto p = static_cast<const std::uint8_t *>(data);
+  length_ += size;
+
+  if (block_size_ > 0) {
+    auto const take = std::min(size, block_.size() - block_size_);
+    std::memcpy(block_.data() + block_size_, p, take);
+    block_size_ += take;
+    p += take;
+    size -= take;
+    if (block_size_ < block_.size())
+      return;
+    compress(block_.data());
+    block_size_ = 0;
+  }
+  for (; size >= 64; p += 64, size -= 64)
+    compress(p);
+  std::memcpy(block_.data(), p, size);
+  block_size_ = size;
+}
+
+Digest Sha256::finish() {
+  auto const bits = length_ * 8;
+  static const std::uint8_t padding[64] = {0x80};
+  update(padding, 1 + (119 - block_size_) % 64);
+  std::uint8_t length[8];
+  for (int i = 0; i < 8; ++i)
+    length[i] = static_cast<std::uint8_t>(bits >> (56 - 8 * i));
+  update(length, sizeof(length));
+
+  Digest digest;
+  for (std::size_t i = 0; i < state_.size(); ++i)
+    for (std::size_t j = 0; j < 4; ++j)
+      digest[4 * i + j] = static_cast<std::uint8_t>(state_[i] >> (24 - 8 * j));
+  reset();
+  return digest;
+}
+
+Digest Sha256::digest(const void *data, std::size_t size) {
+  Sha256 sha;
+  sha.update(data, size);
+  return sha.finish();
+}
+
+void Sha256::compress(const std::uint8_t *block) {
+  std::uint32_t w[64];
+  for (int i = 0; i < 16; ++i)
+    w[i] = (std::uint32_t(block[4 * i]) << 24) |
+           (std::uint32_t(block[4 * i + 1]) << 16) |
+           (std::uint32_t(block[4 * i + 2]) << 8) | block[4 * i + 3];
+  for (int i = 16; i < 64; ++i) {
+    auto const s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+    auto const s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+  }
+
+  auto a = state_[0], b = state_[1], c = state_[2], d = state_[3];
+  auto e = state_[4], f = state_[5], g = state_[6], h = state_[7];
+  for (int i = 0; i < 64; ++i) {
+    auto const s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+    auto const ch = (e & f) ^ (~e & g);
+    auto const t1 = h + s1 + ch + round_constants[i] + w[i];
+    auto const s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+    auto const maj = (a & b) ^ (a & c) ^ (b & c);
+    auto const t2 = s0 + maj;
+    h = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + t2;
+  }
+  state_[0] += a;
+  state_[1] += b;
+  state_[2] += c;
+  state_[3] += d;
+  state_[4] += e;
+  state_[5] += f;
+  state_[6] += g;
+  state_[7] += h;
+}
+
+std::string to_hex(const Digest &digest) {
+  static const char digits[] = "0123456789abcdef";
+  std::string text(digest.size() * 2, '0');
+  for (std::size_t i = 0; i < digest.size(); ++i) {
+    text[2 * i] = digits[digest[i] >> 4];
+    text[2 * i + 1] = digits[digest[i] & 0xf];
+  }
+  return text;
+}
+
+bool from_hex(const std::string &text, Digest &digest) {
+  if (text.size() != digest.size() * 2)
+    return false;
+  auto nibble = [](char c) -> int {
+    if (c >= '0' && c <= '9')
+      return c - '0';
+    if (c >= 'a' && c <= 'f')
+      return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+      return c - 'A' + 10;
+    return -1;
+  };
+  for (std::size_t i = 0; i < digest.size(); ++i) {
+    auto const hi = nibble(text[2 * i]), lo = nibble(text[2 * i + 1]);
+    if (hi < 0 || lo < 0)
+      return false;
+    digest[i] = static_cast<std::uint8_t>((hi << 4) | lo);
+  }
+  return true;
+}
+} // namespace boost_iostreams_tar_filter
@@ -0,0 +1,163 @@
+#include <boost-iostreams-tar-filter/detail/base-tar-filter-impl.hxx>
+#include <boost-iostreams-tar-filter/tar-follower.hxx>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <fcntl.h>
+#include <ios>
+#include <poll.h>
+#include <string>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+#include <vector>
+
+namespace boost_iostreams_tar_filter {
+namespace {
+/** @brief Events that may mean the followed file changed. */
+constexpr std::uint32_t watched_events =
+    IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF;
+
+/**
+ * @brief Owner of a file descriptor.
+ */
+struct FdGuard {
+  int fd = -1;
+  ~FdGuard() {
+    if (fd >= 0)
+      ::close(fd);
+  }
+};
+
+[[noreturn]] void throw_errno_impl(const std::string &what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+
+std::uint64_t file_size_impl(int fd, bool *unlinked = nullptr) {
+  struct stat st;
+  if (::fstat(fd, &st) < 0)
+    throw_errno_impl("fstat");
+  if (unlinked)
+    *unlinked = st.st_nlink == 0;
+  return static_cast<std::uint64_t>(st.st_size);
+}
+
+/**
+ * @brief Sleep until the inotify watch reports events or the stop eventfd
+ * is signalled.
+ *
+ * @return The union of the drained event masks, or 0 on a stop request.
+ */
+std::uint32_t wait_impl(int inotify_fd, int stop_fd) {
+  pollfd fds[2] = {{inotify_fd, POLLIN, 0}, {stop_fd, POLLIN, 0}};
+  for (;;) {
+    if (::poll(fds, 2, -1) < 0) {
+      if (errno == EINTR)
+        continue;
+      throw_errno_impl("poll");
+    }
+    if (fds[1].revents != 0)
+      return 0;
+
+    std::uint32_t mask = 0;
+    alignas(inotify_event) char events[4096];
+    for (;;) {
+      auto const count = ::read(inotify_fd, events, sizeof(events));
+      if (count < 0) {
+        if (errno == EINTR)
+          continue;
+        if (errno == EAGAIN)
+          break;
+        throw_errno_impl("inotify read");
+      }
+      for (auto p = events; p < events + count;) {
+        auto const event = reinterpret_cast<const inotify_event *>(p);
+        mask |= event->mask;
+        p += sizeof(inotify_event) + event->len;
+      }
+    }
+    if (mask != 0)
+      return mask;
+  }
+}
+} // unnamed namespace
+
+/**
+ * @brief pread() loop over BaseTarFilterImpl::visit(); reaching the end of
+ * the file waits for inotify instead of ending the archive.
+ */
+bool follow_tar(const std::filesystem::path &path, EntryVisitor &visitor,
+                std::stop_token stop, std::size_t buffer_size) {
+  FdGuard file{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+  if (file.fd < 0)
+    throw_errno_impl("cannot open " + path.string());
+  FdGuard watch{::inotify_init1(IN_NONBLOCK | IN_CLOEXEC)};
+  if (watch.fd < 0)
+    throw_errno_impl("inotify_init1");
+  // Added before the first read, so appends racing with it still wake us.
+  if (::inotify_add_watch(watch.fd, path.c_str(), watched_events) < 0)
+    throw_errno_impl("cannot watch " + path.string());
+  FdGuard wakeup{::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)};
+  if (wakeup.fd < 0)
+    throw_errno_impl("eventfd");
+  std::stop_callback on_stop(stop, [fd = wakeup.fd] {
+    std::uint64_t const one = 1;
+    while (::write(fd, &one, sizeof(one)) < 0 && errno == EINTR) {
+    }
+  });
+
+  detail::BaseTarFilterImpl impl;
+  std::vector<char> buffer(buffer_size);
+  std::uint64_t offset = 0;
+  bool gone = false;
+  while (!stop.stop_requested()) {
+    if (auto const pending = impl.pending_discard();
+        pending >= buffer.size()) {
+      auto const size = file_size_impl(file.fd);
+      if (size < offset)
+        throw std::ios_base::failure("followed archive was truncated");
+      auto const skip = static_cast<std::size_t>(
+          std::min<std::uint64_t>(pending, size - offset));
+      if (skip > 0) {
+        impl.discard(skip, visitor);
+        visitor.on_buffer_end();
+        offset += skip;
+        continue;
+      }
+    }
+
+    auto const count = ::pread(file.fd, buffer.data(), buffer.size(),
+                               static_cast<off_t>(offset));
+    if (count < 0) {
+      if (errno == EINTR)
+        continue;
+      throw_errno_impl("read " + path.string());
+    }
+    if (count > 0) {
+      offset += static_cast<std::uint64_t>(count);
+      const char *begin = buffer.data();
+      impl.visit(begin, begin + count, visitor);
+      visitor.on_buffer_end();
+      if (impl.state == detail::BaseTarFilterImpl::State::Done)
+        return true;
+      continue;
+    }
+
+    // Caught up with the writer.
+    bool unlinked = false;
+    if (file_size_impl(file.fd, &unlinked) < offset)
+      throw std::ios_base::failure("followed archive was truncated");
+    if (gone || unlinked)
+      return false;
+    auto const mask = wait_impl(watch.fd, wakeup.fd);
+    if (mask == 0)
+      return false;
+    // Parse what the last writes added before giving up on the file.
+    gone = (mask & (IN_MOVE_SELF | IN_DELETE_SELF | IN_IGNORED)) != 0;
+  }
+  return false;
+}
+} // namespace boost_iostreams_tar_filter
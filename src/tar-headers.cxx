@@ -0,0 +1,62 @@
+#include <boost-iostreams-tar-filter/detail/base-tar-filter-impl.hxx>
+#include <boost-iostreams-tar-filter/detail/tar-headers.hxx>
+
+#include <cerrno>
+#include <system_error>
+#include <unistd.h>
+
+namespace boost_iostreams_tar_filter::detail {
+bool TarHeaderParser::on_entry_begin(const Entry &entry) {
+  entry_ = entry;
+  started_ = true;
+  return false;
+}
+
+bool TarHeaderParser::feed(const char *block) {
+  started_ = false;
+  const char *begin = block;
+  return impl_.visit(begin, begin + 512, *this);
+}
+
+std::uint64_t TarHeaderParser::skip_payload() {
+  auto const pending = impl_.pending_discard();
+  impl_.discard(pending, *this);
+  return pending;
+}
+
+/**
+ * @brief Every entry's payload is padded to 512 bytes and skipped by
+ * offset; the blocks of extension records are fed to the parser.
+ */
+bool walk_tar_headers(
+    int fd, const std::string &name,
+    const std::function<bool(const Entry &, std::uint64_t)> &on_entry) {
+  std::uint64_t offset = 0;
+  char header[512];
+  TarHeaderParser parser;
+  for (;;) {
+    std::size_t filled = 0;
+    while (filled < sizeof(header)) {
+      auto const count =
+          ::pread(fd, header + filled, sizeof(header) - filled,
+                  static_cast<off_t>(offset + filled));
+      if (count < 0) {
+        if (errno == EINTR)
+          continue;
+        throw std::system_error(errno, std::generic_category(),
+                                "read " + name);
+      }
+      if (count == 0)
+        return false;
+      filled += static_cast<std::size_t>(count);
+    }
+    offset += sizeof(header);
+
+    if (!parser.feed(header))
+      return true;
+    if (parser.entry() && !on_entry(*parser.entry(), offset))
+      return false;
+    offset += parser.skip_payload();
+  }
+}
+} // namespace boost_iostreams_tar_filter::detail
@@ -0,0 +1,94 @@
+#include <boost-iostreams-tar-filter/detail/base-tar-filter-impl.hxx>
+#include <boost-iostreams-tar-filter/detail/gzip-inflater.hxx>
+#include <boost-iostreams-tar-filter/detail/visit-loop.hxx>
+#include <boost-iostreams-tar-filter/tar-reader.hxx>
+#include <cerrno>
+#include <fstream>
+#include <ios>
+#include <system_error>
+#include <vector>
+
+namespace boost_iostreams_tar_filter {
+bool detail::is_seekable(std::istream &in) {
+  try {
+    return in.rdbuf() &&
+           in.rdbuf()->pubseekoff(0, std::ios_base::cur, std::ios_base::in) !=
+               std::streampos(-1);
+  } catch (const std::exception &) {
+    return false;
+  }
+}
+
+bool visit_tar(std::istream &in, EntryVisitor &visitor,
+               std::size_t buffer_size) {
+  detail::BaseTarFilterImpl impl;
+  std::vector<char> buffer(buffer_size);
+  return detail::visit_stream(in, impl, visitor, buffer);
+}
+
+bool visit_tar_volumes(const VolumeOpener &open_volume, EntryVisitor &visitor,
+                       std::size_t buffer_size) {
+  detail::BaseTarFilterImpl impl;
+  std::vector<char> buffer(buffer_size);
+  for (std::size_t volume = 0;; ++volume) {
+    auto const in = open_volume(volume);
+    if (!in)
+      return false;
+    if (volume > 0)
+      impl.begin_volume();
+    if (detail::visit_stream(*in, impl, visitor, buffer))
+      return true;
+  }
+}
+
+bool visit_tar_volumes(const std::vector<std::filesystem::path> &volumes,
+                       EntryVisitor &visitor, std::size_t buffer_size) {
+  return visit_tar_volumes(
+      [&](std::size_t volume) -> std::unique_ptr<std::istream> {
+        if (volume >= volumes.size())
+          return nullptr;
+        auto in =
+            std::make_unique<std::ifstream>(volumes[volume], std::ios::binary);
+        if (!*in)
+          throw std::system_error(errno, std::generic_category(),
+                                  "cannot open " + volumes[volume].string());
+        return in;
+      },
+      visitor, buffer_size);
+}
+
+/**
+ * @brief Same loop as visit_tar(), with GzipInflater::read() filling the
+ * buffer instead of std::istream::read().
+ *
+ * Discarded ranges of at least one buffer are inflated into the inflater's
+ * scratch window and never reach the parser.
+ */
+bool visit_tar_gz(std::istream &in, EntryVisitor &visitor,
+                  std::size_t buffer_size, bool verify_crc) {
+  detail::BaseTarFilterImpl impl;
+  detail::GzipInflater inflater(in, verify_crc);
+  std::vector<char> buffer(buffer_size);
+
+  while (impl.state != detail::BaseTarFilterImpl::State::Done) {
+    if (auto const pending = impl.pending_discard();
+        pending >= buffer.size()) {
+      auto const discarded = inflater.discard(pending);
+      impl.discard(static_cast<std::size_t>(discarded), visitor);
+      visitor.on_buffer_end();
+      if (discarded < pending)
+        break;
+      continue;
+    }
+
+    auto const count = inflater.read(buffer.data(), buffer.size());
+    if (count == 0)
+      break;
+
+    const char *begin = buffer.data();
+    impl.visit(begin, begin + count, visitor);
+    visitor.on_buffer_end();
+  }
+  return impl.state == detail::BaseTarFilterImpl::State::Done;
+}
+} // namespace boost_iostreams_tar_filter
@@ -0,0 +1,101 @@
+#include <boost-iostreams-tar-filter/detail/tar-headers.hxx>
+#include <boost-iostreams-tar-filter/tar-splice.hxx>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <fcntl.h>
+#include <ios>
+#include <sys/sendfile.h>
+#include <system_error>
+#include <unistd.h>
+
+namespace boost_iostreams_tar_filter {
+namespace {
+/** @brief Largest transfer requested from the kernel at once. */
+constexpr std::size_t max_transfer = 1 << 30;
+
+/**
+ * @brief Move size bytes at offset of in_fd to out_fd: splice() into a pipe,
+ * sendfile() into anything else.
+ */
+void transfer_impl(int in_fd, std::uint64_t offset, std::uint64_t size,
+                   int out_fd) {
+  auto use_splice = true;
+  while (size > 0) {
+    auto const chunk =
+        static_cast<std::size_t>(std::min<std::uint64_t>(size, max_transfer));
+    ssize_t count;
+    if (use_splice) {
+      auto position = static_cast<loff_t>(offset);
+      count = ::splice(in_fd, &position, out_fd, nullptr, chunk,
+                       SPLICE_F_MOVE | SPLICE_F_MORE);
+    } else {
+      auto position = static_cast<off_t>(offset);
+      count = ::sendfile(out_fd, in_fd, &position, chunk);
+    }
+    if (count < 0) {
+      if (errno == EINTR)
+        continue;
+      if (use_splice && errno == EINVAL) {
+        use_splice = false;
+        continue;
+      }
+      throw std::system_error(errno, std::generic_category(), "splice");
+    }
+    if (count == 0)
+      throw std::ios_base::failure("tar payload extends past end of file");
+    offset += static_cast<std::uint64_t>(count);
+    size -= static_cast<std::uint64_t>(count);
+  }
+}
+
+/** @brief Archive descriptor, closed on scope exit. */
+struct Descriptor {
+  int fd;
+
+  explicit Descriptor(const std::filesystem::path &archive)
+      : fd(::open(archive.c_str(), O_RDONLY | O_CLOEXEC)) {
+    if (fd < 0)
+      throw std::system_error(errno, std::generic_category(),
+                              "cannot open " + archive.string());
+  }
+  Descriptor(const Descriptor &) = delete;
+  Descriptor &operator=(const Descriptor &) = delete;
+  ~Descriptor() { ::close(fd); }
+};
+} // unnamed namespace
+
+bool splice_tar_entries(const std::filesystem::path &archive, int out_fd,
+                        const std::function<bool(const Entry &)> &select) {
+  Descriptor const in{archive};
+  return detail::walk_tar_headers(
+      in.fd, archive.string(),
+      [&](const Entry &entry, std::uint64_t payload_offset) {
+        if (select(entry) && entry.is_regular_file())
+          transfer_impl(in.fd, payload_offset, entry.size, out_fd);
+        return true;
+      });
+}
+
+std::optional<Entry> splice_tar_entry(const std::filesystem::path &archive,
+                                      const std::string &name, int out_fd) {
+  // The last entry of the path decides, as in extraction, so every header
+  // is read before anything is sent.
+  Descriptor const in{archive};
+  std::optional<Entry> found;
+  std::uint64_t found_offset = 0;
+  detail::walk_tar_headers(
+      in.fd, archive.string(),
+      [&](const Entry &entry, std::uint64_t payload_offset) {
+        if (entry.name == name) {
+          found = entry;
+          found_offset = payload_offset;
+        }
+        return true;
+      });
+  if (found && found->is_regular_file())
+    transfer_impl(in.fd, found_offset, found->size, out_fd);
+  return found;
+}
+} // namespace boost_iostreams_tar_filter
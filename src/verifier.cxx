@@ -0,0 +1,203 @@
+#include <boost-iostreams-tar-filter/detail/sanitize-path.hxx>
+#include <boost-iostreams-tar-filter/detail/worker-pool.hxx>
+#include <boost-iostreams-tar-filter/tar-reader.hxx>
+#include <boost-iostreams-tar-filter/verifier.hxx>
+
+#include <algorithm>
+#include <fcntl.h>
+#include <future>
+#include <ios>
+#include <optional>
+#include <sstream>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <unordered_map>
+
+namespace boost_iostreams_tar_filter {
+namespace {
+/** @brief Manifest entries handed to one worker job. */
+constexpr std::size_t files_per_job = 64;
+
+/**
+ * @brief Hash a file from disk.
+ *
+ * @return The digest, or std::nullopt when the file cannot be read.
+ */
+std::optional<Digest> hash_file_impl(const std::filesystem::path &path) {
+  auto const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return std::nullopt;
+  ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+  Sha256 sha;
+  std::vector<char> buffer(1 << 20);
+  for (;;) {
+    auto const count = ::read(fd, buffer.data(), buffer.size());
+    if (count < 0) {
+      if (errno == EINTR)
+        continue;
+      ::close(fd);
+      return std::nullopt;
+    }
+    if (count == 0)
+      break;
+    sha.update(buffer.data(), static_cast<std::size_t>(count));
+  }
+  ::close(fd);
+  return sha.finish();
+}
+
+/**
+ * @brief Visitor hashing every regular file into a manifest.
+ *
+ * A path stored more than once keeps one entry, describing its last copy
+ * like extraction does; a later non-regular entry of the path removes it.
+ */
+class ManifestVisitor : public EntryVisitor {
+public:
+  bool on_entry_begin(const Entry &entry) override {
+    path_ = detail::sanitize_path(entry.name);
+    if (entry.is_regular_file())
+      return true;
+    if (auto it = positions_.find(path_); it != positions_.end()) {
+      removed_[it->second] = true;
+      positions_.erase(it);
+    }
+    return false;
+  }
+  void on_entry_data(const char *begin, const char *end) override {
+    sha_.update(begin, static_cast<std::size_t>(end - begin));
+  }
+  void on_entry_end(const Entry &entry) override {
+    if (!entry.is_regular_file())
+      return;
+    ManifestEntry manifest_entry{std::move(path_), entry.size, sha_.finish()};
+    auto [it, inserted] =
+        positions_.try_emplace(manifest_entry.path, manifest_.size());
+    if (inserted) {
+      manifest_.push_back(std::move(manifest_entry));
+      removed_.push_back(false);
+    } else {
+      manifest_[it->second] = std::move(manifest_entry);
+    }
+  }
+
+  /** @brief The manifest, in the order the paths first appeared. */
+  Manifest finish() {
+    Manifest manifest;
+    manifest.reserve(positions_.size());
+    for (std::size_t i = 0; i < manifest_.size(); ++i)
+      if (!removed_[i])
+        manifest.push_back(std::move(manifest_[i]));
+    return manifest;
+  }
+
+private:
+  Sha256 sha_;
+  std::string path_;
+  Manifest manifest_;
+  std::vector<bool> removed_;
+  std::unordered_map<std::string, std::size_t> positions_;
+};
+} // unnamed namespace
+
+Manifest read_manifest(std::istream &in) {
+  Manifest manifest;
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty())
+      continue;
+    std::istringstream fields(line);
+    std::string hex;
+    ManifestEntry entry;
+    if (!(fields >> hex >> entry.size) || !from_hex(hex, entry.digest))
+      throw std::ios_base::failure("malformed manifest line: " + line);
+    fields >> std::ws;
+    std::getline(fields, entry.path);
+    if (entry.path.empty())
+      throw std::ios_base::failure("malformed manifest line: " + line);
+    manifest.push_back(std::move(entry));
+  }
+  return manifest;
+}
+
+void write_manifest(std::ostream &out, const Manifest &manifest) {
+  for (const auto &entry : manifest)
+    out << to_hex(entry.digest) << ' ' << entry.size << ' ' << entry.path
+        << '\n';
+}
+
+Manifest manifest_from_tar(std::istream &in) {
+  ManifestVisitor visitor;
+  visit_tar(in, visitor);
+  return visitor.finish();
+}
+
+/**
+ * @brief Split the manifest into fixed-size jobs, verify them on the pool
+ * and merge the per-job mismatches back in manifest order.
+ */
+VerificationReport
+verify_extraction(const std::filesystem::path &root, const Manifest &manifest,
+                  const std::unordered_map<std::string, Digest> *digests,
+                  std::size_t threads) {
+  struct JobResult {
+    std::vector<Mismatch> mismatches;
+    std::size_t rehashed = 0;
+  };
+
+  auto verify_range = [&](std::size_t begin, std::size_t end) {
+    JobResult result;
+    for (auto i = begin; i < end; ++i) {
+      const auto &expected = manifest[i];
+      auto const path = root / expected.path;
+
+      struct stat st;
+      if (::stat(path.c_str(), &st) < 0 || !S_ISREG(st.st_mode)) {
+        result.mismatches.push_back({expected.path, Mismatch::Kind::Missing});
+        continue;
+      }
+      if (static_cast<std::size_t>(st.st_size) != expected.size) {
+        result.mismatches.push_back({expected.path, Mismatch::Kind::Size});
+        continue;
+      }
+
+      std::optional<Digest> actual;
+      if (digests)
+        if (auto it = digests->find(expected.path); it != digests->end())
+          actual = it->second;
+      if (!actual) {
+        actual = hash_file_impl(path);
+        ++result.rehashed;
+      }
+      if (!actual)
+        result.mismatches.push_back({expected.path, Mismatch::Kind::Missing});
+      else if (*actual != expected.digest)
+        result.mismatches.push_back({expected.path, Mismatch::Kind::Digest});
+    }
+    return result;
+  };
+
+  std::vector<std::future<JobResult>> jobs;
+  {
+    detail::WorkerPool pool(threads);
+    for (std::size_t begin = 0; begin < manifest.size();
+         begin += files_per_job) {
+      auto const end = std::min(manifest.size(), begin + files_per_job);
+      jobs.push_back(pool.submit([&, begin, end] {
+        return verify_range(begin, end);
+      }));
+    }
+  }
+
+  VerificationReport report;
+  report.verified = manifest.size();
+  for (auto &job : jobs) {
+    auto result = job.get();
+    report.rehashed += result.rehashed;
+    std::move(result.mismatches.begin(), result.mismatches.end(),
+              std::back_inserter(report.mismatches));
+  }
+  return report;
+}
+} // namespace boost_iostreams_tar_filter
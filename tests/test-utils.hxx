@@ -0,0 +1,93 @@
+#pragma once
+
+#include <boost-iostreams-tar-filter/entry.hxx>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Description of one entry for make_tar().
+ */
+struct TestEntry {
+  std::string name;
+  std::string data;
+  char type = '0';
+  long mtime = 0;
+  std::string link_name = {};
+  std::string prefix = {};
+};
+
+/**
+ * @brief Build an uncompressed ustar archive in memory.
+ *
+ * Headers carry valid checksums, payloads are padded to 512 bytes and the
+ * archive is terminated by two zero blocks.
+ *
+ * @param entries Entries to write, in order.
+ * @return std::string The archive bytes.
+ */
+inline std::string make_tar(const std::vector<TestEntry> &entries) {
+  std::string archive;
+  for (const auto &entry : entries) {
+    char header[512] = {};
+    std::strncpy(header, entry.name.c_str(), 100);
+    std::snprintf(header + 100, 8, "%07o", entry.type == '5' ? 0755 : 0644);
+    std::snprintf(header + 108, 8, "%07o", 1000);
+    std::snprintf(header + 116, 8, "%07o", 1000);
+    std::snprintf(header + 124, 12, "%011lo",
+                  static_cast<unsigned long>(entry.data.size()));
+    std::snprintf(header + 136, 12, "%011lo",
+                  static_cast<unsigned long>(entry.mtime));
+    header[156] = entry.type;
+    std::strncpy(header + 157, entry.link_name.c_str(), 100);
+    std::memcpy(header + 257, "ustar", 6);
+    std::memcpy(header + 263, "00", 2);
+    std::strncpy(header + 345, entry.prefix.c_str(), 155);
+
+    std::memset(header + 148, ' ', 8);
+    unsigned checksum = 0;
+    for (unsigned char c : header)
+      checksum += c;
+    std::snprintf(header + 148, 8, "%06o", checksum);
+
+    archive.append(header, sizeof(header));
+    archive += entry.data;
+    archive.append((512 - entry.data.size() % 512) % 512, '\0');
+  }
+  archive.append(1024, '\0');
+  return archive;
+}
+
+/**
+ * @brief Encode one "<length> <key>=<value>\n" pax record.
+ */
+inline std::string pax_record(const std::string &key,
+                              const std::string &value) {
+  auto const body = ' ' + key + '=' + value + '\n';
+  auto length = body.size() + 1;
+  while (std::to_string(length).size() + body.size() != length)
+    ++length;
+  return std::to_string(length) + body;
+}
+
+/**
+ * @brief EntryVisitor that records every entry and its payload.
+ */
+class CollectingVisitor
+    : public boost_iostreams_tar_filter::EntryVisitor {
+public:
+  std::vector<std::pair<boost_iostreams_tar_filter::Entry, std::string>>
+      entries;
+
+  bool on_entry_begin(const boost_iostreams_tar_filter::Entry &entry) override {
+    entries.emplace_back(entry, std::string());
+    return true;
+  }
+  void on_entry_data(const char *begin, const char *end) override {
+    entries.back().second.append(begin, end);
+  }
+  void on_entry_end(const boost_iostreams_tar_filter::Entry &) override {}
+};
@@ -0,0 +1,181 @@
+#include "test-utils.hxx"
+
+#include <boost-iostreams-tar-filter/ar-reader.hxx>
+#include <boost-iostreams-tar-filter/compression.hxx>
+#include <boost-iostreams-tar-filter/tar-reader.hxx>
+
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/bzip2.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/lzma.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <ios>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace io = boost::iostreams;
+namespace tf = boost_iostreams_tar_filter;
+
+template <typename Compressor>
+static std::string compress(const std::string &data, Compressor compressor) {
+  std::string out;
+  io::filtering_ostream os;
+  os.push(compressor);
+  os.push(io::back_inserter(out));
+  os << data;
+  os.reset();
+  return out;
+}
+
+/**
+ * @brief Build a GNU-style ar archive ("name/" entries, odd sizes padded).
+ */
+static std::string
+make_ar(const std::vector<std::pair<std::string, std::string>> &members) {
+  std::string archive = "!<arch>\n";
+  for (const auto &[name, data] : members) {
+    char header[61];
+    std::snprintf(header, sizeof(header), "%-16s%-12d%-6d%-6d%-8o%-10zu`\n",
+                  (name + "/").c_str(), 1700000000, 0, 0, 0100644,
+                  data.size());
+    archive.append(header, 60);
+    archive += data;
+    if (data.size() % 2)
+      archive += '\n';
+  }
+  return archive;
+}
+
+static std::vector<TestEntry> make_entries() {
+  return {{"./usr/bin/tool", std::string(3001, 'x')},
+          {"./usr/share/doc/tool/README", "read me\n"}};
+}
+
+static void expect_entries(const CollectingVisitor &visitor) {
+  auto const expected = make_entries();
+  ASSERT_EQ(visitor.entries.size(), expected.size());
+  for (std::size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(visitor.entries[i].first.name, expected[i].name);
+    EXPECT_EQ(visitor.entries[i].second, expected[i].data);
+  }
+}
+
+TEST(ArReaderTest, ListsMembersAndStreamsData) {
+  auto const archive = make_ar(
+      {{"debian-binary", "2.0\n"}, {"odd", "abc"}, {"after-odd", "defg"}});
+  std::istringstream in(archive);
+  tf::ArReader ar(in);
+  tf::ArMember member;
+
+  ASSERT_TRUE(ar.next(member));
+  EXPECT_EQ(member.name, "debian-binary");
+  EXPECT_EQ(member.size, 4u);
+  EXPECT_EQ(member.mode, 0100644u);
+  EXPECT_EQ(member.mtime, 1700000000);
+
+  // Skipped without reading, then one read in full.
+  ASSERT_TRUE(ar.next(member));
+  EXPECT_EQ(member.name, "odd");
+  ASSERT_TRUE(ar.next(member));
+  EXPECT_EQ(member.name, "after-odd");
+  io::filtering_istream data;
+  data.push(ar.source());
+  EXPECT_EQ(std::string(std::istreambuf_iterator<char>(data), {}), "defg");
+  EXPECT_FALSE(ar.next(member));
+}
+
+TEST(ArReaderTest, ResolvesLongNames) {
+  std::string const long_name = "a-member-name-longer-than-sixteen";
+  std::string archive = "!<arch>\n";
+  // GNU long-name table followed by a member referring to it.
+  auto const table = long_name + "/\n";
+  char header[61];
+  std::snprintf(header, sizeof(header), "%-16s%-12d%-6d%-6d%-8o%-10zu`\n",
+                "//", 0, 0, 0, 0, table.size());
+  archive.append(header, 60);
+  archive += table + '\n';
+  std::snprintf(header, sizeof(header), "%-16s%-12d%-6d%-6d%-8o%-10zu`\n",
+                "/0", 0, 0, 0, 0100644, std::size_t(2));
+  archive.append(header, 60);
+  archive += "hi";
+  // BSD name stored in front of the data.
+  std::snprintf(header, sizeof(header), "%-16s%-12d%-6d%-6d%-8o%-10zu`\n",
+                ("#1/" + std::to_string(long_name.size())).c_str(), 0, 0, 0,
+                0100644, long_name.size() + 3);
+  archive.append(header, 60);
+  archive += long_name + "bsd";
+
+  std::istringstream in(archive);
+  tf::ArReader ar(in);
+  tf::ArMember member;
+  ASSERT_TRUE(ar.next(member));
+  EXPECT_EQ(member.name, long_name);
+  ASSERT_TRUE(ar.next(member));
+  EXPECT_EQ(member.name, long_name);
+  EXPECT_EQ(member.size, 3u);
+  io::filtering_istream data;
+  data.push(ar.source());
+  EXPECT_EQ(std::string(std::istreambuf_iterator<char>(data), {}), "bsd");
+  EXPECT_FALSE(ar.next(member));
+}
+
+/**
+ * @brief visit_deb() picks the data member and its decompressor by suffix.
+ */
+TEST(ArReaderTest, VisitsDataTarOfDeb) {
+  auto const tar = make_tar(make_entries());
+  auto const control = make_tar({{"./control", "Package: tool\n"}});
+  std::vector<std::pair<std::string, std::string>> variants = {
+      {"data.tar.gz", compress(tar, io::gzip_compressor())},
+      {"data.tar.xz", compress(tar, io::lzma_compressor())},
+      {"data.tar.bz2", compress(tar, io::bzip2_compressor())},
+      {"data.tar", tar},
+  };
+  for (const auto &[name, data] : variants) {
+    auto const deb =
+        make_ar({{"debian-binary", "2.0\n"},
+                 {"control.tar.gz", compress(control, io::gzip_compressor())},
+                 {name, data}});
+    std::istringstream in(deb);
+    CollectingVisitor visitor;
+    EXPECT_TRUE(tf::visit_deb(in, visitor)) << name;
+    expect_entries(visitor);
+
+    std::istringstream control_in(deb);
+    CollectingVisitor control_visitor;
+    EXPECT_TRUE(tf::visit_deb(control_in, control_visitor, "control.tar"));
+    ASSERT_EQ(control_visitor.entries.size(), 1u);
+    EXPECT_EQ(control_visitor.entries[0].first.name, "./control");
+  }
+}
+
+TEST(ArReaderTest, RejectsNonArInput) {
+  std::istringstream in("not an archive");
+  EXPECT_THROW(tf::ArReader{in}, std::ios_base::failure);
+
+  std::istringstream deb(make_ar({{"debian-binary", "2.0\n"}}));
+  CollectingVisitor visitor;
+  EXPECT_THROW(tf::visit_deb(deb, visitor), std::ios_base::failure);
+}
+
+TEST(CompressionTest, DetectsFormats) {
+  EXPECT_EQ(tf::compression_from_name("data.tar.gz"), tf::Compression::Gzip);
+  EXPECT_EQ(tf::compression_from_name("a.tbz2"), tf::Compression::Bzip2);
+  EXPECT_EQ(tf::compression_from_name("data.tar.xz"), tf::Compression::Xz);
+  EXPECT_EQ(tf::compression_from_name("data.tar.zst"), tf::Compression::Zstd);
+  EXPECT_EQ(tf::compression_from_name("data.tar"), tf::Compression::None);
+  EXPECT_EQ(tf::compression_from_name("data.tar.lzma"), tf::Compression::None);
+
+  auto const tar = make_tar(make_entries());
+  EXPECT_EQ(tf::compression_from_magic(compress(tar, io::gzip_compressor())),
+            tf::Compression::Gzip);
+  EXPECT_EQ(tf::compression_from_magic(compress(tar, io::bzip2_compressor())),
+            tf::Compression::Bzip2);
+  EXPECT_EQ(tf::compression_from_magic(compress(tar, io::lzma_compressor())),
+            tf::Compression::Xz);
+  EXPECT_EQ(tf::compression_from_magic(tar), tf::Compression::None);
+}
@@ -0,0 +1,107 @@
+#include "test-utils.hxx"
+
+#include <boost-iostreams-tar-filter/archive-diff.hxx>
+
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+
+namespace tf = boost_iostreams_tar_filter;
+
+static std::vector<std::pair<tf::DiffEntry::Kind, std::string>>
+flatten(const std::vector<tf::DiffEntry> &diff) {
+  std::vector<std::pair<tf::DiffEntry::Kind, std::string>> result;
+  for (const auto &entry : diff)
+    result.emplace_back(entry.kind, entry.name);
+  return result;
+}
+
+TEST(ArchiveDiffTest, ReportsAddedRemovedModified) {
+  using Kind = tf::DiffEntry::Kind;
+  const std::vector<std::pair<Kind, std::string>> expected = {
+      {Kind::Removed, "b"},
+      {Kind::Modified, "c"},
+      {Kind::Added, "d"},
+      {Kind::Modified, "link"},
+  };
+
+  const auto before = make_tar({{"a", "same"},
+                                {"b", "gone"},
+                                {"c", "old contents"},
+                                {"link", "", '2', 0, "a"}});
+  const auto after_sorted = make_tar({{"a", "same"},
+                                      {"c", "new contents"},
+                                      {"d", "new file"},
+                                      {"link", "", '2', 0, "c"}});
+  const auto after_shuffled = make_tar({{"link", "", '2', 0, "c"},
+                                        {"d", "new file"},
+                                        {"c", "new contents"},
+                                        {"a", "same"}});
+
+  std::istringstream b1(before), a1(after_sorted);
+  EXPECT_EQ(flatten(tf::diff_archives(b1, a1, {.sorted = true})), expected);
+
+  std::istringstream b2(before), a2(after_shuffled);
+  EXPECT_EQ(flatten(tf::diff_archives(b2, a2, {.queue_depth = 1})), expected);
+
+  std::istringstream b3(before), a3(after_shuffled);
+  EXPECT_THROW(tf::diff_archives(b3, a3, {.sorted = true}),
+               std::ios_base::failure);
+}
+
+/**
+ * @brief With a tiny max_pending, a reversed archive spills to partition
+ * files (and re-partitions them) and still yields the in-memory result.
+ */
+TEST(ArchiveDiffTest, SpillsBeyondMaxPending) {
+  std::vector<TestEntry> before_entries, after_entries;
+  for (int i = 0; i < 600; ++i) {
+    auto const name = "f" + std::to_string(i);
+    if (i % 50 != 1)
+      before_entries.push_back({name, "v1-" + name});
+    if (i % 50 != 2)
+      after_entries.push_back({name, (i % 50 == 3 ? "v2-" : "v1-") + name});
+  }
+  std::reverse(after_entries.begin(), after_entries.end());
+  auto const before = make_tar(before_entries);
+  auto const after = make_tar(after_entries);
+
+  std::istringstream b1(before), a1(after);
+  auto const in_memory = flatten(tf::diff_archives(b1, a1));
+  EXPECT_EQ(in_memory.size(), 36u);
+
+  std::istringstream b2(before), a2(after);
+  EXPECT_EQ(flatten(tf::diff_archives(b2, a2, {.max_pending = 3})),
+            in_memory);
+
+  std::istringstream b3(before), a3(after);
+  EXPECT_THROW(tf::diff_archives(b3, a3, {.max_pending = 0}),
+               std::invalid_argument);
+}
+
+/**
+ * @brief A name stored twice in one archive is compared by its last copy,
+ * in memory and through spill files alike.
+ */
+TEST(ArchiveDiffTest, ComparesLastDuplicate) {
+  std::vector<TestEntry> before_entries = {
+      {"a", "v1"}, {"b", "x"}, {"a", "v2"}, {"d", "same"}};
+  std::vector<TestEntry> after_entries = {
+      {"b", "x"}, {"d", "same"}, {"a", "v2"}, {"b", "y"}, {"d", "same"}};
+  for (int i = 0; i < 20; ++i) {
+    auto const name = "f" + std::to_string(i);
+    before_entries.push_back({name, name});
+    after_entries.insert(after_entries.begin(), {name, name});
+  }
+  auto const before = make_tar(before_entries);
+  auto const after = make_tar(after_entries);
+  const std::vector<std::pair<tf::DiffEntry::Kind, std::string>> expected = {
+      {tf::DiffEntry::Kind::Modified, "b"}};
+
+  std::istringstream b1(before), a1(after);
+  EXPECT_EQ(flatten(tf::diff_archives(b1, a1, {.queue_depth = 1})), expected);
+
+  std::istringstream b2(before), a2(after);
+  EXPECT_EQ(flatten(tf::diff_archives(b2, a2, {.max_pending = 3})), expected);
+}
@@ -0,0 +1,166 @@
+#include "test-utils.hxx"
+
+#include <boost-iostreams-tar-filter/archive-store.hxx>
+
+#include <atomic>
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <malloc.h>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tf = boost_iostreams_tar_filter;
+
+TEST(ArchiveStoreTest, EvictsLeastRecentlyUsed) {
+  tf::ArchiveStore store(3000, 4096);
+  std::istringstream first(make_tar({{"a", std::string(1000, 'a')},
+                                     {"b", std::string(1000, 'b')},
+                                     {"dir/", "", '5'}}));
+  EXPECT_TRUE(store.load(first));
+  EXPECT_EQ(store.count(), 2u);
+  EXPECT_EQ(store.size_bytes(), 2000u);
+
+  // Touch "a" so that "b" becomes the least recently used file.
+  auto a = store.find("a");
+  ASSERT_TRUE(a);
+  EXPECT_EQ(a.view(), std::string(1000, 'a'));
+
+  std::istringstream second(make_tar({{"c", std::string(1500, 'c')},
+                                      {"huge", std::string(5000, 'h')}}));
+  EXPECT_TRUE(store.load(second));
+  EXPECT_TRUE(store.find("a"));
+  EXPECT_FALSE(store.find("b"));
+  EXPECT_EQ(store.find("c").view(), std::string(1500, 'c'));
+  EXPECT_FALSE(store.find("huge"));
+  EXPECT_EQ(store.size_bytes(), 2500u);
+
+  // Handles outlive eviction.
+  EXPECT_EQ(a.view(), std::string(1000, 'a'));
+}
+
+namespace {
+/**
+ * @brief Stream buffer serving a string in small pieces and recording the
+ * heap bytes in use each time it is refilled.
+ */
+class SamplingBuffer : public std::streambuf {
+public:
+  explicit SamplingBuffer(const std::string &data) : data_(data) {}
+
+  std::size_t peak = 0;
+
+protected:
+  int_type underflow() override {
+    peak = std::max(peak, mallinfo2().uordblks);
+    if (offset_ == data_.size())
+      return traits_type::eof();
+    auto const count = std::min<std::size_t>(4096, data_.size() - offset_);
+    auto *begin = const_cast<char *>(data_.data()) + offset_;
+    setg(begin, begin, begin + count);
+    offset_ += count;
+    return traits_type::to_int_type(*begin);
+  }
+
+private:
+  const std::string &data_;
+  std::size_t offset_ = 0;
+};
+} // unnamed namespace
+
+/**
+ * @brief An archive larger than the budget keeps its most recent files,
+ * each path at its last copy; earlier files of the archive are dropped while
+ * it is read, so memory stays near the budget.
+ */
+TEST(ArchiveStoreTest, LoadsArchiveLargerThanBudget) {
+  tf::ArchiveStore store(3000, 4096);
+  std::istringstream first(make_tar({{"old", std::string(500, 'o')}}));
+  EXPECT_TRUE(store.load(first));
+
+  std::vector<TestEntry> entries;
+  for (int i = 0; i < 2000; ++i)
+    entries.push_back(
+        {"file-" + std::to_string(i), std::string(1000, 'a' + i % 26)});
+  entries.push_back({"file-1998", std::string(200, 'z')});
+  auto const archive = make_tar(entries);
+  entries.clear();
+
+  SamplingBuffer buffer(archive);
+  std::istream second(&buffer);
+  auto const before = mallinfo2().uordblks;
+  EXPECT_TRUE(store.load(second));
+  EXPECT_LT(buffer.peak, before + 256 * 1024);
+
+  EXPECT_FALSE(store.find("file-1996"));
+  EXPECT_EQ(store.find("file-1997").view(), std::string(1000, 'a' + 1997 % 26));
+  EXPECT_EQ(store.find("file-1998").view(), std::string(200, 'z'));
+  EXPECT_EQ(store.find("file-1999").view(), std::string(1000, 'a' + 1999 % 26));
+  // The stored file still fits next to what is left of the archive.
+  EXPECT_EQ(store.find("old").view(), std::string(500, 'o'));
+  EXPECT_EQ(store.count(), 4u);
+  EXPECT_EQ(store.size_bytes(), 2700u);
+}
+
+TEST(ArchiveStoreTest, ConcurrentReadsDuringLoads) {
+  tf::ArchiveStore store(1 << 20);
+  std::atomic<bool> stop{false};
+  std::atomic<std::size_t> hits{0};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i)
+    readers.emplace_back([&] {
+      while (!stop.load())
+        if (auto file = store.find("file"); file) {
+          EXPECT_EQ(file.size, 100u);
+          ++hits;
+        }
+    });
+
+  for (int i = 0; i < 50; ++i) {
+    std::istringstream in(make_tar({{"file", std::string(100, 'a' + i % 26)}}));
+    store.load(in);
+  }
+  stop = true;
+  for (auto &reader : readers)
+    reader.join();
+  EXPECT_EQ(store.count(), 1u);
+}
+
+/**
+ * @brief Evicted files are released by the load() that evicts them even
+ * though lookups never stop.
+ */
+TEST(ArchiveStoreTest, ReclaimsUnderSustainedReads) {
+  tf::ArchiveStore store(1000, 4096);
+  std::atomic<bool> stop{false};
+  std::atomic<std::size_t> lookups{0};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i)
+    readers.emplace_back([&] {
+      while (!stop.load()) {
+        store.find("missing");
+        ++lookups;
+      }
+    });
+
+  for (int i = 0; i < 20; ++i) {
+    // Let the readers run between loads, also on a single core.
+    for (auto const seen = lookups.load(); lookups.load() < seen + 1000;)
+      std::this_thread::yield();
+    auto const name = "file-" + std::to_string(i);
+    std::istringstream first(make_tar({{name, std::string(1000, 'x')}}));
+    store.load(first);
+    std::weak_ptr<const char> evicted = store.find(name).data;
+    ASSERT_FALSE(evicted.expired());
+
+    std::istringstream second(make_tar({{"other", std::string(1000, 'y')}}));
+    store.load(second);
+    EXPECT_FALSE(store.find(name));
+    EXPECT_TRUE(evicted.expired()) << name;
+  }
+  stop = true;
+  for (auto &reader : readers)
+    reader.join();
+}
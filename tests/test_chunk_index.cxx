@@ -0,0 +1,57 @@
+#include "test-utils.hxx"
+
+#include <boost-iostreams-tar-filter/chunk-index.hxx>
+#include <boost-iostreams-tar-filter/tar-reader.hxx>
+
+#include <gtest/gtest.h>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace tf = boost_iostreams_tar_filter;
+
+static tf::ChunkManifest index_archive(const std::string &archive,
+                                       std::size_t buffer_size) {
+  std::istringstream in(archive);
+  tf::ChunkIndexBuilder builder;
+  tf::visit_tar(in, builder, buffer_size);
+  return builder.finish();
+}
+
+/**
+ * @brief Chunks respect the size bounds, tile the payload, do not depend on
+ * read buffer size and survive an insertion near the start of the file.
+ */
+TEST(ChunkIndexTest, ContentDefinedBoundaries) {
+  std::mt19937 rng(42);
+  std::string payload(512 * 1024, '\0');
+  for (auto &c : payload)
+    c = static_cast<char>(rng());
+  auto edited = payload;
+  edited.insert(1000, "inserted bytes");
+
+  const auto before = index_archive(make_tar({{"blob", payload}}), 4096);
+  const auto again = index_archive(make_tar({{"blob", payload}}), 777);
+  const auto after = index_archive(make_tar({{"blob", edited}}), 4096);
+
+  ASSERT_EQ(before.entries.size(), 1u);
+  const auto &chunks = before.entries[0].chunks;
+  std::size_t offset = 0;
+  for (std::size_t i = 0; i < chunks.size(); ++i) {
+    EXPECT_EQ(chunks[i].offset, offset);
+    EXPECT_LE(chunks[i].size, 64u * 1024);
+    if (i + 1 < chunks.size()) {
+      EXPECT_GE(chunks[i].size, 2u * 1024);
+    }
+    offset += chunks[i].size;
+  }
+  EXPECT_EQ(offset, payload.size());
+  EXPECT_GT(chunks.size(), 20u);
+  EXPECT_EQ(before.root, again.root);
+  EXPECT_NE(before.root, after.root);
+
+  std::unordered_set<tf::Digest, tf::DigestHash> have;
+  for (const auto &chunk : chunks)
+    have.insert(chunk.digest);
+  EXPECT_LE(after.missing_chunks(have).size(), 2u);
+}
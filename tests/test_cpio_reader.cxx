@@ -0,0 +1,204 @@
+#include "test-utils.hxx"
+
+#include <boost-iostreams-tar-filter/archive-reader.hxx>
+#include <boost-iostreams-tar-filter/cpio-filter.hxx>
+
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <cstdio>
+#include <gtest/gtest.h>
+#include <ios>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace io = boost::iostreams;
+namespace tf = boost_iostreams_tar_filter;
+
+namespace {
+struct CpioEntry {
+  std::string name;
+  unsigned mode;
+  std::string data;
+  unsigned ino = 0;
+  unsigned nlink = 1;
+};
+
+std::string pad4(std::string s) {
+  s.append((4 - s.size() % 4) % 4, '\0');
+  return s;
+}
+
+/**
+ * @brief Write a "newc" archive, including the trailer.
+ */
+std::string make_newc(std::vector<CpioEntry> entries) {
+  entries.push_back({"TRAILER!!!", 0, ""});
+  std::string archive;
+  for (const auto &e : entries) {
+    char header[111];
+    std::snprintf(header, sizeof(header),
+                  "070701%08X%08X%08X%08X%08X%08X%08X%08X%08X%08X%08X%08X%08X",
+                  e.ino, e.mode, 1000u, 1000u, e.nlink, 1700000000u,
+                  static_cast<unsigned>(e.data.size()), 8u, 1u, 0u, 0u,
+                  static_cast<unsigned>(e.name.size() + 1), 0u);
+    archive = pad4(archive + header + e.name + '\0');
+    archive = pad4(archive + e.data);
+  }
+  return archive;
+}
+
+/**
+ * @brief Write an "odc" archive, including the trailer.
+ */
+std::string make_odc(std::vector<CpioEntry> entries) {
+  entries.push_back({"TRAILER!!!", 0, ""});
+  std::string archive;
+  for (const auto &e : entries) {
+    char header[77];
+    std::snprintf(header, sizeof(header),
+                  "070707%06o%06o%06o%06o%06o%06o%06o%011o%06o%011o", 8u,
+                  e.ino, e.mode, 1000u, 1000u, e.nlink, 0u, 1700000000u,
+                  static_cast<unsigned>(e.name.size() + 1),
+                  static_cast<unsigned>(e.data.size()));
+    archive += header + e.name + '\0' + e.data;
+  }
+  return archive;
+}
+
+std::vector<CpioEntry> sample_entries() {
+  return {{"etc", 0040755, ""},
+          {"etc/hostname", 0100644, "box\n", 2},
+          {"bin", 0040755, ""},
+          {"bin/sh", 0120777, "busybox", 3},
+          // newc hard link set: the data travels with the last link.
+          {"bin/true", 0100755, "", 4, 2},
+          {"bin/busybox", 0100755, std::string(1001, 'b'), 4, 2}};
+}
+} // unnamed namespace
+
+TEST(CpioReaderTest, VisitsNewcEntries) {
+  auto const archive = make_newc(sample_entries());
+  for (std::size_t buffer_size : {1, 3, 512}) {
+    std::istringstream in(archive);
+    CollectingVisitor visitor;
+    EXPECT_TRUE(tf::visit_cpio(in, visitor, buffer_size)) << buffer_size;
+
+    auto const &entries = visitor.entries;
+    ASSERT_EQ(entries.size(), 6u) << buffer_size;
+    EXPECT_EQ(entries[0].first.name, "etc");
+    EXPECT_TRUE(entries[0].first.is_directory());
+    EXPECT_EQ(entries[1].first.name, "etc/hostname");
+    EXPECT_EQ(entries[1].first.mode, 0644u);
+    EXPECT_EQ(entries[1].first.uid, 1000u);
+    EXPECT_EQ(entries[1].first.mtime, 1700000000);
+    EXPECT_EQ(entries[1].second, "box\n");
+    EXPECT_TRUE(entries[3].first.is_symlink());
+    EXPECT_EQ(entries[3].first.link_name, "busybox");
+    EXPECT_EQ(entries[3].second, "");
+    EXPECT_EQ(entries[4].first.name, "bin/busybox");
+    EXPECT_EQ(entries[4].second, std::string(1001, 'b'));
+    EXPECT_TRUE(entries[5].first.is_hard_link());
+    EXPECT_EQ(entries[5].first.name, "bin/true");
+    EXPECT_EQ(entries[5].first.link_name, "bin/busybox");
+  }
+}
+
+TEST(CpioReaderTest, VisitsOdcEntries) {
+  auto entries = sample_entries();
+  entries.erase(entries.begin() + 4); // odc stores data with every link
+  std::istringstream in(make_odc(entries));
+  CollectingVisitor visitor;
+  EXPECT_TRUE(tf::visit_cpio(in, visitor, 7));
+  ASSERT_EQ(visitor.entries.size(), 5u);
+  EXPECT_EQ(visitor.entries[1].second, "box\n");
+  EXPECT_EQ(visitor.entries[3].first.link_name, "busybox");
+  EXPECT_EQ(visitor.entries[4].second, std::string(1001, 'b'));
+}
+
+/**
+ * @brief visit_archive() dispatches on the magic, also for streams that
+ * cannot be rewound.
+ */
+TEST(CpioReaderTest, VisitArchiveDetectsFormat) {
+  auto const cpio = make_newc(sample_entries());
+  io::filtering_istream cpio_in;
+  cpio_in.push(io::array_source(cpio.data(), cpio.size()));
+  CollectingVisitor cpio_visitor;
+  EXPECT_TRUE(tf::visit_archive(cpio_in, cpio_visitor, 64));
+  EXPECT_EQ(cpio_visitor.entries.size(), 6u);
+
+  auto const tar = make_tar({{"a", "alpha"}, {"b", "beta"}});
+  std::istringstream tar_in(tar);
+  CollectingVisitor tar_visitor;
+  EXPECT_TRUE(tf::visit_archive(tar_in, tar_visitor, 64));
+  ASSERT_EQ(tar_visitor.entries.size(), 2u);
+  EXPECT_EQ(tar_visitor.entries[1].second, "beta");
+
+  EXPECT_EQ(tf::archive_format_from_magic("070707"), tf::ArchiveFormat::Cpio);
+  EXPECT_EQ(tf::archive_format_from_magic(tar), tf::ArchiveFormat::Tar);
+}
+
+TEST(CpioReaderTest, SkipsDeclinedPayloads) {
+  auto const archive = make_newc(sample_entries());
+  std::istringstream in(archive);
+  struct HostnameOnly : CollectingVisitor {
+    bool on_entry_begin(const tf::Entry &entry) override {
+      CollectingVisitor::on_entry_begin(entry);
+      return entry.name == "etc/hostname";
+    }
+  } visitor;
+  EXPECT_TRUE(tf::visit_cpio(in, visitor, 16));
+  ASSERT_EQ(visitor.entries.size(), 6u);
+  EXPECT_EQ(visitor.entries[1].second, "box\n");
+  EXPECT_EQ(visitor.entries[4].second, "");
+}
+
+TEST(CpioFilterTest, OutputsRegularFileContents) {
+  auto const archive = make_newc(sample_entries());
+  io::filtering_istream in;
+  in.push(tf::CpioFilter<>(5));
+  in.push(io::array_source(archive.data(), archive.size()), 3);
+  EXPECT_EQ(std::string(std::istreambuf_iterator<char>(in), {}),
+            "box\n" + std::string(1001, 'b'));
+}
+
+/**
+ * @brief Archives concatenated with zero padding between them, like an
+ * initramfs, are read as one; hard link sets do not span archives and data
+ * that is not another archive ends the parse.
+ */
+TEST(CpioReaderTest, VisitsConcatenatedArchives) {
+  auto const first = make_newc(sample_entries());
+  auto const second = make_odc({{"init", 0100755, "#!/bin/sh\n", 4}});
+  auto const archive = first + std::string(512 - first.size() % 512, '\0') +
+                       second + std::string(512, '\0');
+  for (std::size_t buffer_size : {1, 5, 4096}) {
+    std::istringstream in(archive);
+    CollectingVisitor visitor;
+    EXPECT_TRUE(tf::visit_cpio(in, visitor, buffer_size)) << buffer_size;
+    ASSERT_EQ(visitor.entries.size(), 7u) << buffer_size;
+    EXPECT_EQ(visitor.entries[6].first.name, "init");
+    EXPECT_TRUE(visitor.entries[6].first.is_regular_file());
+    EXPECT_EQ(visitor.entries[6].second, "#!/bin/sh\n");
+  }
+
+  std::istringstream trailing(first + std::string(8, '\0') + "\x1f\x8b junk");
+  CollectingVisitor visitor;
+  EXPECT_TRUE(tf::visit_cpio(trailing, visitor));
+  EXPECT_EQ(visitor.entries.size(), 6u);
+
+  io::filtering_istream filtered;
+  filtered.push(tf::CpioFilter<>(5));
+  filtered.push(io::array_source(archive.data(), archive.size()), 3);
+  EXPECT_EQ(std::string(std::istreambuf_iterator<char>(filtered), {}),
+            "box\n" + std::string(1001, 'b') + "#!/bin/sh\n");
+}
+
+TEST(CpioReaderTest, RejectsCorruptHeader) {
+  auto archive = make_newc(sample_entries());
+  archive[0] = 'X';
+  std::istringstream in(archive);
+  CollectingVisitor visitor;
+  EXPECT_THROW(tf::visit_cpio(in, visitor), std::ios_base::failure);
+}
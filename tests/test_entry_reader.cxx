@@ -0,0 +1,206 @@
+#include "test-utils.hxx"
+
+#include <boost-iostreams-tar-filter/entry-reader.hxx>
+
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace fs = std::filesystem;
+namespace io = boost::iostreams;
+namespace tf = boost_iostreams_tar_filter;
+
+namespace {
+std::vector<TestEntry> make_entries() {
+  std::mt19937 random(3);
+  std::vector<TestEntry> entries;
+  for (int i = 0; i < 20; ++i) {
+    std::string data(static_cast<std::size_t>(random() % 50000), '\0');
+    for (auto &c : data)
+      c = static_cast<char>('a' + random() % 16);
+    entries.push_back({"blob-" + std::to_string(i), std::move(data)});
+  }
+  entries.insert(entries.begin() + 3, TestEntry{"dir/", "", '5'});
+  return entries;
+}
+
+std::string as_string(const std::vector<std::byte> &bytes, std::size_t size) {
+  return std::string(reinterpret_cast<const char *>(bytes.data()), size);
+}
+
+std::string gzip(const std::string &data) {
+  std::string out;
+  io::filtering_ostream os;
+  os.push(io::gzip_compressor());
+  os.push(io::back_inserter(out));
+  os << data;
+  os.reset();
+  return out;
+}
+} // unnamed namespace
+
+TEST(EntryReaderTest, ReadsFromFile) {
+  auto const entries = make_entries();
+  auto const path = fs::temp_directory_path() /
+                    ("tar-filter-entry-" + std::to_string(::getpid()));
+  std::ofstream(path, std::ios::binary) << make_tar(entries);
+
+  const auto &wanted = entries[15];
+  std::vector<std::byte> buffer(wanted.data.size() + 10);
+  auto const entry = tf::read_entry_into(path, wanted.name, buffer);
+  ASSERT_TRUE(entry.has_value());
+  EXPECT_EQ(entry->size, wanted.data.size());
+  EXPECT_EQ(as_string(buffer, entry->size), wanted.data);
+
+  EXPECT_FALSE(tf::read_entry_into(path, "missing", buffer));
+  EXPECT_FALSE(tf::read_entry_into(path, "dir/", buffer));
+  std::vector<std::byte> small(wanted.data.size() - 1);
+  EXPECT_THROW(tf::read_entry_into(path, wanted.name, small),
+               std::invalid_argument);
+  fs::remove(path);
+}
+
+/**
+ * @brief Seekable streams seek over other payloads, filtering streams read
+ * through them; both fill the buffer the same way.
+ */
+TEST(EntryReaderTest, ReadsFromStreams) {
+  auto const entries = make_entries();
+  auto const archive = make_tar(entries);
+  const auto &wanted = entries.back();
+  std::vector<std::byte> buffer(wanted.data.size());
+
+  std::istringstream seekable(archive);
+  auto entry = tf::read_entry_into(seekable, wanted.name, buffer);
+  ASSERT_TRUE(entry.has_value());
+  EXPECT_EQ(as_string(buffer, entry->size), wanted.data);
+
+  std::fill(buffer.begin(), buffer.end(), std::byte{0});
+  auto const compressed = gzip(archive);
+  io::filtering_istream filtered;
+  filtered.push(io::gzip_decompressor());
+  filtered.push(io::array_source(compressed.data(), compressed.size()));
+  entry = tf::read_entry_into(filtered, wanted.name, buffer);
+  ASSERT_TRUE(entry.has_value());
+  EXPECT_EQ(as_string(buffer, entry->size), wanted.data);
+
+  std::istringstream missing(archive);
+  EXPECT_FALSE(tf::read_entry_into(missing, "missing", buffer));
+}
+
+TEST(EntryReaderTest, ReadsFromGzipCheckpoint) {
+  auto const entries = make_entries();
+  auto const archive = make_tar(entries);
+  // Two members, so some entries start in the second one.
+  auto const compressed = gzip(archive.substr(0, archive.size() / 2)) +
+                          gzip(archive.substr(archive.size() / 2));
+  std::istringstream index_in(compressed);
+  auto const index = tf::GzipIndex::build(index_in, 32 * 1024);
+  ASSERT_GT(index.checkpoints.size(), 3u);
+
+  for (std::size_t i : {0, 9, 20}) {
+    const auto &wanted = entries[i];
+    std::vector<std::byte> buffer(wanted.data.size());
+    std::istringstream in(compressed);
+    auto const entry = tf::read_entry_into(index, in, wanted.name, buffer);
+    ASSERT_TRUE(entry.has_value()) << wanted.name;
+    EXPECT_EQ(entry->name, wanted.name);
+    EXPECT_EQ(as_string(buffer, entry->size), wanted.data) << wanted.name;
+  }
+
+  std::istringstream in(compressed);
+  std::vector<std::byte> buffer(16);
+  EXPECT_FALSE(tf::read_entry_into(index, in, "missing", buffer));
+}
+
+/**
+ * @brief Names longer than the 100-byte header field, stored as a GNU
+ * long-name record or a pax path record, are found by every overload.
+ */
+TEST(EntryReaderTest, ReadsLongNames) {
+  auto const gnu_name = std::string(120, 'g') + "/file";
+  auto const pax_name = std::string(130, 'p') + "/file";
+  auto const archive =
+      make_tar({{"././@LongLink", gnu_name + '\0', 'L'},
+                {gnu_name.substr(0, 100), std::string(3000, 'G')},
+                {"PaxHeaders/file", pax_record("path", pax_name), 'x'},
+                {"file", std::string(700, 'P')}});
+  auto const path = fs::temp_directory_path() /
+                    ("tar-filter-long-" + std::to_string(::getpid()));
+  std::ofstream(path, std::ios::binary) << archive;
+  auto const compressed = gzip(archive);
+  std::istringstream index_in(compressed);
+  auto const index = tf::GzipIndex::build(index_in, 32 * 1024);
+
+  for (const auto &[name, data] :
+       {std::pair{gnu_name, std::string(3000, 'G')},
+        std::pair{pax_name, std::string(700, 'P')}}) {
+    std::vector<std::byte> buffer(data.size());
+    auto entry = tf::read_entry_into(path, name, buffer);
+    ASSERT_TRUE(entry.has_value()) << name;
+    EXPECT_EQ(as_string(buffer, entry->size), data);
+
+    std::istringstream in(archive);
+    entry = tf::read_entry_into(in, name, buffer);
+    ASSERT_TRUE(entry.has_value()) << name;
+    EXPECT_EQ(as_string(buffer, entry->size), data);
+
+    std::istringstream gz(compressed);
+    entry = tf::read_entry_into(index, gz, name, buffer);
+    ASSERT_TRUE(entry.has_value()) << name;
+    EXPECT_EQ(as_string(buffer, entry->size), data);
+  }
+  EXPECT_FALSE(tf::read_entry_into(path, "file", std::span<std::byte>{}));
+  fs::remove(path);
+}
+
+/**
+ * @brief The last copy of a path is read, as extraction leaves it; a path
+ * whose last copy is not a regular file does not match.
+ */
+TEST(EntryReaderTest, ReadsLastDuplicate) {
+  auto const archive = make_tar({{"dup", std::string(2000, 'f')},
+                                 {"other", "x"},
+                                 {"dup", "last"},
+                                 {"gone", "file"},
+                                 {"gone", "", '2', 0, "other"}});
+  auto const path = fs::temp_directory_path() /
+                    ("tar-filter-dup-" + std::to_string(::getpid()));
+  std::ofstream(path, std::ios::binary) << archive;
+  auto const compressed = gzip(archive);
+  std::istringstream index_in(compressed);
+  auto const index = tf::GzipIndex::build(index_in, 32 * 1024);
+
+  // Too small for the first copy, which must not matter.
+  std::vector<std::byte> buffer(100);
+  auto entry = tf::read_entry_into(path, "dup", buffer);
+  ASSERT_TRUE(entry.has_value());
+  EXPECT_EQ(as_string(buffer, entry->size), "last");
+  EXPECT_FALSE(tf::read_entry_into(path, "gone", buffer));
+
+  std::istringstream seekable(archive);
+  entry = tf::read_entry_into(seekable, "dup", buffer);
+  ASSERT_TRUE(entry.has_value());
+  EXPECT_EQ(as_string(buffer, entry->size), "last");
+  std::istringstream gone_in(archive);
+  EXPECT_FALSE(tf::read_entry_into(gone_in, "gone", buffer));
+
+  std::istringstream gz(compressed);
+  entry = tf::read_entry_into(index, gz, "dup", buffer);
+  ASSERT_TRUE(entry.has_value());
+  EXPECT_EQ(as_string(buffer, entry->size), "last");
+  std::istringstream gone_gz(compressed);
+  EXPECT_FALSE(tf::read_entry_into(index, gone_gz, "gone", buffer));
+  fs::remove(path);
+}
@@ -0,0 +1,194 @@
+#include "test-utils.hxx"
+
+#include <boost-iostreams-tar-filter/extraction-sink.hxx>
+
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+namespace tf = boost_iostreams_tar_filter;
+
+/**
+ * @brief Read a whole file into a string.
+ */
+static std::string read_file(const fs::path &path) {
+  std::ifstream in(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(in), {});
+}
+
+/**
+ * @brief Archive used by the sink tests, with payloads larger than the read
+ * buffer so entries span several batches.
+ */
+static std::vector<TestEntry> sink_test_entries() {
+  return {{"top/", "", '5'},
+          {"top/a.txt", std::string(1500, 'a')},
+          {"top/nested/b.txt", "bee"},
+          {"top/empty", ""},
+          {"top/link", "", '2', 0, "a.txt"},
+          {"./c.txt", std::string(700, 'c')}};
+}
+
+TEST(ExtractionSinkTest, MemorySinkCollectsEntries) {
+  std::istringstream in(make_tar(sink_test_entries()));
+  tf::MemorySink sink;
+  EXPECT_TRUE(tf::extract_tar(in, sink, 512));
+
+  EXPECT_EQ(sink.entries().size(), 6u);
+  EXPECT_EQ(sink.files().at("top/a.txt"), std::string(1500, 'a'));
+  EXPECT_EQ(sink.files().at("top/nested/b.txt"), "bee");
+  EXPECT_EQ(sink.files().at("top/empty"), "");
+  EXPECT_EQ(sink.files().at("./c.txt"), std::string(700, 'c'));
+  EXPECT_EQ(sink.files().count("top/link"), 0u);
+}
+
+TEST(ExtractionSinkTest, MemorySinkKeepsLastDuplicate) {
+  std::istringstream in(make_tar({{"dup", "first"},
+                                  {"dup", "second"},
+                                  {"gone", "file"},
+                                  {"gone", "", '2', 0, "dup"}}));
+  tf::MemorySink sink;
+  EXPECT_TRUE(tf::extract_tar(in, sink, 512));
+  EXPECT_EQ(sink.entries().size(), 4u);
+  EXPECT_EQ(sink.files().at("dup"), "second");
+  EXPECT_EQ(sink.files().count("gone"), 0u);
+}
+
+TEST(ExtractionSinkTest, CallbackSinkReceivesBatches) {
+  std::istringstream in(make_tar(sink_test_entries()));
+  std::size_t batches = 0, begins = 0, ends = 0, bytes = 0;
+  tf::CallbackSink sink([&](std::span<const tf::ExtractionItem> batch) {
+    ++batches;
+    for (const auto &item : batch) {
+      begins += item.begins_entry;
+      ends += item.ends_entry;
+      bytes += item.data.size();
+    }
+  });
+  EXPECT_TRUE(tf::extract_tar(in, sink, 1024));
+  EXPECT_EQ(begins, 6u);
+  EXPECT_EQ(ends, 6u);
+  EXPECT_EQ(bytes, 1500u + 3u + 700u);
+  EXPECT_LT(batches, 10u);
+}
+
+TEST(ExtractionSinkTest, FilesystemSinkWritesTree) {
+  const auto root = fs::temp_directory_path() /
+                    ("tar-filter-sink-" + std::to_string(::getpid()));
+  fs::remove_all(root);
+  {
+    std::istringstream in(make_tar(sink_test_entries()));
+    tf::FilesystemSink sink(root);
+    EXPECT_TRUE(tf::extract_tar(in, sink, 512));
+  }
+  EXPECT_EQ(read_file(root / "top/a.txt"), std::string(1500, 'a'));
+  EXPECT_EQ(read_file(root / "top/nested/b.txt"), "bee");
+  EXPECT_EQ(fs::file_size(root / "top/empty"), 0u);
+  EXPECT_EQ(read_file(root / "c.txt"), std::string(700, 'c'));
+  EXPECT_TRUE(fs::is_symlink(root / "top/link"));
+  EXPECT_EQ(read_file(root / "top/link"), std::string(1500, 'a'));
+  fs::remove_all(root);
+
+  std::istringstream evil(make_tar({{"../escape", "x"}}));
+  tf::FilesystemSink sink(root);
+  EXPECT_THROW(tf::extract_tar(evil, sink), std::system_error);
+  EXPECT_FALSE(fs::exists(root.parent_path() / "escape"));
+  fs::remove_all(root);
+}
+
+TEST(ExtractionSinkTest, FilesystemSinkDoesNotFollowSymlinks) {
+  const auto base = fs::temp_directory_path() /
+                    ("tar-filter-symlink-" + std::to_string(::getpid()));
+  const auto root = base / "root";
+  const auto outside = base / "outside";
+  fs::remove_all(base);
+  fs::create_directories(outside);
+
+  // A file below a symlinked directory must not land in its target.
+  {
+    std::istringstream in(make_tar({{"evil", "", '2', 0, outside.string()},
+                                    {"evil/pwned", "x"}}));
+    tf::FilesystemSink sink(root);
+    EXPECT_THROW(tf::extract_tar(in, sink), std::system_error);
+  }
+  EXPECT_FALSE(fs::exists(outside / "pwned"));
+
+  // A file replacing a symlink replaces the link, not its target.
+  {
+    std::istringstream in(make_tar(
+        {{"lnk", "", '2', 0, (outside / "target").string()}, {"lnk", "y"}}));
+    tf::FilesystemSink sink(root);
+    EXPECT_TRUE(tf::extract_tar(in, sink));
+  }
+  EXPECT_FALSE(fs::exists(outside / "target"));
+  EXPECT_FALSE(fs::is_symlink(root / "lnk"));
+  EXPECT_EQ(read_file(root / "lnk"), "y");
+  fs::remove_all(base);
+}
+
+TEST(ExtractionSinkTest, FilesystemSinkSkipsUnchangedFiles) {
+  const auto root = fs::temp_directory_path() /
+                    ("tar-filter-skip-" + std::to_string(::getpid()));
+  fs::remove_all(root);
+  const auto archive = make_tar({{"d/one", "first", '0', 1'600'000'000},
+                                 {"d/two", std::string(2000, '2'), '0',
+                                  1'600'000'000},
+                                 {"three", "third", '0', 1'600'000'000}});
+  {
+    std::istringstream in(archive);
+    tf::FilesystemSink sink(root);
+    tf::extract_tar(in, sink, 512);
+  }
+  std::ofstream(root / "d/one", std::ios::trunc) << "edited!";
+  {
+    std::istringstream in(archive);
+    tf::FilesystemSink sink(root, {.skip_unchanged = true});
+    tf::extract_tar(in, sink, 512);
+    EXPECT_EQ(sink.skipped(), 2u);
+  }
+  EXPECT_EQ(read_file(root / "d/one"), "first");
+  EXPECT_EQ(read_file(root / "d/two"), std::string(2000, '2'));
+  fs::remove_all(root);
+}
+
+TEST(ExtractionSinkTest, FilesystemSinkLinksDuplicates) {
+  const auto root = fs::temp_directory_path() /
+                    ("tar-filter-dedup-" + std::to_string(::getpid()));
+  fs::remove_all(root);
+  const std::string license(3000, 'L');
+  {
+    std::istringstream in(make_tar({{"a/LICENSE", license},
+                                    {"b/LICENSE", license},
+                                    {"c/COPYING", license},
+                                    {"d/other", "different"}}));
+    tf::FilesystemSink sink(root, {.deduplicate = true});
+    tf::extract_tar(in, sink, 512);
+    EXPECT_EQ(sink.linked(), 2u);
+  }
+  EXPECT_EQ(read_file(root / "b/LICENSE"), license);
+  EXPECT_EQ(read_file(root / "c/COPYING"), license);
+  EXPECT_EQ(read_file(root / "d/other"), "different");
+  EXPECT_EQ(fs::hard_link_count(root / "a/LICENSE"), 3u);
+  fs::remove_all(root);
+}
+
+TEST(ExtractionSinkTest, FilesystemSinkOverwriteKeepsLinkedDuplicates) {
+  const auto root = fs::temp_directory_path() /
+                    ("tar-filter-overwrite-" + std::to_string(::getpid()));
+  fs::remove_all(root);
+  {
+    std::istringstream in(make_tar(
+        {{"a", "SAME"}, {"b", "SAME"}, {"a", "NEW-A"}, {"c", "SAME"}}));
+    tf::FilesystemSink sink(root, {.deduplicate = true});
+    EXPECT_TRUE(tf::extract_tar(in, sink));
+  }
+  EXPECT_EQ(read_file(root / "a"), "NEW-A");
+  EXPECT_EQ(read_file(root / "b"), "SAME");
+  EXPECT_EQ(read_file(root / "c"), "SAME");
+  EXPECT_EQ(fs::hard_link_count(root / "a"), 1u);
+  fs::remove_all(root);
+}
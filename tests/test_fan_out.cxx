@@ -0,0 +1,42 @@
+#include "test-utils.hxx"
+
+#include <boost-iostreams-tar-filter/fan-out.hxx>
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace tf = boost_iostreams_tar_filter;
+
+/**
+ * @brief Raw and TAR consumers all observe the complete stream, and a
+ * failing consumer neither stalls the others nor goes unreported.
+ */
+TEST(FanOutTest, DeliversStreamToEveryConsumer) {
+  std::vector<TestEntry> entries;
+  for (int i = 0; i < 20; ++i)
+    entries.push_back({"file-" + std::to_string(i), std::string(777 * i, 'x')});
+  const auto archive = make_tar(entries);
+
+  std::istringstream in(archive);
+  std::string raw;
+  CollectingVisitor first, second;
+  tf::FanOut fan_out(64, 2);
+  fan_out.add_consumer([&](const char *b, const char *e) { raw.append(b, e); });
+  fan_out.add_consumer(first);
+  fan_out.add_consumer(second);
+  fan_out.add_consumer([](const char *, const char *) {
+    throw std::runtime_error("consumer failed");
+  });
+  EXPECT_THROW(fan_out.run(in), std::runtime_error);
+
+  EXPECT_EQ(raw, archive);
+  for (const auto *visitor : {&first, &second}) {
+    ASSERT_EQ(visitor->entries.size(), entries.size());
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+      EXPECT_EQ(visitor->entries[i].first.name, entries[i].name);
+      EXPECT_EQ(visitor->entries[i].second, entries[i].data);
+    }
+  }
+}
@@ -0,0 +1,118 @@
+#include "test-utils.hxx"
+
+#include <boost-iostreams-tar-filter/gzip-decompressor.hxx>
+#include <boost-iostreams-tar-filter/tar-filter.hxx>
+
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/device/file.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <ios>
+#include <stdexcept>
+#include <string>
+
+namespace fs = std::filesystem;
+namespace io = boost::iostreams;
+namespace tf = boost_iostreams_tar_filter;
+
+/**
+ * @brief gzip-compress a string in memory.
+ */
+static std::string gzip(const std::string &data) {
+  std::string out;
+  io::filtering_ostream os;
+  os.push(io::gzip_compressor());
+  os.push(io::back_inserter(out));
+  os << data;
+  os.reset();
+  return out;
+}
+
+/**
+ * @brief Read a whole filtering_istream into a string.
+ */
+static std::string drain(io::filtering_istream &in) {
+  return std::string((std::istreambuf_iterator<char>(in)),
+                     std::istreambuf_iterator<char>());
+}
+
+/**
+ * @brief Runs once per inflate engine compiled into this build.
+ */
+class GzipDecompressorTest : public ::testing::TestWithParam<tf::InflateEngine> {
+};
+
+/**
+ * @brief Drop-in for gzip_decompressor in front of TarFilter on the test
+ * assets.
+ */
+TEST_P(GzipDecompressorTest, MatchesBoostOnAssets) {
+  for (auto name : {"single-file.tar.gz", "multi-file-multi-level.tar.gz"}) {
+    const auto path = fs::path(__FILE__).parent_path() / "assets" / name;
+
+    io::filtering_istream expected_in;
+    expected_in.push(tf::TarFilter<>());
+    expected_in.push(io::gzip_decompressor());
+    expected_in.push(io::file_source(path.string(), std::ios::binary));
+
+    io::filtering_istream in;
+    in.push(tf::TarFilter<>());
+    in.push(tf::GzipDecompressor<>(GetParam()));
+    in.push(io::file_source(path.string(), std::ios::binary));
+
+    EXPECT_EQ(drain(in), drain(expected_in)) << name;
+  }
+}
+
+/**
+ * @brief Concatenated members decompress as one stream, with buffers much
+ * smaller than a deflate block.
+ */
+TEST_P(GzipDecompressorTest, ConcatenatedMembers) {
+  std::string data;
+  for (int i = 0; i < 20000; ++i)
+    data += "line " + std::to_string(i * 7919 % 10007) + "\n";
+  auto const compressed = gzip(data.substr(0, 50000)) + gzip(data.substr(50000));
+
+  io::filtering_istream in;
+  in.push(tf::GzipDecompressor<>(GetParam(), 97));
+  in.push(io::array_source(compressed.data(), compressed.size()));
+  EXPECT_EQ(drain(in), data);
+}
+
+TEST_P(GzipDecompressorTest, TruncatedInputThrows) {
+  auto compressed = gzip(std::string(100000, 'x') + "tail");
+  compressed.resize(compressed.size() / 2);
+
+  io::filtering_istream in;
+  in.push(tf::GzipDecompressor<>(GetParam()));
+  in.push(io::array_source(compressed.data(), compressed.size()));
+  EXPECT_THROW(drain(in), std::ios_base::failure);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Engines, GzipDecompressorTest,
+    ::testing::ValuesIn(tf::available_inflate_engines()),
+    [](const auto &info) {
+      std::string name = tf::to_string(info.param);
+      std::erase(name, '-');
+      return name;
+    });
+
+TEST(GzipDecompressorEngineTest, UnavailableEngineThrows) {
+  auto const available = tf::available_inflate_engines();
+  for (auto engine : {tf::InflateEngine::Zlib, tf::InflateEngine::ZlibNg,
+                      tf::InflateEngine::Libdeflate, tf::InflateEngine::Isal}) {
+    if (std::find(available.begin(), available.end(), engine) ==
+        available.end()) {
+      EXPECT_THROW(tf::GzipDecompressor<>{engine}, std::invalid_argument);
+    }
+  }
+}
+
+TEST(GzipDecompressorEngineTest, DefaultEngineStreams) {
+  EXPECT_NE(tf::default_inflate_engine(), tf::InflateEngine::Libdeflate);
+}
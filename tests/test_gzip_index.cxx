@@ -0,0 +1,261 @@
+#include "test-utils.hxx"
+
+#include <boost-iostreams-tar-filter/gzip-index.hxx>
+#include <boost-iostreams-tar-filter/tar-reader.hxx>
+
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+namespace io = boost::iostreams;
+namespace tf = boost_iostreams_tar_filter;
+
+/**
+ * @brief gzip-compress a string in memory.
+ */
+static std::string gzip(const std::string &data) {
+  std::string out;
+  io::filtering_ostream os;
+  os.push(io::gzip_compressor());
+  os.push(io::back_inserter(out));
+  os << data;
+  os.reset();
+  return out;
+}
+
+/**
+ * @brief Archive large enough for many deflate blocks, split over two gzip
+ * members so checkpoints cover member starts too.
+ */
+static std::vector<TestEntry> make_entries() {
+  std::mt19937 random(7);
+  std::vector<TestEntry> entries;
+  for (int i = 0; i < 64; ++i) {
+    std::string data(static_cast<std::size_t>(random() % 60000), '\0');
+    for (auto &c : data)
+      c = static_cast<char>('a' + random() % 16);
+    entries.push_back({"dir-" + std::to_string(i % 5) + "/f" + std::to_string(i),
+                       std::move(data)});
+  }
+  return entries;
+}
+
+/**
+ * @brief Per-range visitor forwarding to a CollectingVisitor owned by the
+ * test, which outlives visit_tar_gz_parallel().
+ */
+class ForwardingVisitor : public tf::EntryVisitor {
+public:
+  explicit ForwardingVisitor(CollectingVisitor &target) : target_(target) {}
+
+  bool on_entry_begin(const tf::Entry &entry) override {
+    return target_.on_entry_begin(entry);
+  }
+  void on_entry_data(const char *begin, const char *end) override {
+    target_.on_entry_data(begin, end);
+  }
+  void on_entry_end(const tf::Entry &entry) override {
+    target_.on_entry_end(entry);
+  }
+
+private:
+  CollectingVisitor &target_;
+};
+
+static std::string make_tar_gz(const std::string &archive) {
+  auto const half = archive.size() / 2;
+  return gzip(archive.substr(0, half)) + gzip(archive.substr(half));
+}
+
+/**
+ * @brief Ranges inflated from checkpoints see the same entries as one
+ * sequential pass, and the index survives serialization.
+ */
+TEST(GzipIndexTest, ParallelVisitMatchesSequential) {
+  auto const entries = make_entries();
+  auto const archive = make_tar(entries);
+  auto const compressed = make_tar_gz(archive);
+
+  std::istringstream index_in(compressed);
+  auto const built = tf::GzipIndex::build(index_in, 64 * 1024);
+  EXPECT_EQ(built.uncompressed_size, archive.size());
+  ASSERT_EQ(built.entries.size(), entries.size());
+  EXPECT_GT(built.checkpoints.size(), 4u);
+
+  std::stringstream serialized;
+  built.write(serialized);
+  auto const index = tf::GzipIndex::read(serialized);
+  ASSERT_EQ(index.checkpoints.size(), built.checkpoints.size());
+  EXPECT_EQ(index.entries[10].name, built.entries[10].name);
+  EXPECT_EQ(index.entries[10].header_offset, built.entries[10].header_offset);
+
+  std::deque<CollectingVisitor> visitors;
+  auto const ranges = tf::visit_tar_gz_parallel(
+      index,
+      [&] { return std::make_unique<std::istringstream>(compressed); },
+      [&](std::size_t) {
+        return std::make_unique<ForwardingVisitor>(visitors.emplace_back());
+      },
+      4);
+  EXPECT_GT(ranges, 1u);
+
+  std::istringstream sequential_in(archive);
+  CollectingVisitor sequential;
+  tf::visit_tar(sequential_in, sequential);
+
+  std::vector<std::pair<tf::Entry, std::string>> merged;
+  for (const auto &visitor : visitors)
+    merged.insert(merged.end(), visitor.entries.begin(), visitor.entries.end());
+  ASSERT_EQ(merged.size(), sequential.entries.size());
+  for (std::size_t i = 0; i < merged.size(); ++i) {
+    EXPECT_EQ(merged[i].first.name, sequential.entries[i].first.name);
+    EXPECT_EQ(merged[i].second, sequential.entries[i].second);
+  }
+}
+
+/**
+ * @brief Counts payload callbacks in a counter owned by the test, slowly
+ * enough that other ranges are still running when one of them fails.
+ */
+class SlowCountingVisitor : public tf::EntryVisitor {
+public:
+  explicit SlowCountingVisitor(std::atomic<std::size_t> &calls)
+      : calls_(calls) {}
+
+  bool on_entry_begin(const tf::Entry &) override { return true; }
+  void on_entry_data(const char *, const char *) override {
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    ++calls_;
+  }
+  void on_entry_end(const tf::Entry &) override {}
+
+private:
+  std::atomic<std::size_t> &calls_;
+};
+
+/**
+ * @brief When one range fails, the others finish before the error is
+ * rethrown and their visitors are destroyed.
+ */
+TEST(GzipIndexTest, ParallelVisitWaitsForRangesOnError) {
+  auto const compressed = make_tar_gz(make_tar(make_entries()));
+  std::istringstream index_in(compressed);
+  auto const index = tf::GzipIndex::build(index_in, 64 * 1024);
+
+  std::atomic<std::size_t> calls{0};
+  std::atomic<bool> failed{false};
+  EXPECT_THROW(tf::visit_tar_gz_parallel(
+                   index,
+                   [&]() -> std::unique_ptr<std::istream> {
+                     if (!failed.exchange(true))
+                       throw std::ios_base::failure("cannot open");
+                     return std::make_unique<std::istringstream>(compressed);
+                   },
+                   [&](std::size_t) {
+                     return std::make_unique<SlowCountingVisitor>(calls);
+                   },
+                   4),
+               std::ios_base::failure);
+  auto const returned_with = calls.load();
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(calls.load(), returned_with);
+  EXPECT_GT(returned_with, 0u);
+}
+
+/**
+ * @brief Hard links are created after every range finished, even when their
+ * target lives in a later range.
+ */
+TEST(GzipIndexTest, ParallelExtractionDefersHardLinks) {
+  const auto root = fs::temp_directory_path() /
+                    ("tar-filter-gzip-index-" + std::to_string(::getpid()));
+  fs::remove_all(root);
+
+  auto entries = make_entries();
+  entries.insert(entries.begin(),
+                 TestEntry{"link", "", '1', 0, entries.back().name});
+  auto const compressed = make_tar_gz(make_tar(entries));
+
+  std::istringstream index_in(compressed);
+  auto const index = tf::GzipIndex::build(index_in, 32 * 1024);
+  tf::extract_tar_gz_parallel(
+      index, [&] { return std::make_unique<std::istringstream>(compressed); },
+      root, {}, 4);
+
+  for (std::size_t i = 1; i < entries.size(); ++i) {
+    std::ifstream file(root / entries[i].name, std::ios::binary);
+    std::string contents((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+    EXPECT_EQ(contents, entries[i].data) << entries[i].name;
+  }
+  EXPECT_TRUE(fs::equivalent(root / "link", root / entries.back().name));
+  fs::remove_all(root);
+}
+
+/**
+ * @brief A path stored in two ranges ends up with its last copy, although
+ * the range holding the first copy finishes last.
+ */
+TEST(GzipIndexTest, ParallelExtractionKeepsLastDuplicate) {
+  const auto root = fs::temp_directory_path() /
+                    ("tar-filter-gzip-dup-" + std::to_string(::getpid()));
+  fs::remove_all(root);
+
+  auto entries = make_entries();
+  entries.insert(entries.begin(), TestEntry{"dup", std::string(65536, 'f')});
+  entries.push_back({"dup", "last"});
+  auto const compressed = make_tar_gz(make_tar(entries));
+
+  std::istringstream index_in(compressed);
+  auto const index = tf::GzipIndex::build(index_in, 32 * 1024);
+  // Hold back the first range to start so that it finishes last.
+  std::atomic<bool> first{true};
+  tf::extract_tar_gz_parallel(
+      index,
+      [&] {
+        if (first.exchange(false))
+          std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        return std::make_unique<std::istringstream>(compressed);
+      },
+      root, {}, 4);
+
+  std::ifstream file(root / "dup", std::ios::binary);
+  EXPECT_EQ(std::string(std::istreambuf_iterator<char>(file), {}), "last");
+  fs::remove_all(root);
+}
+
+/**
+ * @brief The fused decoder reports the same entries as visit_tar() over the
+ * uncompressed archive, across gzip member boundaries and with a buffer size
+ * unrelated to the 512-byte block size.
+ */
+TEST(GzipIndexTest, FusedDecoderMatchesVisitTar) {
+  auto const entries = make_entries();
+  auto const archive = make_tar(entries);
+
+  std::istringstream compressed_in(make_tar_gz(archive));
+  CollectingVisitor fused;
+  EXPECT_TRUE(tf::visit_tar_gz(compressed_in, fused, 1000));
+
+  std::istringstream plain_in(archive);
+  CollectingVisitor plain;
+  tf::visit_tar(plain_in, plain);
+
+  ASSERT_EQ(fused.entries.size(), plain.entries.size());
+  for (std::size_t i = 0; i < fused.entries.size(); ++i) {
+    EXPECT_EQ(fused.entries[i].first.name, plain.entries[i].first.name);
+    EXPECT_EQ(fused.entries[i].second, plain.entries[i].second);
+  }
+}
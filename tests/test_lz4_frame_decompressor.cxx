@@ -0,0 +1,114 @@
+#include "test-utils.hxx"
+
+#include <boost-iostreams-tar-filter/lz4-frame-decompressor.hxx>
+#include <boost-iostreams-tar-filter/tar-filter.hxx>
+
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <gtest/gtest.h>
+#include <ios>
+#include <lz4frame.h>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace io = boost::iostreams;
+namespace tf = boost_iostreams_tar_filter;
+
+/**
+ * @brief Compress a string into one LZ4 frame with 64 KiB blocks and both
+ * checksums.
+ */
+static std::string lz4(const std::string &data, bool independent) {
+  LZ4F_preferences_t preferences{};
+  preferences.frameInfo.blockSizeID = LZ4F_max64KB;
+  preferences.frameInfo.blockMode =
+      independent ? LZ4F_blockIndependent : LZ4F_blockLinked;
+  preferences.frameInfo.contentChecksumFlag = LZ4F_contentChecksumEnabled;
+  preferences.frameInfo.blockChecksumFlag = LZ4F_blockChecksumEnabled;
+  preferences.frameInfo.contentSize = data.size();
+
+  std::string out(LZ4F_compressFrameBound(data.size(), &preferences), '\0');
+  auto const size = LZ4F_compressFrame(out.data(), out.size(), data.data(),
+                                       data.size(), &preferences);
+  if (LZ4F_isError(size))
+    throw std::runtime_error("LZ4F_compressFrame");
+  out.resize(size);
+  return out;
+}
+
+static std::string decompress(const std::string &compressed,
+                              std::size_t threads) {
+  io::filtering_istream in;
+  in.push(tf::Lz4FrameDecompressor<>(threads, 2, 1000));
+  in.push(io::array_source(compressed.data(), compressed.size()));
+  return std::string(std::istreambuf_iterator<char>(in),
+                     std::istreambuf_iterator<char>());
+}
+
+/**
+ * @brief Archive with repetitive and random payloads, so that some blocks
+ * are stored uncompressed.
+ */
+static std::string make_archive() {
+  std::mt19937 random(11);
+  std::vector<TestEntry> entries;
+  for (int i = 0; i < 6; ++i) {
+    std::string data;
+    while (data.size() < 100000) {
+      if (i % 2)
+        data.push_back(static_cast<char>(random()));
+      else
+        data.append(random() % 40, static_cast<char>('a' + random() % 4));
+    }
+    entries.push_back({"f" + std::to_string(i), std::move(data)});
+  }
+  return make_tar(entries);
+}
+
+TEST(Lz4FrameDecompressorTest, DecodesIndependentBlocks) {
+  auto const archive = make_archive();
+  auto const compressed = lz4(archive, true);
+  for (std::size_t threads : {1, 4})
+    EXPECT_EQ(decompress(compressed, threads), archive) << threads;
+}
+
+TEST(Lz4FrameDecompressorTest, DecodesLinkedBlocks) {
+  auto const archive = make_archive();
+  EXPECT_EQ(decompress(lz4(archive, false), 2), archive);
+}
+
+/**
+ * @brief Concatenated frames with a skippable frame between them feed
+ * TarFilter like the plain archive.
+ */
+TEST(Lz4FrameDecompressorTest, ConcatenatedFramesBehindTarFilter) {
+  auto const archive = make_archive();
+  auto const half = archive.size() / 2;
+  std::string const skippable("\x50\x2A\x4D\x18\x03\x00\x00\x00xyz", 11);
+  auto const compressed = lz4(archive.substr(0, half), true) + skippable +
+                          lz4(archive.substr(half), false);
+
+  io::filtering_istream expected_in;
+  expected_in.push(tf::TarFilter<>());
+  expected_in.push(io::array_source(archive.data(), archive.size()));
+  std::string const expected(std::istreambuf_iterator<char>(expected_in), {});
+
+  io::filtering_istream in;
+  in.push(tf::TarFilter<>());
+  in.push(tf::Lz4FrameDecompressor<>(4));
+  in.push(io::array_source(compressed.data(), compressed.size()));
+  EXPECT_EQ(std::string(std::istreambuf_iterator<char>(in), {}), expected);
+}
+
+TEST(Lz4FrameDecompressorTest, CorruptBlockThrows) {
+  auto compressed = lz4(make_archive(), true);
+  compressed[compressed.size() / 2] ^= 0x40;
+  EXPECT_THROW(decompress(compressed, 2), std::ios_base::failure);
+}
+
+TEST(Lz4FrameDecompressorTest, TruncatedFrameThrows) {
+  auto compressed = lz4(make_archive(), true);
+  compressed.resize(compressed.size() - 5);
+  EXPECT_THROW(decompress(compressed, 2), std::ios_base::failure);
+}
@@ -0,0 +1,185 @@
+#include "test-utils.hxx"
+
+#include <boost-iostreams-tar-filter/gzip-index.hxx>
+#include <boost-iostreams-tar-filter/multi-part-source.hxx>
+#include <boost-iostreams-tar-filter/tar-filter.hxx>
+#include <boost-iostreams-tar-filter/tar-reader.hxx>
+
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+namespace io = boost::iostreams;
+namespace tf = boost_iostreams_tar_filter;
+
+namespace {
+std::vector<TestEntry> make_entries() {
+  std::mt19937 random(11);
+  std::vector<TestEntry> entries;
+  for (int i = 0; i < 12; ++i) {
+    std::string data(static_cast<std::size_t>(random() % 20000), '\0');
+    for (auto &c : data)
+      c = static_cast<char>('a' + random() % 16);
+    entries.push_back({"f" + std::to_string(i), std::move(data)});
+  }
+  return entries;
+}
+
+/**
+ * @brief Temporary directory holding the parts of a split file.
+ */
+class MultiPartSourceTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    root_ = fs::temp_directory_path() /
+            ("tar-filter-split-" + std::to_string(::getpid()));
+    fs::remove_all(root_);
+    fs::create_directories(root_);
+  }
+  void TearDown() override { fs::remove_all(root_); }
+
+  /**
+   * @brief Write data as parts of part_size bytes named like `split`'s
+   * output, plus an unrelated file sharing the prefix.
+   */
+  fs::path split(const std::string &data, std::size_t part_size) {
+    auto const prefix = root_ / "archive.";
+    std::size_t index = 0;
+    for (std::size_t offset = 0; offset < data.size();
+         offset += part_size, ++index) {
+      std::string suffix{static_cast<char>('a' + index / 26),
+                         static_cast<char>('a' + index % 26)};
+      std::ofstream(prefix.string() + suffix, std::ios::binary)
+          << data.substr(offset, part_size);
+    }
+    std::ofstream(prefix.string() + "aa.sha256") << "not a part";
+    return prefix;
+  }
+
+  fs::path root_;
+};
+
+std::string gzip(const std::string &data) {
+  std::string out;
+  io::filtering_ostream os;
+  os.push(io::gzip_compressor());
+  os.push(io::back_inserter(out));
+  os << data;
+  os.reset();
+  return out;
+}
+} // unnamed namespace
+
+TEST_F(MultiPartSourceTest, FindsPartsInOrder) {
+  auto const prefix = split(std::string(100, 'x'), 3);
+  auto const parts = tf::find_split_parts(prefix);
+  ASSERT_EQ(parts.size(), 34u);
+  EXPECT_EQ(parts.front().filename(), "archive.aa");
+  EXPECT_EQ(parts[26].filename(), "archive.ba");
+  EXPECT_EQ(parts.back().filename(), "archive.bh");
+  EXPECT_THROW(tf::find_split_parts(root_ / "missing."), std::invalid_argument);
+}
+
+TEST_F(MultiPartSourceTest, FiltersTarAcrossParts) {
+  auto const entries = make_entries();
+  auto const archive = make_tar(entries);
+  auto const parts = tf::find_split_parts(split(archive, 4000));
+  ASSERT_GT(parts.size(), 2u);
+
+  io::filtering_istream in;
+  in.push(tf::TarFilter<>());
+  in.push(tf::MultiPartSource(parts));
+  std::string expected;
+  for (const auto &entry : entries)
+    expected += entry.data;
+  EXPECT_EQ(std::string(std::istreambuf_iterator<char>(in), {}), expected);
+}
+
+/**
+ * @brief Seeks land on the right part, including empty parts and the end,
+ * and visit_tar() can seek over declined payloads.
+ */
+TEST_F(MultiPartSourceTest, SeeksAcrossParts) {
+  auto const archive = make_tar(make_entries());
+  auto parts = tf::find_split_parts(split(archive, 1000));
+  std::ofstream(root_ / "empty", std::ios::binary).flush();
+  parts.insert(parts.begin() + 2, root_ / "empty");
+
+  io::stream<tf::MultiPartSource> in(parts);
+  EXPECT_EQ(in->size(), archive.size());
+  EXPECT_EQ(in->part_offsets()[3], 2000u);
+  for (std::uint64_t offset : {0, 999, 1000, 1999, 2000, 12345}) {
+    in.seekg(static_cast<std::streamoff>(offset));
+    char buffer[1500];
+    in.read(buffer, sizeof(buffer));
+    EXPECT_EQ(std::string(buffer, buffer + in.gcount()),
+              archive.substr(offset, sizeof(buffer)))
+        << offset;
+  }
+  in.clear();
+  in.seekg(0, std::ios_base::end);
+  EXPECT_EQ(static_cast<std::uint64_t>(in.tellg()), archive.size());
+
+  in.seekg(0);
+  struct Names : tf::EntryVisitor {
+    bool on_entry_begin(const tf::Entry &entry) override {
+      names.push_back(entry.name);
+      return false;
+    }
+    void on_entry_data(const char *, const char *) override {}
+    void on_entry_end(const tf::Entry &) override {}
+    std::vector<std::string> names;
+  } visitor;
+  EXPECT_TRUE(tf::visit_tar(in, visitor, 512));
+  EXPECT_EQ(visitor.names.size(), 12u);
+}
+
+TEST_F(MultiPartSourceTest, IndexesSplitTarGz) {
+  auto const entries = make_entries();
+  auto const archive = make_tar(entries);
+  auto const parts = tf::find_split_parts(split(gzip(archive), 7000));
+
+  io::stream<tf::MultiPartSource> index_in(parts);
+  auto const index = tf::GzipIndex::build(index_in, 16 * 1024);
+  EXPECT_EQ(index.uncompressed_size, archive.size());
+
+  std::deque<CollectingVisitor> visitors;
+  struct Forward : tf::EntryVisitor {
+    explicit Forward(CollectingVisitor &target) : target(target) {}
+    bool on_entry_begin(const tf::Entry &entry) override {
+      return target.on_entry_begin(entry);
+    }
+    void on_entry_data(const char *begin, const char *end) override {
+      target.on_entry_data(begin, end);
+    }
+    void on_entry_end(const tf::Entry &entry) override {
+      target.on_entry_end(entry);
+    }
+    CollectingVisitor &target;
+  };
+  tf::visit_tar_gz_parallel(
+      index,
+      [&] { return std::make_unique<io::stream<tf::MultiPartSource>>(parts); },
+      [&](std::size_t) {
+        return std::make_unique<Forward>(visitors.emplace_back());
+      },
+      3);
+
+  std::vector<std::string> payloads;
+  for (const auto &visitor : visitors)
+    for (const auto &[entry, data] : visitor.entries)
+      payloads.push_back(data);
+  ASSERT_EQ(payloads.size(), entries.size());
+  for (std::size_t i = 0; i < entries.size(); ++i)
+    EXPECT_EQ(payloads[i], entries[i].data) << i;
+}
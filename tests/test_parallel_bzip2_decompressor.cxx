@@ -0,0 +1,134 @@
+#include "test-utils.hxx"
+
+#include <boost-iostreams-tar-filter/parallel-bzip2-decompressor.hxx>
+#include <boost-iostreams-tar-filter/tar-filter.hxx>
+
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/bzip2.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <ios>
+#include <random>
+#include <string>
+
+namespace io = boost::iostreams;
+namespace tf = boost_iostreams_tar_filter;
+
+/**
+ * @brief bzip2-compress a string in memory with 100k blocks.
+ */
+static std::string bzip2(const std::string &data) {
+  std::string out;
+  io::filtering_ostream os;
+  os.push(io::bzip2_compressor(io::bzip2_params(1)));
+  os.push(io::back_inserter(out));
+  os << data;
+  os.reset();
+  return out;
+}
+
+/**
+ * @brief Read a whole filtering_istream into a string.
+ */
+static std::string drain(io::filtering_istream &in) {
+  return std::string((std::istreambuf_iterator<char>(in)),
+                     std::istreambuf_iterator<char>());
+}
+
+/**
+ * @brief Archive spanning many 100k blocks, with runs and noise so block
+ * boundaries fall at arbitrary bit offsets.
+ */
+static std::string make_archive() {
+  std::mt19937 random(3);
+  std::vector<TestEntry> entries;
+  for (int i = 0; i < 12; ++i) {
+    std::string data;
+    while (data.size() < 150000) {
+      if (random() % 3 == 0)
+        data.append(random() % 300, static_cast<char>('a' + i));
+      else
+        data.push_back(static_cast<char>(random() % 64 + ' '));
+    }
+    entries.push_back({"f" + std::to_string(i), std::move(data)});
+  }
+  return make_tar(entries);
+}
+
+/**
+ * @brief Same payload as bzip2_decompressor in front of TarFilter, for
+ * several thread counts and a concatenated (pbzip2-style) stream.
+ */
+TEST(ParallelBzip2DecompressorTest, MatchesBoostDecompressor) {
+  auto const archive = make_archive();
+  auto const half = archive.size() / 2;
+  auto const single = bzip2(archive);
+  auto const concatenated =
+      bzip2(archive.substr(0, half)) + bzip2(archive.substr(half));
+
+  io::filtering_istream expected_in;
+  expected_in.push(tf::TarFilter<>());
+  expected_in.push(io::bzip2_decompressor());
+  expected_in.push(io::array_source(single.data(), single.size()));
+  auto const expected = drain(expected_in);
+  ASSERT_FALSE(expected.empty());
+
+  for (const auto *compressed : {&single, &concatenated}) {
+    for (std::size_t threads : {1, 4}) {
+      io::filtering_istream in;
+      in.push(tf::TarFilter<>());
+      in.push(tf::ParallelBzip2Decompressor<>(threads, 2, 1000));
+      in.push(io::array_source(compressed->data(), compressed->size()));
+      EXPECT_EQ(drain(in), expected) << threads;
+    }
+  }
+}
+
+TEST(ParallelBzip2DecompressorTest, TruncatedInputThrows) {
+  auto compressed = bzip2(make_archive());
+  compressed.resize(compressed.size() * 2 / 3);
+
+  io::filtering_istream in;
+  in.push(tf::ParallelBzip2Decompressor<>(2));
+  in.push(io::array_source(compressed.data(), compressed.size()));
+  EXPECT_THROW(drain(in), std::ios_base::failure);
+}
+
+/**
+ * @brief Blocks whose data contains the block magic decode like any other.
+ *
+ * After its header, every block stores which byte values it uses as a 16-bit
+ * map of used 16-byte groups followed by one 16-bit map per used group.
+ * Using every group, and groups 0-2 exactly as 0x3141, 0x5926 and 0x5359,
+ * puts the 48-bit block magic inside each block.
+ */
+TEST(ParallelBzip2DecompressorTest, MagicInsideBlockIsNotABoundary) {
+  const std::uint16_t maps[16] = {0x3141, 0x5926, 0x5359, 0x8000, 0x8000,
+                                  0x8000, 0x8000, 0x8000, 0x8000, 0x8000,
+                                  0x8000, 0x8000, 0x8000, 0x8000, 0x8000,
+                                  0x8000};
+  std::vector<char> alphabet;
+  for (int group = 0; group < 16; ++group)
+    for (int bit = 0; bit < 16; ++bit)
+      if (maps[group] & (0x8000 >> bit))
+        alphabet.push_back(static_cast<char>(group * 16 + bit));
+
+  // No runs of four equal bytes: their run-length byte would add a value.
+  std::mt19937 random(5);
+  std::string data;
+  while (data.size() < 350000) {
+    auto const c = alphabet[random() % alphabet.size()];
+    if (!data.ends_with(std::string(3, c)))
+      data.push_back(c);
+  }
+  auto const compressed = bzip2(data);
+
+  for (std::size_t threads : {1, 4}) {
+    io::filtering_istream in;
+    in.push(tf::ParallelBzip2Decompressor<>(threads, 2, 1000));
+    in.push(io::array_source(compressed.data(), compressed.size()));
+    EXPECT_EQ(drain(in), data) << threads;
+  }
+}
@@ -0,0 +1,83 @@
+#include "test-utils.hxx"
+
+#include <boost-iostreams-tar-filter/extraction-sink.hxx>
+#include <boost-iostreams-tar-filter/parallel-member-decompressor.hxx>
+#include <boost-iostreams-tar-filter/tar-reader.hxx>
+
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+
+namespace io = boost::iostreams;
+namespace tf = boost_iostreams_tar_filter;
+
+/**
+ * @brief gzip-compress a string in memory.
+ */
+static std::string gzip(const std::string &data) {
+  std::string out;
+  io::filtering_ostream os;
+  os.push(io::gzip_compressor());
+  os.push(io::back_inserter(out));
+  os << data;
+  os.reset();
+  return out;
+}
+
+/**
+ * @brief Compressed and plain members come out decompressed and in archive
+ * order, regardless of which worker finishes first.
+ */
+TEST(ParallelMemberDecompressorTest, PreservesArchiveOrder) {
+  std::vector<TestEntry> entries;
+  for (int i = 0; i < 32; ++i) {
+    auto payload = std::string(1000 * (32 - i), static_cast<char>('a' + i % 26));
+    if (i % 3 == 0)
+      entries.push_back({"plain-" + std::to_string(i) + ".txt", payload});
+    else
+      entries.push_back({"data-" + std::to_string(i) + ".json.gz", gzip(payload)});
+  }
+  entries.push_back({"dir/", "", '5'});
+
+  std::istringstream in(make_tar(entries));
+  CollectingVisitor collected;
+  tf::ParallelMemberDecompressor stage(collected, 4, 3);
+  EXPECT_TRUE(tf::visit_tar(in, stage, 700));
+  stage.finish();
+
+  ASSERT_EQ(collected.entries.size(), entries.size());
+  for (int i = 0; i < 32; ++i) {
+    const auto &[entry, data] = collected.entries[i];
+    auto expected = std::string(1000 * (32 - i), static_cast<char>('a' + i % 26));
+    EXPECT_EQ(data, expected) << entry.name;
+    EXPECT_EQ(entry.size, expected.size());
+    EXPECT_EQ(entry.name, i % 3 == 0 ? "plain-" + std::to_string(i) + ".txt"
+                                     : "data-" + std::to_string(i) + ".json");
+  }
+  EXPECT_TRUE(collected.entries.back().first.is_directory());
+}
+
+/**
+ * @brief A batching downstream visitor receives every decoded entry, and
+ * its payload before the stage releases it.
+ */
+TEST(ParallelMemberDecompressorTest, FeedsBatchingVisitors) {
+  std::istringstream in(make_tar({{"a.txt.gz", gzip(std::string(5000, 'a'))},
+                                  {"b.txt", std::string(1500, 'b')},
+                                  {"c.txt.gz", gzip("see")}}));
+  tf::MemorySink sink;
+  tf::ExtractionVisitor extraction(sink);
+  tf::ParallelMemberDecompressor stage(extraction, 2);
+  EXPECT_TRUE(tf::visit_tar(in, stage, 512));
+  stage.finish();
+
+  ASSERT_EQ(sink.files().size(), 3u);
+  EXPECT_EQ(sink.files().at("a.txt"), std::string(5000, 'a'));
+  EXPECT_EQ(sink.files().at("b.txt"), std::string(1500, 'b'));
+  EXPECT_EQ(sink.files().at("c.txt"), "see");
+}
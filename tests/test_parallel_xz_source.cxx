@@ -0,0 +1,174 @@
+#include "test-utils.hxx"
+
+#include <boost-iostreams-tar-filter/parallel-xz-source.hxx>
+#include <boost-iostreams-tar-filter/tar-reader.hxx>
+
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/iostreams/stream.hpp>
+#include <gtest/gtest.h>
+#include <ios>
+#include <lzma.h>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace io = boost::iostreams;
+namespace tf = boost_iostreams_tar_filter;
+
+/**
+ * @brief xz-compress a string in memory, cutting a block every block_size
+ * bytes like `xz -T`.
+ */
+static std::string xz(const std::string &data, std::uint64_t block_size) {
+  lzma_mt options{};
+  options.threads = 1;
+  options.block_size = block_size;
+  options.preset = 1;
+  options.check = LZMA_CHECK_CRC64;
+  lzma_stream stream = LZMA_STREAM_INIT;
+  if (lzma_stream_encoder_mt(&stream, &options) != LZMA_OK)
+    throw std::runtime_error("lzma_stream_encoder_mt");
+
+  std::string out(lzma_stream_buffer_bound(data.size()), '\0');
+  stream.next_in = reinterpret_cast<const std::uint8_t *>(data.data());
+  stream.avail_in = data.size();
+  stream.next_out = reinterpret_cast<std::uint8_t *>(out.data());
+  stream.avail_out = out.size();
+  auto ret = LZMA_OK;
+  while (ret == LZMA_OK)
+    ret = lzma_code(&stream, LZMA_FINISH);
+  out.resize(out.size() - stream.avail_out);
+  lzma_end(&stream);
+  if (ret != LZMA_STREAM_END)
+    throw std::runtime_error("lzma_code");
+  return out;
+}
+
+static std::unique_ptr<std::istream> memory_stream(const std::string &data) {
+  return std::make_unique<std::istringstream>(data);
+}
+
+static std::string make_archive() {
+  std::mt19937 random(5);
+  std::vector<TestEntry> entries;
+  for (int i = 0; i < 8; ++i) {
+    std::string data;
+    while (data.size() < 60000)
+      data.push_back(static_cast<char>(random() % 16 + 'a'));
+    entries.push_back({"f" + std::to_string(i), std::move(data)});
+  }
+  return make_tar(entries);
+}
+
+/**
+ * @brief The source reproduces the archive for one stream, concatenated
+ * padded streams and several thread counts.
+ */
+TEST(ParallelXzSourceTest, DecodesMultiBlockStreams) {
+  auto const archive = make_archive();
+  auto const half = archive.size() / 2;
+  auto const single = xz(archive, 32768);
+  auto const concatenated = xz(archive.substr(0, half), 32768) +
+                            std::string(8, '\0') +
+                            xz(archive.substr(half), 50000);
+
+  for (const auto *compressed : {&single, &concatenated}) {
+    for (std::size_t threads : {1, 4}) {
+      tf::ParallelXzSource source(memory_stream(*compressed), threads, 3);
+      EXPECT_GT(source.blocks().size(), 10u);
+      EXPECT_EQ(source.size(), archive.size());
+
+      io::filtering_istream in;
+      in.push(source);
+      EXPECT_EQ(std::string(std::istreambuf_iterator<char>(in),
+                            std::istreambuf_iterator<char>()),
+                archive)
+          << threads;
+    }
+  }
+}
+
+TEST(ParallelXzSourceTest, SeeksByBlock) {
+  auto const archive = make_archive();
+  auto const compressed = xz(archive, 20000);
+  io::stream<tf::ParallelXzSource> in(
+      tf::ParallelXzSource(memory_stream(compressed), 2, 2));
+
+  std::mt19937 random(9);
+  for (int i = 0; i < 20; ++i) {
+    auto const offset = random() % archive.size();
+    auto const length = std::min<std::size_t>(5000, archive.size() - offset);
+    std::string chunk(length, '\0');
+    in.clear();
+    in.seekg(static_cast<std::streamoff>(offset));
+    ASSERT_TRUE(in.read(chunk.data(), static_cast<std::streamsize>(length)));
+    EXPECT_EQ(chunk, archive.substr(offset, length)) << offset;
+  }
+
+  in.clear();
+  in.seekg(0, std::ios_base::end);
+  EXPECT_EQ(static_cast<std::uint64_t>(in.tellg()), archive.size());
+  EXPECT_EQ(in.get(), std::char_traits<char>::eof());
+}
+
+TEST(ParallelXzSourceTest, VisitTarSeeksOverDeclinedPayloads) {
+  auto const archive = make_archive();
+  auto const compressed = xz(archive, 16384);
+  io::stream<tf::ParallelXzSource> in(
+      tf::ParallelXzSource(memory_stream(compressed), 2, 2));
+
+  struct LastOnly : CollectingVisitor {
+    bool on_entry_begin(const tf::Entry &entry) override {
+      return entry.name == "f7" && CollectingVisitor::on_entry_begin(entry);
+    }
+  } visitor;
+  EXPECT_TRUE(tf::visit_tar(in, visitor, 4096));
+  ASSERT_EQ(visitor.entries.size(), 1u);
+  EXPECT_EQ(visitor.entries[0].second.size(), 60000u);
+}
+
+/**
+ * @brief Blocks above the limit and the block of a single-block file are
+ * decoded incrementally, including across seeks inside the block.
+ */
+TEST(ParallelXzSourceTest, StreamsLargeBlocks) {
+  auto const archive = make_archive();
+  auto const half = archive.size() / 2;
+  auto const mixed = xz(archive.substr(0, half), 300000) +
+                     xz(archive.substr(half), 20000);
+  auto const single = xz(archive, archive.size());
+  ASSERT_EQ(tf::ParallelXzSource(memory_stream(single)).blocks().size(), 1u);
+
+  for (const auto *compressed : {&mixed, &single}) {
+    {
+      tf::ParallelXzSource source(memory_stream(*compressed), 2, 2, 100000);
+      io::filtering_istream in;
+      in.push(source);
+      EXPECT_EQ(std::string(std::istreambuf_iterator<char>(in),
+                            std::istreambuf_iterator<char>()),
+                archive);
+    }
+
+    io::stream<tf::ParallelXzSource> in(
+        tf::ParallelXzSource(memory_stream(*compressed), 2, 2, 100000));
+    std::mt19937 random(11);
+    for (int i = 0; i < 20; ++i) {
+      auto const offset = random() % archive.size();
+      auto const length = std::min<std::size_t>(3000, archive.size() - offset);
+      std::string chunk(length, '\0');
+      in.clear();
+      in.seekg(static_cast<std::streamoff>(offset));
+      ASSERT_TRUE(in.read(chunk.data(), static_cast<std::streamsize>(length)));
+      EXPECT_EQ(chunk, archive.substr(offset, length)) << offset;
+    }
+  }
+}
+
+TEST(ParallelXzSourceTest, RejectsTruncatedFile) {
+  auto compressed = xz(make_archive(), 32768);
+  compressed.resize(compressed.size() - 3);
+  EXPECT_THROW(tf::ParallelXzSource(memory_stream(compressed)),
+               std::ios_base::failure);
+}
@@ -0,0 +1,108 @@
+#include "test-utils.hxx"
+
+#include <boost-iostreams-tar-filter/pipe-source.hxx>
+#include <boost-iostreams-tar-filter/tar-filter.hxx>
+
+#include <boost/iostreams/filtering_stream.hpp>
+#include <cstdio>
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+namespace io = boost::iostreams;
+namespace tf = boost_iostreams_tar_filter;
+
+namespace {
+/**
+ * @brief Write data into a pipe in small chunks from another thread, then
+ * close the write end.
+ */
+std::jthread trickle(int fd, const std::string &data, std::size_t chunk) {
+  return std::jthread([fd, &data, chunk] {
+    for (std::size_t offset = 0; offset < data.size();) {
+      auto const count = ::write(fd, data.data() + offset,
+                                 std::min(chunk, data.size() - offset));
+      if (count <= 0)
+        break;
+      offset += static_cast<std::size_t>(count);
+    }
+    ::close(fd);
+  });
+}
+
+std::string pattern(std::size_t size) {
+  std::string data(size, '\0');
+  for (std::size_t i = 0; i < size; ++i)
+    data[i] = static_cast<char>('a' + i % 17);
+  return data;
+}
+} // unnamed namespace
+
+/**
+ * @brief The pipe is grown and every read but the last returns a full
+ * buffer, although the writer only writes 100 bytes at a time.
+ */
+TEST(PipeSourceTest, ReadsFullBuffersFromSmallWrites) {
+  int fds[2];
+  ASSERT_EQ(::pipe(fds), 0);
+  tf::PipeSource source(fds[0], 256 * 1024);
+  EXPECT_TRUE(source.is_pipe());
+  EXPECT_EQ(::fcntl(fds[0], F_GETPIPE_SZ), 256 * 1024);
+  EXPECT_EQ(source.optimal_buffer_size(), 256 * 1024);
+
+  auto const data = pattern(300000);
+  auto writer = trickle(fds[1], data, 100);
+  std::string received;
+  std::vector<std::streamsize> reads;
+  char buffer[65536];
+  for (std::streamsize count;
+       (count = source.read(buffer, sizeof(buffer))) > 0;) {
+    reads.push_back(count);
+    received.append(buffer, static_cast<std::size_t>(count));
+  }
+  writer.join();
+  ::close(fds[0]);
+
+  EXPECT_EQ(received, data);
+  ASSERT_EQ(reads.size(), 5u);
+  for (std::size_t i = 0; i + 1 < reads.size(); ++i)
+    EXPECT_EQ(reads[i], 65536);
+}
+
+TEST(PipeSourceTest, FeedsTarFilter) {
+  std::vector<TestEntry> entries = {{"a", pattern(70000)}, {"b", "bee"}};
+  auto const archive = make_tar(entries);
+  int fds[2];
+  ASSERT_EQ(::pipe(fds), 0);
+  auto writer = trickle(fds[1], archive, 4096);
+
+  io::filtering_istream in;
+  in.push(tf::TarFilter<>());
+  in.push(tf::PipeSource(fds[0]));
+  EXPECT_EQ(std::string(std::istreambuf_iterator<char>(in), {}),
+            entries[0].data + entries[1].data);
+  writer.join();
+  ::close(fds[0]);
+}
+
+TEST(PipeSourceTest, ReadsRegularFiles) {
+  auto const path = "/tmp/tar-filter-pipe-" + std::to_string(::getpid());
+  auto const data = pattern(5000);
+  auto file = std::fopen(path.c_str(), "wb");
+  ASSERT_NE(file, nullptr);
+  std::fwrite(data.data(), 1, data.size(), file);
+  std::fclose(file);
+
+  auto const fd = ::open(path.c_str(), O_RDONLY);
+  ASSERT_GE(fd, 0);
+  tf::PipeSource source(fd);
+  EXPECT_FALSE(source.is_pipe());
+  std::string buffer(8192, '\0');
+  EXPECT_EQ(source.read(buffer.data(), 8192), 5000);
+  EXPECT_EQ(buffer.substr(0, 5000), data);
+  EXPECT_EQ(source.read(buffer.data(), 8192), -1);
+  ::close(fd);
+  std::remove(path.c_str());
+}
@@ -0,0 +1,50 @@
+#include "test-utils.hxx"
+
+#include <boost-iostreams-tar-filter/record-splitter.hxx>
+#include <boost-iostreams-tar-filter/tar-reader.hxx>
+
+#include <gtest/gtest.h>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace tf = boost_iostreams_tar_filter;
+
+/**
+ * @brief Records straddling read buffers are reassembled, and an entry
+ * without a trailing newline does not bleed into the next entry.
+ */
+TEST(RecordSplitterTest, SplitsRecordsPerEntry) {
+  std::string first;
+  for (int i = 0; i < 500; ++i)
+    first += "{\"id\":" + std::to_string(i) + "}\n";
+  const std::string second = "alpha\nbeta\ngamma";
+
+  std::istringstream in(make_tar({{"a.ndjson", first},
+                                  {"dir/", "", '5'},
+                                  {"b.log", second},
+                                  {"empty.log", ""}}));
+
+  std::mutex mutex;
+  std::map<std::string, std::map<std::size_t, std::string>> records;
+  tf::RecordSplitter splitter(
+      [&](const tf::RecordBatch &batch) {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (std::size_t i = 0; i < batch.size(); ++i)
+          records[batch.entry_name][batch.first_record + i] =
+              std::string(batch[i]);
+      },
+      3, 7);
+  EXPECT_TRUE(tf::visit_tar(in, splitter, 100));
+  splitter.finish();
+
+  ASSERT_EQ(records.size(), 2u);
+  ASSERT_EQ(records["a.ndjson"].size(), 500u);
+  for (std::size_t i = 0; i < 500; ++i)
+    EXPECT_EQ(records["a.ndjson"][i], "{\"id\":" + std::to_string(i) + "}");
+  EXPECT_EQ(records["b.log"],
+            (std::map<std::size_t, std::string>{
+                {0, "alpha"}, {1, "beta"}, {2, "gamma"}}));
+}
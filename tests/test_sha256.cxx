@@ -0,0 +1,33 @@
+#include <boost-iostreams-tar-filter/sha256.hxx>
+
+#include <gtest/gtest.h>
+#include <string>
+
+namespace tf = boost_iostreams_tar_filter;
+
+/**
+ * @brief Known-answer tests, fed both at once and in uneven slices.
+ */
+TEST(Sha256Test, MatchesKnownDigests) {
+  const std::pair<std::string, std::string> vectors[] = {
+      {"", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+      {"abc",
+       "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"},
+      {std::string(1000, 'a'),
+       "41edece42d63e8d9bf515a9ba6932e1c20cbc9f5a5d134645adb5db1b9737ea3"},
+  };
+  for (const auto &[input, expected] : vectors) {
+    EXPECT_EQ(tf::to_hex(tf::Sha256::digest(input.data(), input.size())),
+              expected);
+
+    tf::Sha256 sha;
+    for (std::size_t pos = 0, step = 1; pos < input.size(); pos += step++)
+      sha.update(input.data() + pos, std::min(step, input.size() - pos));
+    auto const digest = sha.finish();
+    EXPECT_EQ(tf::to_hex(digest), expected);
+
+    tf::Digest parsed;
+    ASSERT_TRUE(tf::from_hex(expected, parsed));
+    EXPECT_EQ(parsed, digest);
+  }
+}
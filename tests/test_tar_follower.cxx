@@ -0,0 +1,120 @@
+#include "test-utils.hxx"
+
+#include <boost-iostreams-tar-filter/tar-follower.hxx>
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <gtest/gtest.h>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+namespace tf = boost_iostreams_tar_filter;
+using namespace std::chrono_literals;
+
+namespace {
+/**
+ * @brief CollectingVisitor whose completed entries can be waited for from
+ * another thread.
+ */
+class WaitableVisitor : public CollectingVisitor {
+public:
+  void on_entry_end(const tf::Entry &) override {
+    std::lock_guard lock(mutex_);
+    ++ended_;
+    cv_.notify_all();
+  }
+
+  bool wait_for_entries(std::size_t count) {
+    std::unique_lock lock(mutex_);
+    return cv_.wait_for(lock, 10s, [&] { return ended_ >= count; });
+  }
+
+private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::size_t ended_ = 0;
+};
+
+class TarFollowerTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    path_ = fs::temp_directory_path() /
+            ("tar-filter-follow-" + std::to_string(::getpid()) + ".tar");
+    fs::remove(path_);
+  }
+  void TearDown() override { fs::remove(path_); }
+
+  void append(const std::string &data) {
+    std::ofstream(path_, std::ios::binary | std::ios::app) << data;
+  }
+
+  fs::path path_;
+};
+} // unnamed namespace
+
+/**
+ * @brief Entries are reported as soon as their bytes are written, with
+ * appends cutting through headers and payloads, until the end marker.
+ */
+TEST_F(TarFollowerTest, FollowsAppendsUntilEndMarker) {
+  std::vector<TestEntry> entries = {{"first", std::string(3000, 'a')},
+                                    {"second", "b"},
+                                    {"third", std::string(700, 'c')}};
+  auto const archive = make_tar(entries);
+  append(archive.substr(0, 1000));
+
+  WaitableVisitor visitor;
+  auto follower = std::async(std::launch::async, [&] {
+    return tf::follow_tar(path_, visitor, {}, 4096);
+  });
+
+  append(archive.substr(1000, 2600)); // first ends, second's header starts
+  ASSERT_TRUE(visitor.wait_for_entries(1));
+  append(archive.substr(3600, 1000));
+  ASSERT_TRUE(visitor.wait_for_entries(2));
+  append(archive.substr(4600));
+
+  ASSERT_EQ(follower.wait_for(10s), std::future_status::ready);
+  EXPECT_TRUE(follower.get());
+  ASSERT_EQ(visitor.entries.size(), entries.size());
+  for (std::size_t i = 0; i < entries.size(); ++i)
+    EXPECT_EQ(visitor.entries[i].second, entries[i].data);
+}
+
+TEST_F(TarFollowerTest, StopWakesWaitingFollower) {
+  auto const archive = make_tar({{"only", "data"}});
+  append(archive.substr(0, 1024));
+
+  WaitableVisitor visitor;
+  std::promise<bool> result;
+  std::jthread follower([&](std::stop_token stop) {
+    result.set_value(tf::follow_tar(path_, visitor, stop));
+  });
+  ASSERT_TRUE(visitor.wait_for_entries(1));
+
+  follower.request_stop();
+  auto done = result.get_future();
+  ASSERT_EQ(done.wait_for(10s), std::future_status::ready);
+  EXPECT_FALSE(done.get());
+}
+
+TEST_F(TarFollowerTest, ReturnsWhenFileIsRemoved) {
+  auto const archive = make_tar({{"only", "data"}});
+  append(archive.substr(0, 1024));
+
+  WaitableVisitor visitor;
+  auto follower = std::async(std::launch::async, [&] {
+    return tf::follow_tar(path_, visitor);
+  });
+  ASSERT_TRUE(visitor.wait_for_entries(1));
+  fs::remove(path_);
+
+  ASSERT_EQ(follower.wait_for(10s), std::future_status::ready);
+  EXPECT_FALSE(follower.get());
+}
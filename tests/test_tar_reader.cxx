@@ -0,0 +1,311 @@
+#include "test-utils.hxx"
+
+#include <boost-iostreams-tar-filter/tar-reader.hxx>
+
+#include <boost/iostreams/device/array.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+namespace io = boost::iostreams;
+namespace tf = boost_iostreams_tar_filter;
+
+/**
+ * @brief gzip-compress a string in memory.
+ */
+static std::string gzip(const std::string &data) {
+  std::string out;
+  io::filtering_ostream os;
+  os.push(io::gzip_compressor());
+  os.push(io::back_inserter(out));
+  os << data;
+  os.reset();
+  return out;
+}
+
+/**
+ * @brief Collects every entry but only the payload of names ending in
+ * ".keep", and counts on_entry_end() calls.
+ */
+class SelectiveVisitor : public CollectingVisitor {
+public:
+  std::size_t ends = 0;
+
+  bool on_entry_begin(const tf::Entry &entry) override {
+    CollectingVisitor::on_entry_begin(entry);
+    return entry.name.ends_with(".keep");
+  }
+  void on_entry_end(const tf::Entry &) override { ++ends; }
+};
+
+/**
+ * @brief Mostly large declined payloads, so discarded ranges exceed the
+ * reader buffers.
+ */
+static std::vector<TestEntry> make_entries() {
+  std::vector<TestEntry> entries;
+  for (int i = 0; i < 30; ++i)
+    entries.push_back(
+        {"f" + std::to_string(i) + (i % 7 == 0 ? ".keep" : ".skip"),
+         std::string(1000 + i * 3001, static_cast<char>('a' + i % 26))});
+  entries.push_back({"dir/", "", '5'});
+  entries.push_back({"last.keep", "tail"});
+  return entries;
+}
+
+static void expect_selected(const SelectiveVisitor &visitor,
+                            const std::vector<TestEntry> &entries) {
+  ASSERT_EQ(visitor.entries.size(), entries.size());
+  EXPECT_EQ(visitor.ends, entries.size());
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    EXPECT_EQ(visitor.entries[i].first.name, entries[i].name);
+    auto const keep = entries[i].name.ends_with(".keep");
+    EXPECT_EQ(visitor.entries[i].second, keep ? entries[i].data : "");
+  }
+}
+
+/**
+ * @brief Seekable streams skip declined payloads by seeking; non-seekable
+ * filtering streams read through them. Both report the same entries.
+ */
+TEST(TarReaderTest, SeeksOverDeclinedPayloads) {
+  auto const entries = make_entries();
+  auto const archive = make_tar(entries);
+  auto const compressed = gzip(archive);
+
+  std::istringstream seekable(archive);
+  SelectiveVisitor seeking;
+  EXPECT_TRUE(tf::visit_tar(seekable, seeking, 4096));
+  expect_selected(seeking, entries);
+
+  io::filtering_istream filtered;
+  filtered.push(io::gzip_decompressor());
+  filtered.push(io::array_source(compressed.data(), compressed.size()));
+  SelectiveVisitor reading;
+  EXPECT_TRUE(tf::visit_tar(filtered, reading, 4096));
+  EXPECT_FALSE(filtered.bad());
+  expect_selected(reading, entries);
+}
+
+/**
+ * @brief The fused gzip reader inflates declined payloads into its scratch
+ * window, with and without CRC verification.
+ */
+TEST(TarReaderTest, GzipDiscardsDeclinedPayloads) {
+  auto const entries = make_entries();
+  auto const compressed = gzip(make_tar(entries));
+
+  for (bool verify : {true, false}) {
+    std::istringstream in(compressed);
+    SelectiveVisitor visitor;
+    EXPECT_TRUE(tf::visit_tar_gz(in, visitor, 4096, verify));
+    expect_selected(visitor, entries);
+  }
+}
+
+/**
+ * @brief A corrupted CRC is only reported when verification is on.
+ */
+TEST(TarReaderTest, GzipCrcVerificationIsOptional) {
+  auto const entries = make_entries();
+  auto compressed = gzip(make_tar(entries));
+  compressed[compressed.size() - 8] ^= 0x55;
+
+  std::istringstream verified_in(compressed);
+  SelectiveVisitor verified;
+  EXPECT_THROW(tf::visit_tar_gz(verified_in, verified, 4096, true),
+               std::ios_base::failure);
+
+  std::istringstream unverified_in(compressed);
+  SelectiveVisitor unverified;
+  EXPECT_TRUE(tf::visit_tar_gz(unverified_in, unverified, 4096, false));
+  expect_selected(unverified, entries);
+}
+
+TEST(TarReaderTest, JoinsUstarPrefixIntoName) {
+  const std::string prefix(120, 'p');
+  std::istringstream in(
+      make_tar({{"file.txt", "data", '0', 0, {}, prefix}, {"plain", "x"}}));
+  CollectingVisitor visitor;
+  EXPECT_TRUE(tf::visit_tar(in, visitor));
+  ASSERT_EQ(visitor.entries.size(), 2u);
+  EXPECT_EQ(visitor.entries[0].first.name, prefix + "/file.txt");
+  EXPECT_EQ(visitor.entries[0].second, "data");
+  EXPECT_EQ(visitor.entries[1].first.name, "plain");
+}
+
+/**
+ * @brief pax records are applied to the entry after them and not reported;
+ * the path record spans two blocks and the input arrives in odd slices.
+ */
+TEST(TarReaderTest, AppliesPaxRecords) {
+  const std::string name(600, 'n');
+  std::istringstream in(make_tar(
+      {{"GlobalHead", pax_record("uid", "42") + pax_record("gid", "43"), 'g'},
+       {"PaxHeaders/file",
+        pax_record("path", name) + pax_record("mtime", "1700000000.25") +
+            pax_record("uid", "4000000000") + pax_record("atime", "1"),
+        'x'},
+       {"file", "payload"},
+       {"dir/", "", '5'}}));
+  CollectingVisitor visitor;
+  EXPECT_TRUE(tf::visit_tar(in, visitor, 7));
+  ASSERT_EQ(visitor.entries.size(), 2u);
+  EXPECT_EQ(visitor.entries[0].first.name, name);
+  EXPECT_EQ(visitor.entries[0].first.mtime, 1700000000);
+  EXPECT_EQ(visitor.entries[0].first.uid, 4000000000u);
+  EXPECT_EQ(visitor.entries[0].first.gid, 43u);
+  EXPECT_EQ(visitor.entries[0].second, "payload");
+  EXPECT_EQ(visitor.entries[1].first.name, "dir/");
+  EXPECT_EQ(visitor.entries[1].first.uid, 42u);
+}
+
+TEST(TarReaderTest, AppliesGnuLongNames) {
+  auto const name = std::string(150, 'd') + "/file";
+  auto const target = std::string(200, 't');
+  std::istringstream in(
+      make_tar({{"././@LongLink", name + '\0', 'L'},
+                {name.substr(0, 100), "payload"},
+                {"././@LongLink", name + '\0', 'L'},
+                {"././@LongLink", target + '\0', 'K'},
+                {name.substr(0, 100), "", '2', 0, target.substr(0, 100)},
+                {"short", "x"}}));
+  CollectingVisitor visitor;
+  EXPECT_TRUE(tf::visit_tar(in, visitor, 512));
+  ASSERT_EQ(visitor.entries.size(), 3u);
+  EXPECT_EQ(visitor.entries[0].first.name, name);
+  EXPECT_EQ(visitor.entries[0].second, "payload");
+  EXPECT_TRUE(visitor.entries[1].first.is_symlink());
+  EXPECT_EQ(visitor.entries[1].first.name, name);
+  EXPECT_EQ(visitor.entries[1].first.link_name, target);
+  EXPECT_EQ(visitor.entries[2].first.name, "short");
+}
+
+TEST(TarReaderTest, RejectsMalformedPaxRecords) {
+  for (const auto *record : {"5 path=x\n", "10 uid=-1\n", "8 pathx\n"}) {
+    std::istringstream in(
+        make_tar({{"PaxHeaders/file", record, 'x'}, {"file", "payload"}}));
+    CollectingVisitor visitor;
+    EXPECT_THROW(tf::visit_tar(in, visitor), std::ios_base::failure) << record;
+  }
+}
+
+/**
+ * @brief GNU header of the given type carrying size and the 12-byte offset
+ * field used by 'M' continuation headers.
+ */
+static std::string gnu_header(const std::string &name, char type,
+                              std::size_t size, std::size_t offset) {
+  auto header = make_tar({{name, "", type}}).substr(0, 512);
+  std::snprintf(header.data() + 124, 12, "%011lo",
+                static_cast<unsigned long>(size));
+  std::snprintf(header.data() + 369, 12, "%011lo",
+                static_cast<unsigned long>(offset));
+  std::memset(header.data() + 148, ' ', 8);
+  unsigned checksum = 0;
+  for (unsigned char c : header)
+    checksum += c;
+  std::snprintf(header.data() + 148, 8, "%06o", checksum);
+  return header;
+}
+
+/**
+ * @brief Entries of make_volumes(); b.skip is split over all three volumes.
+ */
+static std::vector<TestEntry> volume_entries() {
+  std::string b(30000, '\0');
+  for (std::size_t i = 0; i < b.size(); ++i)
+    b[i] = static_cast<char>('a' + i % 23);
+  return {{"a.keep", std::string(1500, 'a')}, {"b.skip", b}, {"c.keep", "c"}};
+}
+
+/**
+ * @brief Cut volume_entries() into three volumes the way `tar -M` does:
+ * volume 2 starts with a label and both continuation volumes with an 'M'
+ * header for b.skip.
+ */
+static std::vector<std::string> make_volumes() {
+  auto const archive = make_tar(volume_entries());
+  // b.skip's payload starts at 2560; volumes end 8192 and 20480 bytes in.
+  return {archive.substr(0, 10752),
+          gnu_header("backup Volume 2", 'V', 0, 0) +
+              gnu_header("b.skip", 'M', 30000 - 8192, 8192) +
+              archive.substr(10752, 12288),
+          gnu_header("b.skip", 'M', 30000 - 20480, 20480) +
+              archive.substr(23040)};
+}
+
+static tf::VolumeOpener open_volumes(const std::vector<std::string> &volumes) {
+  return [&volumes](std::size_t n) -> std::unique_ptr<std::istream> {
+    if (n >= volumes.size())
+      return nullptr;
+    return std::make_unique<std::istringstream>(volumes[n]);
+  };
+}
+
+/**
+ * @brief A file split over three volumes is reported as one entry, for
+ * buffer sizes that do and do not divide the volume boundaries.
+ */
+TEST(TarReaderTest, ContinuesEntriesAcrossVolumes) {
+  auto const entries = volume_entries();
+  auto const volumes = make_volumes();
+  for (std::size_t buffer_size : {100, 512, 65536}) {
+    CollectingVisitor visitor;
+    EXPECT_TRUE(
+        tf::visit_tar_volumes(open_volumes(volumes), visitor, buffer_size));
+    ASSERT_EQ(visitor.entries.size(), entries.size()) << buffer_size;
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+      EXPECT_EQ(visitor.entries[i].first.name, entries[i].name);
+      EXPECT_EQ(visitor.entries[i].second, entries[i].data) << buffer_size;
+    }
+  }
+
+  auto const missing = std::vector<std::string>(volumes.begin(),
+                                                volumes.begin() + 2);
+  CollectingVisitor truncated;
+  EXPECT_FALSE(tf::visit_tar_volumes(open_volumes(missing), truncated));
+}
+
+/**
+ * @brief Declined payloads spanning a volume boundary are seeked over only
+ * up to the end of the volume file.
+ */
+TEST(TarReaderTest, SeeksOverDeclinedPayloadsAcrossVolumes) {
+  auto const root = fs::temp_directory_path() /
+                    ("tar-filter-volumes-" + std::to_string(::getpid()));
+  fs::create_directories(root);
+  std::vector<fs::path> paths;
+  for (const auto &volume : make_volumes()) {
+    paths.push_back(root / ("backup-" + std::to_string(paths.size())));
+    std::ofstream(paths.back(), std::ios::binary) << volume;
+  }
+
+  auto const entries = volume_entries();
+  SelectiveVisitor visitor;
+  EXPECT_TRUE(tf::visit_tar_volumes(paths, visitor, 4096));
+  expect_selected(visitor, entries);
+  fs::remove_all(root);
+}
+
+TEST(TarReaderTest, RejectsMismatchedContinuation) {
+  auto volumes = make_volumes();
+  volumes[2] = gnu_header("b.skip", 'M', 30000 - 16384, 16384) +
+               volumes[2].substr(512);
+  CollectingVisitor visitor;
+  EXPECT_THROW(tf::visit_tar_volumes(open_volumes(volumes), visitor),
+               std::ios_base::failure);
+
+  volumes = make_volumes();
+  volumes[1] = volumes[1].substr(1024);
+  EXPECT_THROW(tf::visit_tar_volumes(open_volumes(volumes), visitor),
+               std::ios_base::failure);
+}
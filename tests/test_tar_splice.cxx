@@ -0,0 +1,122 @@
+#include "test-utils.hxx"
+
+#include <boost-iostreams-tar-filter/tar-splice.hxx>
+
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <gtest/gtest.h>
+#include <string>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+namespace tf = boost_iostreams_tar_filter;
+
+namespace {
+class TarSpliceTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    root_ = fs::temp_directory_path() /
+            ("tar-filter-splice-" + std::to_string(::getpid()));
+    fs::create_directories(root_);
+    std::string large(300000, '\0');
+    for (std::size_t i = 0; i < large.size(); ++i)
+      large[i] = static_cast<char>('a' + i % 19);
+    entries_ = {{"dir/", "", '5'},
+                {"small.keep", "tiny"},
+                {"large.skip", large},
+                {"empty.keep", ""},
+                {"large.keep", large.substr(1000)}};
+    std::ofstream(root_ / "archive.tar", std::ios::binary)
+        << make_tar(entries_);
+  }
+  void TearDown() override { fs::remove_all(root_); }
+
+  fs::path root_;
+  std::vector<TestEntry> entries_;
+};
+
+/**
+ * @brief Read everything from a pipe's read end on another thread, so the
+ * splices into its write end never block for long.
+ */
+std::future<std::string> drain(int fd) {
+  return std::async(std::launch::async, [fd] {
+    std::string data;
+    char buffer[65536];
+    for (ssize_t count; (count = ::read(fd, buffer, sizeof(buffer))) > 0;)
+      data.append(buffer, static_cast<std::size_t>(count));
+    ::close(fd);
+    return data;
+  });
+}
+} // unnamed namespace
+
+TEST_F(TarSpliceTest, SplicesSelectedPayloadsIntoPipe) {
+  int fds[2];
+  ASSERT_EQ(::pipe(fds), 0);
+  auto received = drain(fds[0]);
+
+  std::vector<std::string> seen;
+  EXPECT_TRUE(tf::splice_tar_entries(
+      root_ / "archive.tar", fds[1], [&](const tf::Entry &entry) {
+        seen.push_back(entry.name);
+        return entry.name.ends_with(".keep") || entry.is_directory();
+      }));
+  ::close(fds[1]);
+
+  EXPECT_EQ(seen.size(), entries_.size());
+  EXPECT_EQ(received.get(), entries_[1].data + entries_[4].data);
+}
+
+/**
+ * @brief Non-pipe destinations fall back to sendfile().
+ */
+TEST_F(TarSpliceTest, SendsToRegularFiles) {
+  auto const out_path = root_ / "out";
+  auto const fd =
+      ::open(out_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  ASSERT_GE(fd, 0);
+  auto const entry =
+      tf::splice_tar_entry(root_ / "archive.tar", "large.skip", fd);
+  ::close(fd);
+
+  ASSERT_TRUE(entry.has_value());
+  EXPECT_EQ(entry->size, entries_[2].data.size());
+  std::ifstream out(out_path, std::ios::binary);
+  EXPECT_EQ(std::string(std::istreambuf_iterator<char>(out), {}),
+            entries_[2].data);
+
+  EXPECT_FALSE(tf::splice_tar_entry(root_ / "archive.tar", "missing", -1));
+}
+
+TEST_F(TarSpliceTest, RejectsTruncatedPayload) {
+  fs::resize_file(root_ / "archive.tar", 512 * 4);
+  int fds[2];
+  ASSERT_EQ(::pipe(fds), 0);
+  auto received = drain(fds[0]);
+  EXPECT_THROW(tf::splice_tar_entries(root_ / "archive.tar", fds[1],
+                                      [](const tf::Entry &) { return true; }),
+               std::ios_base::failure);
+  ::close(fds[1]);
+  received.get();
+}
+
+/**
+ * @brief Only the last copy of a repeated path is sent, as extraction
+ * leaves it.
+ */
+TEST_F(TarSpliceTest, SendsLastDuplicate) {
+  std::ofstream(root_ / "dup.tar", std::ios::binary)
+      << make_tar({{"dup", "first"}, {"other", "x"}, {"dup", "last"}});
+  int fds[2];
+  ASSERT_EQ(::pipe(fds), 0);
+  auto received = drain(fds[0]);
+  auto const entry = tf::splice_tar_entry(root_ / "dup.tar", "dup", fds[1]);
+  ::close(fds[1]);
+
+  ASSERT_TRUE(entry.has_value());
+  EXPECT_EQ(entry->size, 4u);
+  EXPECT_EQ(received.get(), "last");
+}
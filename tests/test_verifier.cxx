@@ -0,0 +1,77 @@
+#include "test-utils.hxx"
+
+#include <boost-iostreams-tar-filter/extraction-sink.hxx>
+#include <boost-iostreams-tar-filter/verifier.hxx>
+
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+namespace tf = boost_iostreams_tar_filter;
+
+TEST(VerifierTest, ReportsMismatches) {
+  const auto root = fs::temp_directory_path() /
+                    ("tar-filter-verify-" + std::to_string(::getpid()));
+  fs::remove_all(root);
+
+  std::vector<TestEntry> entries;
+  for (int i = 0; i < 200; ++i)
+    entries.push_back({"dir-" + std::to_string(i % 7) + "/f" + std::to_string(i),
+                       std::string(i * 13, static_cast<char>('a' + i % 26))});
+  const auto archive = make_tar(entries);
+
+  std::istringstream manifest_in(archive);
+  auto manifest = tf::manifest_from_tar(manifest_in);
+  ASSERT_EQ(manifest.size(), entries.size());
+
+  std::stringstream serialized;
+  tf::write_manifest(serialized, manifest);
+  auto const parsed = tf::read_manifest(serialized);
+  ASSERT_EQ(parsed.size(), manifest.size());
+  EXPECT_EQ(parsed[5].path, manifest[5].path);
+  EXPECT_EQ(parsed[5].digest, manifest[5].digest);
+
+  std::istringstream in(archive);
+  tf::FilesystemSink sink(root, {.record_digests = true});
+  tf::extract_tar(in, sink);
+  EXPECT_EQ(sink.digests().size(), entries.size());
+
+  auto report = tf::verify_extraction(root, manifest, &sink.digests(), 4);
+  EXPECT_EQ(report.exit_status(), 0);
+  EXPECT_EQ(report.verified, entries.size());
+  EXPECT_EQ(report.rehashed, 0u);
+
+  std::ofstream(root / "dir-3/f10", std::ios::trunc | std::ios::binary)
+      << std::string(130, 'z');
+  fs::remove(root / "dir-1/f8");
+  std::ofstream(root / "dir-2/f9", std::ios::app) << "tail";
+
+  report = tf::verify_extraction(root, manifest, nullptr, 4);
+  EXPECT_EQ(report.exit_status(), 1);
+  EXPECT_EQ(report.rehashed, entries.size() - 2);
+  ASSERT_EQ(report.mismatches.size(), 3u);
+  EXPECT_EQ(report.mismatches[0].path, "dir-1/f8");
+  EXPECT_EQ(report.mismatches[0].kind, tf::Mismatch::Kind::Missing);
+  EXPECT_EQ(report.mismatches[1].path, "dir-2/f9");
+  EXPECT_EQ(report.mismatches[1].kind, tf::Mismatch::Kind::Size);
+  EXPECT_EQ(report.mismatches[2].path, "dir-3/f10");
+  EXPECT_EQ(report.mismatches[2].kind, tf::Mismatch::Kind::Digest);
+  fs::remove_all(root);
+}
+
+TEST(VerifierTest, ManifestKeepsLastDuplicate) {
+  std::istringstream in(make_tar({{"dup", "first"},
+                                  {"other", "x"},
+                                  {"./dup", "second"},
+                                  {"gone", "file"},
+                                  {"gone", "", '2', 0, "other"}}));
+  auto const manifest = tf::manifest_from_tar(in);
+  ASSERT_EQ(manifest.size(), 2u);
+  EXPECT_EQ(manifest[0].path, "dup");
+  EXPECT_EQ(manifest[0].size, 6u);
+  EXPECT_EQ(manifest[1].path, "other");
+}